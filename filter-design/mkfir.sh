@@ -23,9 +23,9 @@ function mkfir
   cat mkfir_${stage}_${bits}.tmp | awk '$1 != "#" && NF > 0 { if (n++ % 2 == 1) print "    "$1","; }'
   echo "  };";
   echo "  if (stage_ratio == $stage && precision_ == $bits && mode_ == UP)"
-  echo "    return create_impl_with_coeffs <Upsampler2<$n_coefficients, USE_SSE> > (coeffs${stage}_${bits}, $n_coefficients, 2.0);"
+  echo "    return create_impl_with_coeffs <Upsampler2<$n_coefficients, ISET> > (coeffs${stage}_${bits}, $n_coefficients, 2.0);"
   echo "  if (stage_ratio == $stage && precision_ == $bits && mode_ == DOWN)"
-  echo "    return create_impl_with_coeffs <Downsampler2<$n_coefficients, USE_SSE> > (coeffs${stage}_${bits}, $n_coefficients, 1.0);"
+  echo "    return create_impl_with_coeffs <Downsampler2<$n_coefficients, ISET> > (coeffs${stage}_${bits}, $n_coefficients, 1.0);"
 
   # create gnuplottable output
   cat mkfir_${stage}_${bits}.dump | awk '$1 != "#" && NF > 0 {
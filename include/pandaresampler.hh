@@ -4,6 +4,9 @@
 
 #include <vector>
 #include <memory>
+#include <complex>
+#include <algorithm>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 
@@ -12,6 +15,9 @@
 // uncomment this to use header only mode
 // #define PANDA_RESAMPLER_HEADER_ONLY
 
+// uncomment this to use the portable vector extension code instead of SSE on x86 (for testing)
+// #define PANDA_RESAMPLER_FORCE_VECTOR
+
 /* ------------------------------------------------------------------- */
 
 /** \file pandaresampler.hh
@@ -106,18 +112,74 @@ public:
   }
 };
 
+class ResamplerBankStage;
+
 /**
  * \brief Interface for factor 2 resampling classes
  */
 class Resampler2 {
+  friend class ResamplerBank;
+  template<class Func> friend class Oversampler;
+  /* filter stage for double precision samples (mono only) */
+  class DoubleImpl
+  {
+  public:
+    virtual void process_block (const double *input, uint n_input_samples, double *output) = 0;
+    virtual void reset() = 0;
+    virtual
+    ~DoubleImpl()
+    {
+    }
+  };
   class Impl
   {
   public:
     virtual void   process_block (const float *input, uint n_input_samples, float *output) = 0;
+    /* planar multi-channel data: input[c] / output[c] point to the samples of channel c */
+    virtual void
+    process_block_planar (const float * const *input, uint n_input_samples, float * const *output)
+    {
+      process_block (input[0], n_input_samples, output[0]);
+    }
+    /* interleaved multi-channel data: the samples of frame i are input[i * channels + c] */
+    virtual void
+    process_block_interleaved (const float *input, uint n_input_frames, float *output)
+    {
+      process_block (input, n_input_frames, output);
+    }
+    /* adds the resampled data multiplied by gain to output (false if not supported, nothing is processed then) */
+    virtual bool
+    process_block_add (const float * /* input */, uint /* n_input_samples */, float * /* output */, float /* gain */)
+    {
+      return false;
+    }
+    /* temporary memory (16-byte aligned, n_floats floats) that stages can use instead of stack memory (nullptr: use the stack) */
+    virtual void
+    set_scratch (float * /* scratch */, uint /* n_floats */)
+    {
+    }
     virtual uint   order() const = 0;
     virtual double delay() const = 0;
     virtual void   reset() = 0;
     virtual bool   sse_enabled() const = 0;
+    /* creates a stage for two interleaved channels using the same filter (nullptr if not supported) */
+    virtual Impl *
+    create_two_channel_stage() const
+    {
+      return nullptr;
+    }
+    /* creates a double precision stage using the same filter (nullptr if not supported) */
+    virtual DoubleImpl *
+    create_double_stage() const
+    {
+      return nullptr;
+    }
+    /* creates a ResamplerBank stage using the same filter (nullptr if not supported) */
+    virtual ResamplerBankStage *
+    create_bank_stage (uint /* n_groups */, bool /* avx */) const
+    {
+      return nullptr;
+    }
     virtual
     ~Impl()
     {
@@ -126,20 +188,15 @@ class Resampler2 {
   std::unique_ptr<Impl> impl_x2;
   std::unique_ptr<Impl> impl_x4;
   std::unique_ptr<Impl> impl_x8;
+  std::unique_ptr<Impl> impl_cascade; /* optional: all stages fused into one pass */
+  std::unique_ptr<DoubleImpl> impl_double_x2;
+  std::unique_ptr<DoubleImpl> impl_double_x4;
+  std::unique_ptr<DoubleImpl> impl_double_x8;
   uint                  ratio_;
-
-  template<uint ORDER, bool USE_SSE>
-  class Upsampler2;
-  template<uint ORDER, bool USE_SSE>
-  class Downsampler2;
-  template<uint ORDER>
-  class IIRUpsampler2;
-  template<uint ORDER>
-  class IIRDownsampler2;
-  template<uint ORDER>
-  class IIRUpsampler2SSE;
-  template<uint ORDER>
-  class IIRDownsampler2SSE;
+  uint                  channels_;
+  uint                  tile_size_ = 0;     /* tiled multi-stage processing (0: disabled) */
+  float                *scratch_ = nullptr; /* scratch memory for tiled processing */
+  std::unique_ptr<AlignedArray<float>> scratch_buffer_;
 public:
   enum Mode {
     UP,
@@ -159,25 +216,111 @@ public:
   enum Filter {
     FILTER_IIR,
     FILTER_FIR,
+    FILTER_IIR_PARALLEL, /* IIR filter, time-parallel evaluation with AVX2 (same as FILTER_IIR without AVX2) */
+    FILTER_FIR_FIXED     /* FIR filter, 16 bit fixed-point arithmetic with SSE2 (PREC_48DB and PREC_72DB only,
+                            same as FILTER_FIR otherwise), the signal must be in [-2:2] */
   };
+  /**
+   * \brief Instruction set family used by the optimized filter kernels
+   */
+  enum InstructionSet {
+    ISET_FPU,            /* no vector instructions */
+    ISET_SSE,
+    ISET_AVX2,           /* AVX2 and FMA */
+    ISET_NEON,
+    ISET_VECTOR          /* portable GCC/Clang vector extensions */
+  };
+  /**
+   * \brief Integer PCM sample formats for process_block_pcm() (native endianness)
+   */
+  enum SampleFormat {
+    FORMAT_S16,          /* int16_t */
+    FORMAT_S24,          /* packed 24 bit, 3 bytes per sample (little endian) */
+    FORMAT_S32           /* int32_t */
+  };
+  /**
+   * \brief Maximum number of channels for multi-channel resamplers
+   */
+  static constexpr uint MAX_CHANNELS = 8;
+private:
+  template<uint ORDER, InstructionSet ISET>
+  class Upsampler2;
+  template<uint ORDER, InstructionSet ISET>
+  class Downsampler2;
+  template<uint ORDER, InstructionSet ISET>
+  class Upsampler2x2;
+  template<uint ORDER, InstructionSet ISET>
+  class Downsampler2x2;
+  template<uint ORDER>
+  class IIRUpsampler2;
+  template<uint ORDER>
+  class IIRDownsampler2;
+  template<uint ORDER>
+  class IIRUpsampler2SSE;
+  template<uint ORDER>
+  class IIRDownsampler2SSE;
+  template<uint ORDER>
+  class IIRUpsampler2x2SSE;
+  template<uint ORDER>
+  class IIRDownsampler2x2SSE;
+  template<uint ORDER>
+  class IIRUpsampler2Parallel;
+  template<uint ORDER>
+  class IIRDownsampler2Parallel;
+  template<uint N2, uint N4, uint N8>
+  class IIRUpsamplerCascadeSSE;
+  template<uint N2, uint N4, uint N8>
+  class IIRDownsamplerCascadeSSE;
+  template<uint ORDER>
+  class IIRUpsampler2x8AVX;
+  template<uint ORDER>
+  class IIRDownsampler2x8AVX;
+  class MultiChannel;
+  class MultiChannelFIR;
+  template<uint ORDER>
+  class DoubleFIRUpsampler2;
+  template<uint ORDER>
+  class DoubleFIRDownsampler2;
+  template<uint ORDER>
+  class FixedFIRUpsampler2;
+  template<uint ORDER>
+  class FixedFIRDownsampler2;
+  template<class Upsampler>
+  class DoubleIIRUpsampler2;
+  template<class Downsampler>
+  class DoubleIIRDownsampler2;
 protected:
-  Mode      mode_;
-  Precision precision_;
-  bool      use_sse_if_available_;
-  Filter    filter_;
+  Mode           mode_;
+  Precision      precision_;
+  bool           use_sse_if_available_;
+  Filter         filter_;
+  InstructionSet iset_;
+  bool           two_channel_stages_ = false; /* all stages filter two interleaved channels in one pass */
 public:
   /**
    * creates a resampler instance fulfilling a given specification
+   *
+   * Resamplers with more than one channel (up to MAX_CHANNELS) process planar
+   * multi-channel data, see process_block (const float * const *, uint, float * const *).
    */
   Resampler2 (Mode      mode,
               uint      ratio,
               Precision precision,
               bool      use_sse_if_available = true,
-              Filter    filter = FILTER_FIR);
+              Filter    filter = FILTER_FIR,
+              uint      channels = 1);
   /**
    * returns true if an optimized SSE version of the Resampler is available
    */
   static bool        sse_available();
+  /**
+   * returns the best instruction set supported by the CPU (detected once, at runtime)
+   */
+  static InstructionSet instruction_set_available();
+  /**
+   * returns a human-readable name for a given instruction set
+   */
+  static const char  *instruction_set_name (InstructionSet iset);
   /**
    * test internal filter implementation
    */
@@ -190,65 +333,176 @@ public:
    * returns a human-readable name for a given precision
    */
   static const char  *precision_name (Precision precision);
+  /**
+   * enable tiled multi-stage processing
+   *
+   * By default, resamplers with ratio 4 or 8 store the outputs of the
+   * intermediate stages in temporary buffers on the stack (32 KB), and the
+   * planar, add, double, PCM and in-place processing functions use stack
+   * buffers (4 - 36 KB) as well. Once a tile size is set, all data is
+   * processed in tiles of tile_size input frames (tile_size / 2 for double
+   * samples), using the scratch memory instead of the stack. Downsampling
+   * stages also use the scratch memory instead of stack memory for
+   * deinterleaving.
+   *
+   * tile_size must be a multiple of 16 (0 disables tiled processing). The
+   * scratch memory can be supplied by the caller (16-byte aligned, at least
+   * scratch_size (tile_size) floats), otherwise the resampler allocates it.
+   * A caller supplied scratch buffer can be shared by resamplers that are
+   * never run concurrently.
+   */
+  void         set_tile_size (uint tile_size, float *scratch = nullptr);
+  /**
+   * returns the number of floats of scratch memory needed for a tile size
+   */
+  size_t       scratch_size (uint tile_size) const;
+  /**
+   * returns a tile size for which the intermediate outputs of all stages of one
+   * tile (and the deinterleaved downsampler input) fit into 16 KB (half of a
+   * typical L1 data cache), which is what processing mono or interleaved data
+   * uses of the scratch memory
+   */
+  uint         default_tile_size() const;
   /**
    * resample a data block
+   *
+   * In-place processing is supported in the following cases (for all
+   * process_block() variants, process_block_interleaved() and, if the input
+   * and output format are the same, process_block_pcm()):
+   *  - for DOWN mode, output may point to input (or before input in the same buffer)
+   *  - for UP mode, input may be stored at the end of the output buffer,
+   *    so input == output + (ratio - 1) * n_input_samples
    */
   void
   process_block (const float *input, uint n_input_samples, float *output)
   {
-    if (ratio_ == 2)
+    if ((impl_cascade || ratio_ == 2) && buffers_overlap (input, n_input_samples, output, n_output_samples (n_input_samples)))
+      {
+        process_block_in_place (input, n_input_samples, output);
+      }
+    else if (impl_cascade)
+      {
+        impl_cascade->process_block (input, n_input_samples, output);
+      }
+    else if (ratio_ == 2)
       {
         impl_x2->process_block (input, n_input_samples, output);
       }
     else if (ratio_ == 1)
       {
-        std::copy (input, input + n_input_samples, output);
+        if (input != output)
+          std::copy (input, input + n_input_samples, output);
       }
     else
       {
-        while (n_input_samples)
-          {
-            const uint block_size = 1024;
-            const uint n_todo_samples = std::min (block_size, n_input_samples);
-
-            float tmp[block_size * 4];
-            float tmp2[block_size * 4];
-
-            if (mode_ == UP)
-              {
-                if (ratio_ == 4)
-                  {
-                    impl_x2->process_block (input, n_todo_samples, tmp);
-                    impl_x4->process_block (tmp, n_todo_samples * 2, output);
-                  }
-                else /* ratio_ == 8 */
-                  {
-                    impl_x2->process_block (input, n_todo_samples, tmp);
-                    impl_x4->process_block (tmp, n_todo_samples * 2, tmp2);
-                    impl_x8->process_block (tmp2, n_todo_samples * 4, output);
-                  }
-                output += n_todo_samples * ratio_;
-              }
-            else /* (mode_ == DOWN) */
-              {
-                if (ratio_ == 4)
-                  {
-                    impl_x4->process_block (input, n_todo_samples, tmp);
-                    impl_x2->process_block (tmp, n_todo_samples / 2, output);
-                  }
-                else /* ratio_ == 8 */
-                  {
-                    impl_x8->process_block (input, n_todo_samples, tmp);
-                    impl_x4->process_block (tmp, n_todo_samples / 2, tmp2);
-                    impl_x2->process_block (tmp2, n_todo_samples / 4, output);
-                  }
-                output += n_todo_samples / ratio_;
-              }
-            input += n_todo_samples;
-            n_input_samples -= n_todo_samples;
-          }
+        process_block_multi_stage (input, n_input_samples, output);
       }
   }
+  /**
+   * resample a block of double precision samples (mono resamplers only)
+   *
+   * The double precision filters use the same filter design as the float
+   * filters (vectorized with SSE2 or AVX), but have a separate filter state.
+   * They are created by the first call, see enable_double().
+   */
+  void
+  process_block (const double *input, uint n_input_samples, double *output);
+  /**
+   * create the double precision filter stages (mono resamplers only)
+   *
+   * Resamplers that are only used for float samples don't need them, so
+   * they are created on demand. Call this before processing to avoid memory
+   * allocation in the first double precision process_block() call.
+   */
+  void
+  enable_double();
+  /**
+   * resample a data block and add the result multiplied by gain to output
+   * (mono resamplers only), for mixing many resampled sources into one bus
+   *
+   * For FIR filters, the final stage accumulates the output samples while
+   * storing them, so no temporary output buffer is needed. The other
+   * filters resample into a temporary buffer and add it to output.
+   */
+  void
+  process_block_add (const float *input, uint n_input_samples, float *output, float gain);
+  /**
+   * resample a block of planar multi-channel data: input[c] and output[c]
+   * point to the samples of channel c, for each of the channels() channels
+   *
+   * For 8 channel IIR resamplers, the 8 channels are processed in parallel
+   * using AVX instructions (if available). 8 channel FIR resamplers process
+   * one channel per SIMD lane, sharing the taps between all channels.
+   */
+  void
+  process_block (const float * const *input, uint n_input_samples, float * const *output);
+  /**
+   * resample a block of interleaved multi-channel data: frame i consists of
+   * the samples input[i * channels() + c] of the channels c, the output is
+   * interleaved in the same way
+   *
+   * The vectorized multi-channel filters (see above) read and write the
+   * interleaved frames directly, without deinterleaving the data first. This
+   * is also true for two channels, for which both channels are filtered in
+   * one pass.
+   */
+  void
+  process_block_interleaved (const float *input, uint n_input_frames, float *output);
+  /**
+   * resample a block of complex (I/Q) samples, the resampler must have been
+   * created with two channels
+   *
+   * The real and imaginary parts are filtered by the same halfband filter in
+   * one pass (FIR and IIR), so they don't need to be split into two channels.
+   */
+  void
+  process_block_complex (const std::complex<float> *input, uint n_input_samples, std::complex<float> *output)
+  {
+    if (!PANDA_RESAMPLER_CHECK (channels_ == 2))
+      return;
+
+    /* std::complex<float> is guaranteed to have the same layout as float[2] */
+    process_block_interleaved (reinterpret_cast<const float *> (input), n_input_samples, reinterpret_cast<float *> (output));
+  }
+  /**
+   * resample a block of integer PCM data, multi-channel data is interleaved
+   * (like for process_block_interleaved())
+   *
+   * The samples are converted to float in small blocks that are processed by
+   * the filters while they are still in the cache, and the output is scaled,
+   * rounded and saturated using SIMD instructions. Input and output format may
+   * be different.
+   */
+  void
+  process_block_pcm (const void   *input,
+                     SampleFormat  input_format,
+                     uint          n_input_frames,
+                     void         *output,
+                     SampleFormat  output_format);
+  /**
+   * resample a block of 16 bit PCM data (interleaved for multi-channel resamplers)
+   */
+  void
+  process_block (const int16_t *input, uint n_input_frames, int16_t *output)
+  {
+    process_block_pcm (input, FORMAT_S16, n_input_frames, output, FORMAT_S16);
+  }
+  /**
+   * resample a block of 32 bit PCM data (interleaved for multi-channel resamplers)
+   */
+  void
+  process_block (const int32_t *input, uint n_input_frames, int32_t *output)
+  {
+    process_block_pcm (input, FORMAT_S32, n_input_frames, output, FORMAT_S32);
+  }
+  /**
+   * return the number of channels processed by this resampler
+   */
+  uint
+  channels() const
+  {
+    return channels_;
+  }
   /**
    * return FIR filter order
    */
@@ -305,6 +559,14 @@ public:
       impl_x4->reset();
     if (ratio_ >= 8)
       impl_x8->reset();
+    if (impl_cascade)
+      impl_cascade->reset();
+    if (impl_double_x2)
+      impl_double_x2->reset();
+    if (impl_double_x4)
+      impl_double_x4->reset();
+    if (impl_double_x8)
+      impl_double_x8->reset();
   }
   /**
    * return whether the resampler is using sse optimized code
@@ -314,39 +576,49 @@ public:
   {
     return impl_x2->sse_enabled();
   }
+  /**
+   * return the instruction set used by this resampler
+   */
+  InstructionSet
+  instruction_set() const
+  {
+    return iset_;
+  }
 protected:
   /* Creates implementation from filter coefficients and Filter implementation class
    *
    * Since up- and downsamplers use different (scaled) coefficients, its possible
    * to specify a scaling factor. Usually 2 for upsampling and 1 for downsampling.
+   *
+   * For FILTER_FIR_FIXED, the fixed-point stage for the coefficients is created
+   * instead of Filter.
    */
-  template<class Filter> static inline Impl*
+  template<class Filter> inline Impl*
   create_impl_with_coeffs (const double *d,
 	                   uint          order,
-	                   double        scaling)
-  {
-    float taps[order];
-    for (uint i = 0; i < order; i++)
-      taps[i] = d[i] * scaling;
-
-    Resampler2::Impl *filter = new Filter (taps);
-    if (!PANDA_RESAMPLER_CHECK (order == filter->order()))
-      return nullptr;
-
-    return filter;
-  }
-  /* creates the actual implementation; specifying USE_SSE=true will use
-   * SSE instructions, USE_SSE=false will use FPU instructions
+	                   double        scaling);
+  /* creates the actual implementation; ISET selects the instruction set
+   * (ISET_FPU will use FPU instructions only)
    *
    * Don't use this directly - it's only to be used by
    * bseblockutils.cc's anonymous Impl classes.
    */
-  template<bool USE_SSE> inline Impl*
+  template<InstructionSet ISET> inline Impl*
   create_impl (uint stage_ratio);
 
-  template<bool USE_SSE> inline Impl*
+  inline Impl*
   create_impl_iir (uint stage_ratio);
 
+  inline Impl*
+  create_stage (uint stage_ratio);
+
+  inline Impl*
+  create_impl_iir_cascade();
+
+  template<uint N2, uint N4, uint N8>
+  inline Impl*
+  create_impl_iir_cascade();
+
   template<class CArray>
   inline Impl*
   create_impl_iir_with_coeffs (const CArray& carray, double group_delay);
@@ -354,6 +626,399 @@ protected:
   void
   init_stage (std::unique_ptr<Impl>& impl,
               uint                   stage_ratio);
+
+  /* the processing functions below use the scratch memory if a tile size is set,
+   * and call the *_stack variant with temporary buffers on the stack otherwise */
+  void
+  process_block_two_channel_planar (const float * const *input,
+                                    uint                 n_input_samples,
+                                    float * const       *output);
+  void
+  process_block_two_channel_planar_stack (const float * const *input,
+                                          uint                 n_input_samples,
+                                          float * const       *output);
+  void
+  process_two_channel_tiles (const float * const *input,
+                             uint                 n_input_samples,
+                             float * const       *output,
+                             uint                 tile_size,
+                             float               *in,
+                             float               *out);
+
+  /* single pass stages (ratio 2 or cascade) read the input while writing the output,
+   * so for in-place processing each block of the input is copied first */
+  void
+  process_block_in_place (const float *input,
+                          uint         n_input_frames,
+                          float       *output);
+  void
+  process_block_in_place_stack (const float *input,
+                                uint         n_input_frames,
+                                float       *output);
+  void
+  process_in_place_tiles (const float *input,
+                          uint         n_input_frames,
+                          float       *output,
+                          uint         tile_size,
+                          float       *in);
+  void
+  process_block_planar_in_place (const float * const *input,
+                                 uint                 n_input_samples,
+                                 float * const       *output);
+  void
+  process_block_planar_in_place_stack (const float * const *input,
+                                       uint                 n_input_samples,
+                                       float * const       *output);
+  void
+  process_planar_in_place_tiles (const float * const *input,
+                                 uint                 n_input_samples,
+                                 float * const       *output,
+                                 uint                 tile_size,
+                                 float               *in);
+
+  /* ratio 4 and 8: planar data (no vectorized multi-channel implementation) */
+  void
+  process_block_planar_stack (const float * const *input,
+                              uint                 n_input_samples,
+                              float * const       *output);
+  void
+  process_planar_tiles (const float * const *input,
+                        uint                 n_input_samples,
+                        float * const       *output,
+                        uint                 tile_size,
+                        float               *tmp,
+                        float               *tmp2);
+
+  void
+  process_block_add_stack (Impl * const *stages,
+                           uint          n_stages,
+                           const float  *input,
+                           uint          n_input_samples,
+                           float        *output,
+                           float         gain);
+  void
+  process_add_tiles (Impl * const *stages,
+                     uint          n_stages,
+                     const float  *input,
+                     uint          n_input_samples,
+                     float        *output,
+                     float         gain,
+                     uint          tile_size,
+                     float        *tmp,
+                     float        *tmp2,
+                     float        *out);
+
+  void
+  process_block_double_stack (const double *input,
+                              uint          n_input_samples,
+                              double       *output);
+  void
+  process_double_tiles (const double *input,
+                        uint          n_input_samples,
+                        double       *output,
+                        uint          tile_size,
+                        double       *tmp,
+                        double       *tmp2);
+
+  void
+  process_block_pcm_stack (const void   *input,
+                           SampleFormat  input_format,
+                           uint          n_input_frames,
+                           void         *output,
+                           SampleFormat  output_format);
+  void
+  process_pcm_tiles (const void   *input,
+                     SampleFormat  input_format,
+                     uint          n_input_frames,
+                     void         *output,
+                     SampleFormat  output_format,
+                     uint          tile_size,
+                     float        *in,
+                     float        *out);
+
+  /* ratio 4 and 8: mono or interleaved data, using the scratch memory for tiled processing */
+  void
+  process_block_multi_stage (const float *input,
+                             uint         n_input_frames,
+                             float       *output);
+  void
+  process_block_multi_stage_stack (const float *input,
+                                   uint         n_input_frames,
+                                   float       *output);
+  void
+  process_tiles (const float *input,
+                 uint         n_input_frames,
+                 float       *output,
+                 uint         tile_size,
+                 float       *tmp,
+                 float       *tmp2);
+  /* scratch memory layout, see tile_tmp_size() */
+  size_t
+  tile_tmp_size (uint tile_size) const;
+  size_t
+  tile_stage_size (uint tile_size) const;
+  size_t
+  tile_io_size (uint tile_size) const;
+  float *
+  scratch_tmp2() const;
+  float *
+  scratch_io() const;
+  uint
+  n_output_samples (uint n_input_samples) const
+  {
+    return mode_ == UP ? n_input_samples * ratio_ : n_input_samples / ratio_;
+  }
+  template<class T> static bool
+  buffers_overlap (const T *input, size_t n_input_values, const T *output, size_t n_output_values)
+  {
+    return input < output + n_output_values && output < input + n_input_values;
+  }
+
+  bool
+  multi_channel_iir_sse() const;
+  bool
+  multi_channel_fir() const;
+};
+
+/**
+ * \brief Bank of independent mono resamplers sharing the same configuration
+ *
+ * A ResamplerBank resamples n_streams independent mono streams (for instance
+ * the voices of a synthesizer) with a single process_block() call. The filter
+ * state is stored as structure of arrays: LANES streams form a group, and one
+ * sample of all streams of a group is stored as one vector, so that each
+ * vector instruction processes LANES streams.
+ *
+ * Streams can be deactivated: the samples of inactive streams are neither read
+ * nor written, and groups without active streams are skipped. Activating a
+ * stream resets its filter state, so it can be used for a new voice.
+ */
+class ResamplerBank {
+public:
+  static constexpr uint LANES = 8;
+private:
+  /* number of frames (one sample per lane) processed at a time at the high sample rate */
+  static constexpr uint BLOCK_FRAMES = 256;
+  /* number of frames reserved for filter history in front of the scratch buffers */
+  static constexpr uint HISTORY_FRAMES = 128;
+
+  std::vector<std::unique_ptr<ResamplerBankStage>> stages_; /* in processing order */
+  std::vector<bool>          active_;
+  AlignedArray<float>        scratch_a_;
+  AlignedArray<float>        scratch_b_;
+  AlignedArray<float>        silence_; /* input of inactive lanes */
+  AlignedArray<float>        discard_; /* output of inactive lanes */
+  Resampler2::Mode           mode_;
+  uint                       ratio_;
+  uint                       n_streams_;
+  uint                       n_groups_;
+  double                     delay_;
+  Resampler2::InstructionSet iset_;
+
+  void process_group (uint group, const float * const *input, uint input_stride, uint n_input_samples,
+                      float * const *output, uint output_stride);
+public:
+  /**
+   * creates a bank of n_streams resamplers, the filter is the same as the one
+   * used by the corresponding Resampler2 (FILTER_IIR_PARALLEL is treated as FILTER_IIR)
+   */
+  ResamplerBank (Resampler2::Mode      mode,
+                 uint                  ratio,
+                 Resampler2::Precision precision,
+                 uint                  n_streams,
+                 Resampler2::Filter    filter = Resampler2::FILTER_FIR);
+  ResamplerBank (const ResamplerBank&) = delete;
+  ResamplerBank& operator= (const ResamplerBank&) = delete;
+  ~ResamplerBank();
+  /**
+   * resample a block of each active stream: input[s] and output[s] point to
+   * the samples of stream s (they are not used for inactive streams)
+   */
+  void
+  process_block (const float * const *input, uint n_input_samples, float * const *output);
+  /**
+   * resample a block of interleaved data: frame i consists of the samples
+   * input[i * n_streams() + s] of all streams s (samples of inactive streams
+   * are not used)
+   */
+  void
+  process_block_interleaved (const float *input, uint n_input_frames, float *output);
+  /**
+   * activate or deactivate a stream, activating a stream resets its state
+   */
+  void
+  set_active (uint stream, bool active);
+  /**
+   * return whether a stream is active
+   */
+  bool
+  active (uint stream) const
+  {
+    return active_[stream];
+  }
+  /**
+   * return the number of streams
+   */
+  uint
+  n_streams() const
+  {
+    return n_streams_;
+  }
+  /**
+   * return the delay introduced by each resampler (same as Resampler2::delay())
+   */
+  double
+  delay() const
+  {
+    return delay_;
+  }
+  /**
+   * clear internal history of all streams
+   */
+  void
+  reset();
+  /**
+   * return the instruction set used by the bank
+   */
+  Resampler2::InstructionSet
+  instruction_set() const
+  {
+    return iset_;
+  }
+};
+
+/**
+ * \brief Oversampled processing of a nonlinearity (like saturation)
+ *
+ * Oversampler upsamples the input by ratio, applies a nonlinear function to
+ * the oversampled signal and downsamples the result. The processing is done
+ * in tiles that fit into the L1 cache (see Resampler2::set_tile_size()), so
+ * the oversampled signal is never written to a buffer of the size of the
+ * whole block.
+ *
+ * The function object is either called for each sample:
+ * \code
+ * float operator() (float sample);
+ * \endcode
+ * or (if that is not possible) once for each tile of the oversampled signal,
+ * which allows processing the samples with SIMD instructions:
+ * \code
+ * void operator() (float *samples, uint n_samples); // modifies samples in-place
+ * \endcode
+ */
+template<class Func>
+class Oversampler {
+  /* 16 KB of oversampled signal and intermediate stage outputs for each tile */
+  static constexpr uint L1_BUDGET = 4096;
+
+  Resampler2          ups_;
+  Resampler2          downs_;
+  Func                func_;
+  uint                ratio_;
+  uint                tile_size_;
+  AlignedArray<float> scratch_;
+
+  template<class F>
+  static auto
+  apply (F& func, float *samples, uint n_samples, int) -> decltype (func (samples[0]), void())
+  {
+    for (uint i = 0; i < n_samples; i++)
+      samples[i] = func (samples[i]);
+  }
+  template<class F>
+  static void
+  apply (F& func, float *samples, uint n_samples, long)
+  {
+    func (samples, n_samples);
+  }
+  uint
+  compute_tile_size() const
+  {
+    /* floats per 16 input samples: oversampled signal + scratch memory used by both resamplers
+     * (mono processing doesn't use the io part of the scratch memory, see Resampler2::tile_tmp_size())
+     */
+    const size_t size16 = 16 * ratio_ + ups_.tile_tmp_size (16) + ups_.tile_stage_size (16) +
+                          downs_.tile_tmp_size (16 * ratio_) + downs_.tile_stage_size (16 * ratio_);
+    return std::max<size_t> (16, L1_BUDGET / size16 * 16);
+  }
+  size_t
+  compute_scratch_size() const
+  {
+    /* the resamplers are never run concurrently, so they can share their scratch memory */
+    return tile_size_ * ratio_ + std::max (ups_.scratch_size (tile_size_), downs_.scratch_size (tile_size_ * ratio_));
+  }
+public:
+  /**
+   * creates an oversampler, ratio must be 2, 4 or 8
+   */
+  Oversampler (uint                  ratio,
+               Resampler2::Precision precision,
+               Func                  func = Func(),
+               Resampler2::Filter    filter = Resampler2::FILTER_FIR) :
+    ups_ (Resampler2::UP, ratio, precision, true, filter),
+    downs_ (Resampler2::DOWN, ratio, precision, true, filter),
+    func_ (func),
+    ratio_ (ratio),
+    tile_size_ (compute_tile_size()),
+    scratch_ (compute_scratch_size())
+  {
+    float *stage_scratch = &scratch_[tile_size_ * ratio_];
+    ups_.set_tile_size (tile_size_, stage_scratch);
+    downs_.set_tile_size (tile_size_ * ratio_, stage_scratch);
+  }
+  /**
+   * process a block of samples (input and output may point to the same buffer)
+   */
+  void
+  process_block (const float *input, uint n_input_samples, float *output)
+  {
+    float *oversampled = &scratch_[0];
+    while (n_input_samples)
+      {
+        const uint n_todo_samples = std::min (tile_size_, n_input_samples);
+
+        ups_.process_block (input, n_todo_samples, oversampled);
+        apply (func_, oversampled, n_todo_samples * ratio_, 0);
+        downs_.process_block (oversampled, n_todo_samples * ratio_, output);
+
+        input += n_todo_samples;
+        output += n_todo_samples;
+        n_input_samples -= n_todo_samples;
+      }
+  }
+  /**
+   * return the delay of the round trip (upsampling + downsampling) in samples
+   */
+  double
+  delay() const
+  {
+    return ups_.delay() / ratio_ + downs_.delay();
+  }
+  /**
+   * clear internal history of both resamplers
+   */
+  void
+  reset()
+  {
+    ups_.reset();
+    downs_.reset();
+  }
+  /**
+   * return the function object applied to the oversampled signal
+   */
+  Func&
+  func()
+  {
+    return func_;
+  }
+  /**
+   * return the tile size (in input samples)
+   */
+  uint
+  tile_size() const
+  {
+    return tile_size_;
+  }
 };
 
 } /* namespace PandaResampler */
@@ -382,31 +1047,39 @@ PandaResampler::Resampler2 class provides the API.
 #include <cmath>
 
 using PandaResampler::Resampler2;
+using PandaResampler::Oversampler;
 
 class Saturation
 {
   static constexpr int OVERSAMPLE = 8;
   static constexpr auto PREC      = Resampler2::PREC_72DB;
-  static constexpr float DRIVE    = 3;
 
-  Resampler2 ups { Resampler2::UP, OVERSAMPLE, PREC };
-  Resampler2 downs { Resampler2::DOWN, OVERSAMPLE, PREC };
+  struct Tanh
+  {
+    float drive = 3;
+
+    float
+    operator() (float x) const
+    {
+      return std::tanh (x * drive);
+    }
+  };
+  Oversampler<Tanh> oversampler { OVERSAMPLE, PREC };
 public:
   void
   reset()
   {
-    ups.reset();
-    downs.reset();
+    oversampler.reset();
+  }
+  void
+  set_drive (float drive)
+  {
+    oversampler.func().drive = drive;
   }
   void
   process (const float *in, size_t n_samples, float *out)
   {
-    float tmp[n_samples * OVERSAMPLE];
-
-    ups.process_block (in, n_samples, tmp);
-    for (size_t i = 0; i < n_samples * OVERSAMPLE; i++)
-      tmp[i] = std::tanh (tmp[i] * DRIVE);
-    downs.process_block (tmp, n_samples * OVERSAMPLE, out);
+    oversampler.process_block (in, n_samples, out);
   }
 };
 
@@ -0,0 +1,223 @@
+/*****************************************************************************
+
+        Downsampler2x2Sse.hpp
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (hiir_Downsampler2x2Sse_CODEHEADER_INCLUDED)
+#define hiir_Downsampler2x2Sse_CODEHEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/StageProc2Sse.h"
+
+#include <cassert>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*
+==============================================================================
+Name: ctor
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+Downsampler2x2Sse <NC>::Downsampler2x2Sse ()
+:	_filter ()
+{
+	for (int i = 0; i < _nbr_pairs + 1; ++i)
+	{
+		_mm_store_ps (_filter [i]._coef, _mm_setzero_ps ());
+	}
+	if (NBR_COEFS < _nbr_pairs * 2)
+	{
+		_filter [_nbr_pairs]._coef [1] = 1;
+		_filter [_nbr_pairs]._coef [3] = 1;
+	}
+
+	clear_buffers ();
+}
+
+
+
+/*
+==============================================================================
+Name: set_coefs
+Description:
+	Sets filter coefficients. Generate them with the PolyphaseIir2Designer
+	class.
+	Call this function before doing any processing.
+Input parameters:
+	- coef_arr: Array of coefficients. There should be as many coefficients as
+		mentioned in the class template parameter.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Downsampler2x2Sse <NC>::set_coefs (const double coef_arr [NBR_COEFS])
+{
+	assert (coef_arr != nullptr);
+
+	for (int i = 0; i < NBR_COEFS; ++i)
+	{
+		const int      stage = (i >> 1) + 1;
+		const int      pos   = i & 1;
+		_filter [stage]._coef [pos    ] = DataType (coef_arr [i]);
+		_filter [stage]._coef [pos + 2] = DataType (coef_arr [i]);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: process_sample
+Description:
+	Downsamples (x2) two stereo frames, to generate one output frame.
+	Samples are interleaved: in_ptr [pos * 2 + chn].
+Input parameters:
+	- in_ptr: pointer on the two frames to decimate
+Returns: Samplerate-reduced frame, left channel in lane 0, right channel in
+	lane 1.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+__m128	Downsampler2x2Sse <NC>::process_sample (const float in_ptr [_nbr_chn * 2])
+{
+	assert (in_ptr != nullptr);
+
+	return process_sample (_mm_loadu_ps (in_ptr));
+}
+
+
+
+/*
+==============================================================================
+Name: process_sample
+Description:
+	Downsamples (x2) two stereo frames, to generate one output frame.
+Input parameters:
+	- in: the two frames to decimate, interleaved: L0, R0, L1, R1
+Returns: Samplerate-reduced frame, left channel in lane 0, right channel in
+	lane 1.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+__m128	Downsampler2x2Sse <NC>::process_sample (__m128 in)
+{
+	// The second frame goes to path 0, the first one to path 1
+	auto           x = _mm_shuffle_ps (in, in, _MM_SHUFFLE (1, 3, 0, 2));
+	StageProc2Sse <_nbr_pairs>::process_sample_pos (_nbr_pairs, x, &_filter [0]);
+
+	x = _mm_shuffle_ps (x, x, _MM_SHUFFLE (3, 1, 2, 0));
+	x = _mm_add_ps (x, _mm_movehl_ps (x, x));
+
+	return _mm_mul_ps (x, _mm_set1_ps (0.5f));
+}
+
+
+
+/*
+==============================================================================
+Name: process_block
+Description:
+	Downsamples (x2) a block of samples.
+	Samples are interleaved: in_ptr [pos * 2 + chn].
+	Input and output blocks may overlap, see assert() for details.
+Input parameters:
+	- in_ptr: Input array, containing nbr_spl * 2 * 2 samples.
+	- nbr_spl: Number of frames to output, > 0
+Output parameters:
+	- out_ptr: Array for the output samples, capacity: nbr_spl * 2 samples.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Downsampler2x2Sse <NC>::process_block (float out_ptr [], const float in_ptr [], long nbr_spl)
+{
+	assert (in_ptr  != nullptr);
+	assert (out_ptr != nullptr);
+	assert (out_ptr <= in_ptr || out_ptr >= in_ptr + nbr_spl * _nbr_chn * 2);
+	assert (nbr_spl > 0);
+
+	for (long pos = 0; pos < nbr_spl; ++pos)
+	{
+		const __m128   x = process_sample (in_ptr + pos * _nbr_chn * 2);
+		_mm_storel_pi (reinterpret_cast <__m64 *> (out_ptr + pos * _nbr_chn), x);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: clear_buffers
+Description:
+	Clears filter memory, as if it processed silence since an infinite amount
+	of time.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Downsampler2x2Sse <NC>::clear_buffers ()
+{
+	for (int i = 0; i < _nbr_pairs + 1; ++i)
+	{
+		_mm_store_ps (_filter [i]._mem, _mm_setzero_ps ());
+	}
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+}  // namespace hiir
+
+}  // namespace PandaResampler
+
+
+
+#endif   // hiir_Downsampler2x2Sse_CODEHEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
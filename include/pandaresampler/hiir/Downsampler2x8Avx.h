@@ -0,0 +1,129 @@
+/*****************************************************************************
+
+        Downsampler2x8Avx.h
+        Based on hiir by Laurent de Soras
+
+Downsamples by a factor 2 the input signal, using AVX instruction set.
+Processes 8 independent channels at once, one channel per vector lane.
+
+This object must be aligned on a 32-byte boundary!
+
+Template parameters:
+	- NC: number of coefficients, > 0
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#pragma once
+#if ! defined (hiir_Downsampler2x8Avx_HEADER_INCLUDED)
+#define hiir_Downsampler2x8Avx_HEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/def.h"
+#include "pandaresampler/hiir/StageDataAvx.h"
+
+#include <immintrin.h>
+
+#include <array>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+template <int NC>
+class Downsampler2x8Avx
+{
+
+	static_assert ((NC > 0), "Number of coefficient must be positive.");
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	typedef float DataType;
+	static constexpr int _nbr_chn  = 8;
+	static constexpr int NBR_COEFS = NC;
+
+	               Downsampler2x8Avx ();
+	               Downsampler2x8Avx (const Downsampler2x8Avx &other) = default;
+	               Downsampler2x8Avx (Downsampler2x8Avx &&other)      = default;
+	               ~Downsampler2x8Avx ()                              = default;
+
+	Downsampler2x8Avx &
+	               operator = (const Downsampler2x8Avx &other)        = default;
+	Downsampler2x8Avx &
+	               operator = (Downsampler2x8Avx &&other)             = default;
+
+	void           set_coefs (const double coef_arr [NBR_COEFS]);
+
+	hiir_FORCEINLINE hiir_TARGET_AVX __m256
+	               process_sample (const float in_ptr [_nbr_chn * 2]);
+	hiir_FORCEINLINE hiir_TARGET_AVX __m256
+	               process_sample (__m256 in_0, __m256 in_1);
+	hiir_TARGET_AVX void
+	               process_block (float out_ptr [], const float in_ptr [], long nbr_spl);
+
+	void           clear_buffers ();
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+protected:
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	typedef std::array <StageDataAvx, NBR_COEFS + 2> Filter;   // Stage 0 contains only input memory
+
+	Filter         _filter;		// Should be the first member (thus easier to align)
+
+
+
+/*\\\ FORBIDDEN MEMBER FUNCTIONS \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	bool           operator == (const Downsampler2x8Avx &other) const = delete;
+	bool           operator != (const Downsampler2x8Avx &other) const = delete;
+
+}; // class Downsampler2x8Avx
+
+
+
+}  // namespace hiir
+
+} // namespace PandaResampler
+
+
+
+#include "pandaresampler/hiir/Downsampler2x8Avx.hpp"
+
+
+
+#endif   // hiir_Downsampler2x8Avx_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -0,0 +1,226 @@
+/*****************************************************************************
+
+        Downsampler2x8Avx.hpp
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (hiir_Downsampler2x8Avx_CODEHEADER_INCLUDED)
+#define hiir_Downsampler2x8Avx_CODEHEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/StageProc8Avx.h"
+
+#include <cassert>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*
+==============================================================================
+Name: ctor
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+Downsampler2x8Avx <NC>::Downsampler2x8Avx ()
+:	_filter ()
+{
+	for (int i = 0; i < NBR_COEFS + 2; ++i)
+	{
+		for (int chn = 0; chn < _nbr_chn; ++chn)
+		{
+			_filter [i]._coef [chn] = 0;
+		}
+	}
+
+	clear_buffers ();
+}
+
+
+
+/*
+==============================================================================
+Name: set_coefs
+Description:
+	Sets filter coefficients. Generate them with the PolyphaseIir2Designer
+	class.
+	Call this function before doing any processing.
+Input parameters:
+	- coef_arr: Array of coefficients. There should be as many coefficients as
+		mentioned in the class template parameter.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Downsampler2x8Avx <NC>::set_coefs (const double coef_arr [NBR_COEFS])
+{
+	assert (coef_arr != nullptr);
+
+	for (int i = 0; i < NBR_COEFS; ++i)
+	{
+		for (int chn = 0; chn < _nbr_chn; ++chn)
+		{
+			_filter [i + 2]._coef [chn] = DataType (coef_arr [i]);
+		}
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: process_sample
+Description:
+	Downsamples (x2) one pair of samples, to generate one output sample.
+	Samples are interleaved: in_ptr [pos * 8 + chn].
+Input parameters:
+	- in_ptr: pointer on the two samples to decimate, for all 8 channels
+Returns: Samplerate-reduced sample, one value per channel.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+__m256	Downsampler2x8Avx <NC>::process_sample (const float in_ptr [_nbr_chn * 2])
+{
+	assert (in_ptr != nullptr);
+
+	const __m256   in_0 = _mm256_loadu_ps (in_ptr           );
+	const __m256   in_1 = _mm256_loadu_ps (in_ptr + _nbr_chn);
+
+	return process_sample (in_0, in_1);
+}
+
+
+
+/*
+==============================================================================
+Name: process_sample
+Description:
+	Downsamples (x2) one pair of samples, to generate one output sample.
+Input parameters:
+	- in_0: first sample, one value per channel
+	- in_1: second sample, one value per channel
+Returns: Samplerate-reduced sample, one value per channel.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+__m256	Downsampler2x8Avx <NC>::process_sample (__m256 in_0, __m256 in_1)
+{
+	__m256         spl_0 = in_1;
+	__m256         spl_1 = in_0;
+
+	StageProc8Avx <NBR_COEFS>::process_sample_pos (
+		NBR_COEFS, spl_0, spl_1, _filter.data ()
+	);
+
+	return _mm256_mul_ps (_mm256_add_ps (spl_0, spl_1), _mm256_set1_ps (0.5f));
+}
+
+
+
+/*
+==============================================================================
+Name: process_block
+Description:
+	Downsamples (x2) a block of samples.
+	Samples are interleaved: in_ptr [pos * 8 + chn].
+	Input and output blocks may overlap, see assert() for details.
+Input parameters:
+	- in_ptr: Input array, containing nbr_spl * 2 * 8 samples.
+	- nbr_spl: Number of samples to output for each channel, > 0
+Output parameters:
+	- out_ptr: Array for the output samples, capacity: nbr_spl * 8 samples.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Downsampler2x8Avx <NC>::process_block (float out_ptr [], const float in_ptr [], long nbr_spl)
+{
+	assert (in_ptr  != nullptr);
+	assert (out_ptr != nullptr);
+	assert (out_ptr <= in_ptr || out_ptr >= in_ptr + nbr_spl * _nbr_chn * 2);
+	assert (nbr_spl > 0);
+
+	for (long pos = 0; pos < nbr_spl; ++pos)
+	{
+		const __m256   x = process_sample (in_ptr + pos * _nbr_chn * 2);
+		_mm256_storeu_ps (out_ptr + pos * _nbr_chn, x);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: clear_buffers
+Description:
+	Clears filter memory, as if it processed silence since an infinite amount
+	of time.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Downsampler2x8Avx <NC>::clear_buffers ()
+{
+	for (int i = 0; i < NBR_COEFS + 2; ++i)
+	{
+		for (int chn = 0; chn < _nbr_chn; ++chn)
+		{
+			_filter [i]._mem [chn] = 0;
+		}
+	}
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+}  // namespace hiir
+
+}  // namespace PandaResampler
+
+
+
+#endif   // hiir_Downsampler2x8Avx_CODEHEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
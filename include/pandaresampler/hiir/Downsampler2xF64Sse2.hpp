@@ -0,0 +1,196 @@
+/*****************************************************************************
+
+        Downsampler2xF64Sse2.hpp
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (hiir_Downsampler2xF64Sse2_CODEHEADER_INCLUDED)
+#define hiir_Downsampler2xF64Sse2_CODEHEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/StageProcF64Sse2.h"
+
+#include <cassert>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*
+==============================================================================
+Name: ctor
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+Downsampler2xF64Sse2 <NC>::Downsampler2xF64Sse2 ()
+:	_filter ()
+{
+	for (int i = 0; i < _nbr_pairs + 1; ++i)
+	{
+		_mm_store_pd (_filter [i]._coef, _mm_setzero_pd ());
+	}
+	if (NBR_COEFS < _nbr_pairs * 2)
+	{
+		_filter [_nbr_pairs]._coef [1] = 1;
+	}
+
+	clear_buffers ();
+}
+
+
+
+/*
+==============================================================================
+Name: set_coefs
+Description:
+	Sets filter coefficients. Generate them with the PolyphaseIir2Designer
+	class.
+	Call this function before doing any processing.
+Input parameters:
+	- coef_arr: Array of coefficients. There should be as many coefficients as
+		mentioned in the class template parameter.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Downsampler2xF64Sse2 <NC>::set_coefs (const double coef_arr [NBR_COEFS])
+{
+	assert (coef_arr != nullptr);
+
+	for (int i = 0; i < NBR_COEFS; ++i)
+	{
+		const int      stage = (i >> 1) + 1;
+		const int      pos   = i & 1;
+		_filter [stage]._coef [pos] = DataType (coef_arr [i]);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: process_sample
+Description:
+	Downsamples (x2) one pair of samples, to generate one output sample.
+Input parameters:
+	- in_ptr: pointer on the two samples to decimate
+Returns: Samplerate-reduced sample.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+double	Downsampler2xF64Sse2 <NC>::process_sample (const double in_ptr [2])
+{
+	assert (in_ptr != nullptr);
+
+	// The second sample goes to path 0, the first one to path 1
+	const __m128d  in = _mm_loadu_pd (in_ptr);
+	auto           x  = _mm_shuffle_pd (in, in, 1);
+	StageProcF64Sse2 <_nbr_pairs>::process_sample_pos (_nbr_pairs, x, &_filter [0]);
+
+	x = _mm_add_sd (x, _mm_unpackhi_pd (x, x));
+
+	return _mm_cvtsd_f64 (x) * 0.5;
+}
+
+
+
+/*
+==============================================================================
+Name: process_block
+Description:
+	Downsamples (x2) a block of samples.
+	Input and output blocks may overlap, see assert() for details.
+Input parameters:
+	- in_ptr: Input array, containing nbr_spl * 2 samples.
+	- nbr_spl: Number of samples to output, > 0
+Output parameters:
+	- out_ptr: Array for the output samples, capacity: nbr_spl samples.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Downsampler2xF64Sse2 <NC>::process_block (double out_ptr [], const double in_ptr [], long nbr_spl)
+{
+	assert (in_ptr  != nullptr);
+	assert (out_ptr != nullptr);
+	assert (out_ptr <= in_ptr || out_ptr >= in_ptr + nbr_spl * 2);
+	assert (nbr_spl > 0);
+
+	for (long pos = 0; pos < nbr_spl; ++pos)
+	{
+		out_ptr [pos] = process_sample (in_ptr + pos * 2);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: clear_buffers
+Description:
+	Clears filter memory, as if it processed silence since an infinite amount
+	of time.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Downsampler2xF64Sse2 <NC>::clear_buffers ()
+{
+	for (int i = 0; i < _nbr_pairs + 1; ++i)
+	{
+		_mm_store_pd (_filter [i]._mem, _mm_setzero_pd ());
+	}
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+}  // namespace hiir
+
+}  // namespace PandaResampler
+
+
+
+#endif   // hiir_Downsampler2xF64Sse2_CODEHEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -0,0 +1,62 @@
+/*****************************************************************************
+
+        StageData2Sse.h
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#pragma once
+#if ! defined (hiir_StageData2Sse_HEADER_INCLUDED)
+#define hiir_StageData2Sse_HEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+// Like StageDataSse, but for two channels: each vector holds one pair of
+// coefficients (one per polyphase path) for the left and the right channel.
+class StageData2Sse
+{
+
+public:
+
+	alignas (16) float
+	               _coef [4];  // a_{2n}, a_{2n+1}, a_{2n}, a_{2n+1}
+	alignas (16) float
+	               _mem [4];   // y of the stage: L path 0, L path 1, R path 0, R path 1
+
+}; // class StageData2Sse
+
+
+
+}  // namespace hiir
+
+} // namespace PandaResampler
+
+
+
+#endif   // hiir_StageData2Sse_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
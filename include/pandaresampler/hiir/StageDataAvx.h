@@ -0,0 +1,61 @@
+/*****************************************************************************
+
+        StageDataAvx.h
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#pragma once
+#if ! defined (hiir_StageDataAvx_HEADER_INCLUDED)
+#define hiir_StageDataAvx_HEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+// One coefficient and the corresponding memory for 8 channels
+class StageDataAvx
+{
+
+public:
+
+	alignas (32) float
+	               _coef [8];  // a_{n-2}, same value for all channels
+	alignas (32) float
+	               _mem [8];   // y of the stage, one value per channel
+
+}; // class StageDataAvx
+
+
+
+}  // namespace hiir
+
+} // namespace PandaResampler
+
+
+
+#endif   // hiir_StageDataAvx_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -0,0 +1,62 @@
+/*****************************************************************************
+
+        StageDataF64Sse2.h
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#pragma once
+#if ! defined (hiir_StageDataF64Sse2_HEADER_INCLUDED)
+#define hiir_StageDataF64Sse2_HEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+// Double precision stage data: each vector holds one pair of coefficients,
+// one per polyphase path.
+class StageDataF64Sse2
+{
+
+public:
+
+	alignas (16) double
+	               _coef [2];  // a_{2n}, a_{2n+1}
+	alignas (16) double
+	               _mem [2];   // y of the stage: path 0, path 1
+
+}; // class StageDataF64Sse2
+
+
+
+}  // namespace hiir
+
+} // namespace PandaResampler
+
+
+
+#endif   // hiir_StageDataF64Sse2_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
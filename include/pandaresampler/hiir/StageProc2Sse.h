@@ -0,0 +1,128 @@
+/*****************************************************************************
+
+        StageProc2Sse.h
+        Based on hiir by Laurent de Soras
+
+Template parameters:
+	- REMAINING: number of remaining coefficient pairs to process, >= 0
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#pragma once
+#if ! defined (hiir_StageProc2Sse_HEADER_INCLUDED)
+#define hiir_StageProc2Sse_HEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/def.h"
+#include "pandaresampler/hiir/StageData2Sse.h"
+
+#include "pandaresampler/simd.hh"
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+template <int REMAINING>
+class StageProc2Sse
+{
+
+	static_assert ((REMAINING >= 0), "REMAINING must be >= 0");
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	static hiir_FORCEINLINE void
+	               process_sample_pos (const int nbr_pairs, __m128 &spl, StageData2Sse *stage_arr);
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+protected:
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+
+
+/*\\\ FORBIDDEN MEMBER FUNCTIONS \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	               StageProc2Sse ()                                     = delete;
+	               StageProc2Sse (const StageProc2Sse <REMAINING> &other) = delete;
+	               StageProc2Sse (StageProc2Sse <REMAINING> &&other)      = delete;
+	               ~StageProc2Sse ()                                    = delete;
+	StageProc2Sse <REMAINING> &
+	               operator = (const StageProc2Sse <REMAINING> &other)  = delete;
+	StageProc2Sse <REMAINING> &
+	               operator = (StageProc2Sse <REMAINING> &&other)       = delete;
+	bool           operator == (const StageProc2Sse <REMAINING> &other) = delete;
+	bool           operator != (const StageProc2Sse <REMAINING> &other) = delete;
+
+}; // class StageProc2Sse
+
+template <>
+class StageProc2Sse <0>
+{
+
+public:
+
+	static hiir_FORCEINLINE void
+	               process_sample_pos (const int nbr_pairs, __m128 &spl, StageData2Sse *stage_arr);
+
+private:
+
+	               StageProc2Sse ()                             = delete;
+	               StageProc2Sse (const StageProc2Sse <0> &other) = delete;
+	               StageProc2Sse (StageProc2Sse <0> &&other)      = delete;
+	               ~StageProc2Sse ()                            = delete;
+	StageProc2Sse <0> &
+	               operator = (const StageProc2Sse <0> &other)  = delete;
+	StageProc2Sse <0> &
+	               operator = (StageProc2Sse <0> &&other)       = delete;
+	bool           operator == (const StageProc2Sse <0> &other) = delete;
+	bool           operator != (const StageProc2Sse <0> &other) = delete;
+
+}; // class StageProc2Sse
+
+
+
+}  // namespace hiir
+
+} // namespace PandaResampler
+
+
+
+#include "pandaresampler/hiir/StageProc2Sse.hpp"
+
+
+
+#endif   // hiir_StageProc2Sse_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
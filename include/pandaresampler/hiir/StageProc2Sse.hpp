@@ -0,0 +1,88 @@
+/*****************************************************************************
+
+        StageProc2Sse.hpp
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (hiir_StageProc2Sse_CODEHEADER_INCLUDED)
+#define hiir_StageProc2Sse_CODEHEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+// spl contains the input of both polyphase paths for both channels:
+// L path 0, L path 1, R path 0, R path 1. Each step processes one pair of
+// coefficients (one allpass filter per path and channel).
+template <int REMAINING>
+void	StageProc2Sse <REMAINING>::process_sample_pos (const int nbr_pairs, __m128 &spl, StageData2Sse *stage_arr)
+{
+	const int      cnt = nbr_pairs + 1 - REMAINING;
+	const __m128   tmp = _mm_add_ps (
+		_mm_mul_ps (
+			_mm_sub_ps (spl, _mm_load_ps (stage_arr [cnt    ]._mem)),
+			_mm_load_ps (stage_arr [cnt    ]._coef)
+		),
+		_mm_load_ps (stage_arr [cnt - 1]._mem)
+	);
+	_mm_store_ps (stage_arr [cnt - 1]._mem, spl);
+	spl = tmp;
+
+	StageProc2Sse <REMAINING - 1>::process_sample_pos (
+		nbr_pairs,
+		spl,
+		stage_arr
+	);
+}
+
+void	StageProc2Sse <0>::process_sample_pos (const int nbr_pairs, __m128 &spl, StageData2Sse *stage_arr)
+{
+	_mm_store_ps (stage_arr [nbr_pairs]._mem, spl);
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+}  // namespace hiir
+
+}  // namespace PandaResampler
+
+
+
+#endif   // hiir_StageProc2Sse_CODEHEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -0,0 +1,162 @@
+/*****************************************************************************
+
+        StageProc8Avx.h
+        Based on hiir by Laurent de Soras
+
+Processes the all-pass stages for 8 independent channels at once, one
+channel per __m256 lane. This is the AVX counterpart of StageProcFpu.
+
+Template parameters:
+
+- REMAINING: Number of remaining coefficients to process, >= 0
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#pragma once
+#if ! defined (hiir_StageProc8Avx_HEADER_INCLUDED)
+#define hiir_StageProc8Avx_HEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/def.h"
+#include "pandaresampler/hiir/StageDataAvx.h"
+
+#include <immintrin.h>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+template <int REMAINING>
+class StageProc8Avx
+{
+
+	static_assert ((REMAINING >= 0), "REMAINING must be >= 0");
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	static hiir_FORCEINLINE hiir_TARGET_AVX void
+	               process_sample_pos (const int nbr_coefs, __m256 &spl_0, __m256 &spl_1, StageDataAvx *stage_arr);
+	static hiir_FORCEINLINE hiir_TARGET_AVX void
+	               process_sample_neg (const int nbr_coefs, __m256 &spl_0, __m256 &spl_1, StageDataAvx *stage_arr);
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+protected:
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+
+
+/*\\\ FORBIDDEN MEMBER FUNCTIONS \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	               StageProc8Avx ()                                     = delete;
+	               StageProc8Avx (const StageProc8Avx <REMAINING> &other) = delete;
+	               StageProc8Avx (StageProc8Avx <REMAINING> &&other)      = delete;
+	               ~StageProc8Avx ()                                    = delete;
+	StageProc8Avx <REMAINING> &
+	               operator = (const StageProc8Avx <REMAINING> &other)  = delete;
+	StageProc8Avx <REMAINING> &
+	               operator = (StageProc8Avx <REMAINING> &&other)       = delete;
+	bool           operator == (const StageProc8Avx <REMAINING> &other) = delete;
+	bool           operator != (const StageProc8Avx <REMAINING> &other) = delete;
+
+}; // class StageProc8Avx
+
+template <>
+class StageProc8Avx <0>
+{
+
+public:
+
+	static hiir_FORCEINLINE hiir_TARGET_AVX void
+	               process_sample_pos (const int nbr_coefs, __m256 &spl_0, __m256 &spl_1, StageDataAvx *stage_arr);
+	static hiir_FORCEINLINE hiir_TARGET_AVX void
+	               process_sample_neg (const int nbr_coefs, __m256 &spl_0, __m256 &spl_1, StageDataAvx *stage_arr);
+
+private:
+
+	               StageProc8Avx ()                             = delete;
+	               StageProc8Avx (const StageProc8Avx <0> &other) = delete;
+	               StageProc8Avx (StageProc8Avx <0> &&other)      = delete;
+	               ~StageProc8Avx ()                            = delete;
+	StageProc8Avx <0> &
+	               operator = (const StageProc8Avx <0> &other)  = delete;
+	StageProc8Avx <0> &
+	               operator = (StageProc8Avx <0> &&other)       = delete;
+	bool           operator == (const StageProc8Avx <0> &other) = delete;
+	bool           operator != (const StageProc8Avx <0> &other) = delete;
+
+}; // class StageProc8Avx
+
+template <>
+class StageProc8Avx <1>
+{
+
+public:
+
+	static hiir_FORCEINLINE hiir_TARGET_AVX void
+	               process_sample_pos (const int nbr_coefs, __m256 &spl_0, __m256 &spl_1, StageDataAvx *stage_arr);
+	static hiir_FORCEINLINE hiir_TARGET_AVX void
+	               process_sample_neg (const int nbr_coefs, __m256 &spl_0, __m256 &spl_1, StageDataAvx *stage_arr);
+
+private:
+
+	               StageProc8Avx ()                             = delete;
+	               StageProc8Avx (const StageProc8Avx <1> &other) = delete;
+	               StageProc8Avx (StageProc8Avx <1> &&other)      = delete;
+	               ~StageProc8Avx ()                            = delete;
+	StageProc8Avx <1> &
+	               operator = (const StageProc8Avx <1> &other)  = delete;
+	StageProc8Avx <1> &
+	               operator = (StageProc8Avx <1> &&other)       = delete;
+	bool           operator == (const StageProc8Avx <1> &other) = delete;
+	bool           operator != (const StageProc8Avx <1> &other) = delete;
+
+}; // class StageProc8Avx
+
+
+
+}  // namespace hiir
+
+} // namespace PandaResampler
+
+
+
+#include "pandaresampler/hiir/StageProc8Avx.hpp"
+
+
+
+#endif   // hiir_StageProc8Avx_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -0,0 +1,128 @@
+/*****************************************************************************
+
+        StageProcF64Sse2.h
+        Based on hiir by Laurent de Soras
+
+Template parameters:
+	- REMAINING: number of remaining coefficient pairs to process, >= 0
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#pragma once
+#if ! defined (hiir_StageProcF64Sse2_HEADER_INCLUDED)
+#define hiir_StageProcF64Sse2_HEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/def.h"
+#include "pandaresampler/hiir/StageDataF64Sse2.h"
+
+#include "pandaresampler/simd.hh"
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+template <int REMAINING>
+class StageProcF64Sse2
+{
+
+	static_assert ((REMAINING >= 0), "REMAINING must be >= 0");
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	static hiir_FORCEINLINE void
+	               process_sample_pos (const int nbr_pairs, __m128d &spl, StageDataF64Sse2 *stage_arr);
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+protected:
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+
+
+/*\\\ FORBIDDEN MEMBER FUNCTIONS \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	               StageProcF64Sse2 ()                                     = delete;
+	               StageProcF64Sse2 (const StageProcF64Sse2 <REMAINING> &other) = delete;
+	               StageProcF64Sse2 (StageProcF64Sse2 <REMAINING> &&other)      = delete;
+	               ~StageProcF64Sse2 ()                                    = delete;
+	StageProcF64Sse2 <REMAINING> &
+	               operator = (const StageProcF64Sse2 <REMAINING> &other)  = delete;
+	StageProcF64Sse2 <REMAINING> &
+	               operator = (StageProcF64Sse2 <REMAINING> &&other)       = delete;
+	bool           operator == (const StageProcF64Sse2 <REMAINING> &other) = delete;
+	bool           operator != (const StageProcF64Sse2 <REMAINING> &other) = delete;
+
+}; // class StageProcF64Sse2
+
+template <>
+class StageProcF64Sse2 <0>
+{
+
+public:
+
+	static hiir_FORCEINLINE void
+	               process_sample_pos (const int nbr_pairs, __m128d &spl, StageDataF64Sse2 *stage_arr);
+
+private:
+
+	               StageProcF64Sse2 ()                             = delete;
+	               StageProcF64Sse2 (const StageProcF64Sse2 <0> &other) = delete;
+	               StageProcF64Sse2 (StageProcF64Sse2 <0> &&other)      = delete;
+	               ~StageProcF64Sse2 ()                            = delete;
+	StageProcF64Sse2 <0> &
+	               operator = (const StageProcF64Sse2 <0> &other)  = delete;
+	StageProcF64Sse2 <0> &
+	               operator = (StageProcF64Sse2 <0> &&other)       = delete;
+	bool           operator == (const StageProcF64Sse2 <0> &other) = delete;
+	bool           operator != (const StageProcF64Sse2 <0> &other) = delete;
+
+}; // class StageProcF64Sse2
+
+
+
+}  // namespace hiir
+
+} // namespace PandaResampler
+
+
+
+#include "pandaresampler/hiir/StageProcF64Sse2.hpp"
+
+
+
+#endif   // hiir_StageProcF64Sse2_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
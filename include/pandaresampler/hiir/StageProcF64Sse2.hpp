@@ -0,0 +1,87 @@
+/*****************************************************************************
+
+        StageProcF64Sse2.hpp
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (hiir_StageProcF64Sse2_CODEHEADER_INCLUDED)
+#define hiir_StageProcF64Sse2_CODEHEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+// spl contains the input of both polyphase paths: path 0, path 1. Each step
+// processes one pair of coefficients (one allpass filter per path).
+template <int REMAINING>
+void	StageProcF64Sse2 <REMAINING>::process_sample_pos (const int nbr_pairs, __m128d &spl, StageDataF64Sse2 *stage_arr)
+{
+	const int      cnt = nbr_pairs + 1 - REMAINING;
+	const __m128d  tmp = _mm_add_pd (
+		_mm_mul_pd (
+			_mm_sub_pd (spl, _mm_load_pd (stage_arr [cnt    ]._mem)),
+			_mm_load_pd (stage_arr [cnt    ]._coef)
+		),
+		_mm_load_pd (stage_arr [cnt - 1]._mem)
+	);
+	_mm_store_pd (stage_arr [cnt - 1]._mem, spl);
+	spl = tmp;
+
+	StageProcF64Sse2 <REMAINING - 1>::process_sample_pos (
+		nbr_pairs,
+		spl,
+		stage_arr
+	);
+}
+
+void	StageProcF64Sse2 <0>::process_sample_pos (const int nbr_pairs, __m128d &spl, StageDataF64Sse2 *stage_arr)
+{
+	_mm_store_pd (stage_arr [nbr_pairs]._mem, spl);
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+}  // namespace hiir
+
+}  // namespace PandaResampler
+
+
+
+#endif   // hiir_StageProcF64Sse2_CODEHEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -25,7 +25,7 @@ http://www.wtfpl.net/ for more details.
 
 #include "pandaresampler/hiir/def.h"
 
-#include <xmmintrin.h>
+#include "pandaresampler/simd.hh"
 
 
 
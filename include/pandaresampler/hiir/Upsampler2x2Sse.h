@@ -0,0 +1,131 @@
+/*****************************************************************************
+
+        Upsampler2x2Sse.h
+        Based on hiir by Laurent de Soras
+
+Upsamples by a factor 2 a stereo signal, using SSE instruction set.
+Both channels are packed into one vector (two lanes per channel, one for each
+polyphase path), so processing a stereo frame costs about as much as
+processing one mono sample with Upsampler2xSse.
+
+This object must be aligned on a 16-byte boundary!
+
+Template parameters:
+	- NC: number of coefficients, > 0
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#pragma once
+#if ! defined (hiir_Upsampler2x2Sse_HEADER_INCLUDED)
+#define hiir_Upsampler2x2Sse_HEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/def.h"
+#include "pandaresampler/hiir/StageData2Sse.h"
+
+#include "pandaresampler/simd.hh"
+
+#include <array>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+template <int NC>
+class Upsampler2x2Sse
+{
+
+	static_assert ((NC > 0), "Number of coefficient must be positive.");
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	typedef float DataType;
+	static constexpr int _nbr_chn  = 2;
+	static constexpr int NBR_COEFS = NC;
+
+	               Upsampler2x2Sse ();
+	               Upsampler2x2Sse (const Upsampler2x2Sse &other)  = default;
+	               Upsampler2x2Sse (Upsampler2x2Sse &&other)       = default;
+	               ~Upsampler2x2Sse ()                             = default;
+
+	Upsampler2x2Sse &
+	               operator = (const Upsampler2x2Sse &other)       = default;
+	Upsampler2x2Sse &
+	               operator = (Upsampler2x2Sse &&other)            = default;
+
+	void           set_coefs (const double coef_arr [NBR_COEFS]);
+
+	hiir_FORCEINLINE __m128
+	               process_sample (float in_l, float in_r);
+	void           process_block (float out_ptr [], const float in_ptr [], long nbr_spl);
+
+	void           clear_buffers ();
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+protected:
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	// An odd number of coefficients is padded with a pass-through coefficient
+	static constexpr int _nbr_pairs = (NBR_COEFS + 1) / 2;
+
+	typedef std::array <StageData2Sse, _nbr_pairs + 1> Filter;   // Stage 0 contains only input memory
+
+	Filter         _filter;		// Should be the first member (thus easier to align)
+
+
+
+/*\\\ FORBIDDEN MEMBER FUNCTIONS \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	bool           operator == (const Upsampler2x2Sse &other) const = delete;
+	bool           operator != (const Upsampler2x2Sse &other) const = delete;
+
+}; // class Upsampler2x2Sse
+
+
+
+}  // namespace hiir
+
+} // namespace PandaResampler
+
+
+
+#include "pandaresampler/hiir/Upsampler2x2Sse.hpp"
+
+
+
+#endif   // hiir_Upsampler2x2Sse_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
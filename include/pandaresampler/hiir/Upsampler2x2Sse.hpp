@@ -0,0 +1,195 @@
+/*****************************************************************************
+
+        Upsampler2x2Sse.hpp
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (hiir_Upsampler2x2Sse_CODEHEADER_INCLUDED)
+#define hiir_Upsampler2x2Sse_CODEHEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/StageProc2Sse.h"
+
+#include <cassert>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*
+==============================================================================
+Name: ctor
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+Upsampler2x2Sse <NC>::Upsampler2x2Sse ()
+:	_filter ()
+{
+	for (int i = 0; i < _nbr_pairs + 1; ++i)
+	{
+		_mm_store_ps (_filter [i]._coef, _mm_setzero_ps ());
+	}
+	if (NBR_COEFS < _nbr_pairs * 2)
+	{
+		_filter [_nbr_pairs]._coef [1] = 1;
+		_filter [_nbr_pairs]._coef [3] = 1;
+	}
+
+	clear_buffers ();
+}
+
+
+
+/*
+==============================================================================
+Name: set_coefs
+Description:
+	Sets filter coefficients. Generate them with the PolyphaseIir2Designer
+	class.
+	Call this function before doing any processing.
+Input parameters:
+	- coef_arr: Array of coefficients. There should be as many coefficients as
+		mentioned in the class template parameter.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2x2Sse <NC>::set_coefs (const double coef_arr [NBR_COEFS])
+{
+	assert (coef_arr != nullptr);
+
+	for (int i = 0; i < NBR_COEFS; ++i)
+	{
+		const int      stage = (i >> 1) + 1;
+		const int      pos   = i & 1;
+		_filter [stage]._coef [pos    ] = DataType (coef_arr [i]);
+		_filter [stage]._coef [pos + 2] = DataType (coef_arr [i]);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: process_sample
+Description:
+	Upsamples (x2) one stereo frame, generating two output frames.
+Input parameters:
+	- in_l: The input sample of the left channel.
+	- in_r: The input sample of the right channel.
+Returns: The two output frames, interleaved: L0, R0, L1, R1
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+__m128	Upsampler2x2Sse <NC>::process_sample (float in_l, float in_r)
+{
+	auto           x = _mm_setr_ps (in_l, in_l, in_r, in_r);
+	StageProc2Sse <_nbr_pairs>::process_sample_pos (_nbr_pairs, x, &_filter [0]);
+
+	return _mm_shuffle_ps (x, x, _MM_SHUFFLE (3, 1, 2, 0));
+}
+
+
+
+/*
+==============================================================================
+Name: process_block
+Description:
+	Upsamples (x2) the input sample block.
+	Samples are interleaved: in_ptr [pos * 2 + chn].
+	Input and output blocks may overlap, see assert() for details.
+Input parameters:
+	- in_ptr: Input array, containing nbr_spl * 2 samples.
+	- nbr_spl: Number of input frames to process, > 0
+Output parameters:
+	- out_ptr: Output sample array, capacity: nbr_spl * 2 * 2 samples.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2x2Sse <NC>::process_block (float out_ptr [], const float in_ptr [], long nbr_spl)
+{
+	assert (out_ptr != nullptr);
+	assert (in_ptr  != nullptr);
+	assert (out_ptr >= in_ptr + nbr_spl * _nbr_chn || in_ptr >= out_ptr + nbr_spl * _nbr_chn);
+	assert (nbr_spl > 0);
+
+	for (long pos = 0; pos < nbr_spl; ++pos)
+	{
+		const __m128   x = process_sample (in_ptr [pos * 2], in_ptr [pos * 2 + 1]);
+		_mm_storeu_ps (out_ptr + pos * 4, x);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: clear_buffers
+Description:
+	Clears filter memory, as if it processed silence since an infinite amount
+	of time.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2x2Sse <NC>::clear_buffers ()
+{
+	for (int i = 0; i < _nbr_pairs + 1; ++i)
+	{
+		_mm_store_ps (_filter [i]._mem, _mm_setzero_ps ());
+	}
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+}  // namespace hiir
+
+}  // namespace PandaResampler
+
+
+
+#endif   // hiir_Upsampler2x2Sse_CODEHEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -0,0 +1,206 @@
+/*****************************************************************************
+
+        Upsampler2x8Avx.hpp
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (hiir_Upsampler2x8Avx_CODEHEADER_INCLUDED)
+#define hiir_Upsampler2x8Avx_CODEHEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/StageProc8Avx.h"
+
+#include <cassert>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*
+==============================================================================
+Name: ctor
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+Upsampler2x8Avx <NC>::Upsampler2x8Avx ()
+:	_filter ()
+{
+	for (int i = 0; i < NBR_COEFS + 2; ++i)
+	{
+		for (int chn = 0; chn < _nbr_chn; ++chn)
+		{
+			_filter [i]._coef [chn] = 0;
+		}
+	}
+
+	clear_buffers ();
+}
+
+
+
+/*
+==============================================================================
+Name: set_coefs
+Description:
+	Sets filter coefficients. Generate them with the PolyphaseIir2Designer
+	class.
+	Call this function before doing any processing.
+Input parameters:
+	- coef_arr: Array of coefficients. There should be as many coefficients as
+		mentioned in the class template parameter.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2x8Avx <NC>::set_coefs (const double coef_arr [NBR_COEFS])
+{
+	assert (coef_arr != nullptr);
+
+	for (int i = 0; i < NBR_COEFS; ++i)
+	{
+		for (int chn = 0; chn < _nbr_chn; ++chn)
+		{
+			_filter [i + 2]._coef [chn] = DataType (coef_arr [i]);
+		}
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: process_sample
+Description:
+	Upsamples (x2) the input vector, generating two output vectors.
+Input parameters:
+	- input: The input sample, one value per channel.
+Output parameters:
+	- out_0: First output sample, one value per channel.
+	- out_1: Second output sample, one value per channel.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2x8Avx <NC>::process_sample (__m256 &out_0, __m256 &out_1, __m256 input)
+{
+	__m256         even = input;
+	__m256         odd  = input;
+	StageProc8Avx <NBR_COEFS>::process_sample_pos (
+		NBR_COEFS,
+		even,
+		odd,
+		_filter.data ()
+	);
+	out_0 = even;
+	out_1 = odd;
+}
+
+
+
+/*
+==============================================================================
+Name: process_block
+Description:
+	Upsamples (x2) the input sample block.
+	Samples are interleaved: in_ptr [pos * 8 + chn].
+	Input and output blocks may overlap, see assert() for details.
+Input parameters:
+	- in_ptr: Input array, containing nbr_spl * 8 samples.
+	- nbr_spl: Number of input samples to process for each channel, > 0
+Output parameters:
+	- out_ptr: Output sample array, capacity: nbr_spl * 2 * 8 samples.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2x8Avx <NC>::process_block (float out_ptr [], const float in_ptr [], long nbr_spl)
+{
+	assert (out_ptr != nullptr);
+	assert (in_ptr  != nullptr);
+	assert (out_ptr >= in_ptr + nbr_spl * _nbr_chn || in_ptr >= out_ptr + nbr_spl * _nbr_chn);
+	assert (nbr_spl > 0);
+
+	for (long pos = 0; pos < nbr_spl; ++pos)
+	{
+		__m256         out_0;
+		__m256         out_1;
+		process_sample (out_0, out_1, _mm256_loadu_ps (in_ptr + pos * _nbr_chn));
+		_mm256_storeu_ps (out_ptr + pos * _nbr_chn * 2,            out_0);
+		_mm256_storeu_ps (out_ptr + pos * _nbr_chn * 2 + _nbr_chn, out_1);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: clear_buffers
+Description:
+	Clears filter memory, as if it processed silence since an infinite amount
+	of time.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2x8Avx <NC>::clear_buffers ()
+{
+	for (int i = 0; i < NBR_COEFS + 2; ++i)
+	{
+		for (int chn = 0; chn < _nbr_chn; ++chn)
+		{
+			_filter [i]._mem [chn] = 0;
+		}
+	}
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+}  // namespace hiir
+
+}  // namespace PandaResampler
+
+
+
+#endif   // hiir_Upsampler2x8Avx_CODEHEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
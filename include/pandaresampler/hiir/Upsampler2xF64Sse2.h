@@ -0,0 +1,128 @@
+/*****************************************************************************
+
+        Upsampler2xF64Sse2.h
+        Based on hiir by Laurent de Soras
+
+Upsamples by a factor 2 the input signal, using SSE2 instruction set and
+double precision samples. Both polyphase paths are processed in one vector.
+
+This object must be aligned on a 16-byte boundary!
+
+Template parameters:
+	- NC: number of coefficients, > 0
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#pragma once
+#if ! defined (hiir_Upsampler2xF64Sse2_HEADER_INCLUDED)
+#define hiir_Upsampler2xF64Sse2_HEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/def.h"
+#include "pandaresampler/hiir/StageDataF64Sse2.h"
+
+#include "pandaresampler/simd.hh"
+
+#include <array>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+template <int NC>
+class Upsampler2xF64Sse2
+{
+
+	static_assert ((NC > 0), "Number of coefficient must be positive.");
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	typedef double DataType;
+	static constexpr int NBR_COEFS = NC;
+
+	               Upsampler2xF64Sse2 ();
+	               Upsampler2xF64Sse2 (const Upsampler2xF64Sse2 &other)  = default;
+	               Upsampler2xF64Sse2 (Upsampler2xF64Sse2 &&other)       = default;
+	               ~Upsampler2xF64Sse2 ()                             = default;
+
+	Upsampler2xF64Sse2 &
+	               operator = (const Upsampler2xF64Sse2 &other)       = default;
+	Upsampler2xF64Sse2 &
+	               operator = (Upsampler2xF64Sse2 &&other)            = default;
+
+	void           set_coefs (const double coef_arr [NBR_COEFS]);
+
+	hiir_FORCEINLINE void
+	               process_sample (double &out_0, double &out_1, double input);
+	void           process_block (double out_ptr [], const double in_ptr [], long nbr_spl);
+
+	void           clear_buffers ();
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+protected:
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	// An odd number of coefficients is padded with a pass-through coefficient
+	static constexpr int _nbr_pairs = (NBR_COEFS + 1) / 2;
+
+	typedef std::array <StageDataF64Sse2, _nbr_pairs + 1> Filter;   // Stage 0 contains only input memory
+
+	Filter         _filter;		// Should be the first member (thus easier to align)
+
+
+
+/*\\\ FORBIDDEN MEMBER FUNCTIONS \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	bool           operator == (const Upsampler2xF64Sse2 &other) const = delete;
+	bool           operator != (const Upsampler2xF64Sse2 &other) const = delete;
+
+}; // class Upsampler2xF64Sse2
+
+
+
+}  // namespace hiir
+
+} // namespace PandaResampler
+
+
+
+#include "pandaresampler/hiir/Upsampler2xF64Sse2.hpp"
+
+
+
+#endif   // hiir_Upsampler2xF64Sse2_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -0,0 +1,195 @@
+/*****************************************************************************
+
+        Upsampler2xF64Sse2.hpp
+        Based on hiir by Laurent de Soras
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://www.wtfpl.net/ for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (hiir_Upsampler2xF64Sse2_CODEHEADER_INCLUDED)
+#define hiir_Upsampler2xF64Sse2_CODEHEADER_INCLUDED
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "pandaresampler/hiir/StageProcF64Sse2.h"
+
+#include <cassert>
+
+
+
+namespace PandaResampler
+{
+
+namespace hiir
+{
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*
+==============================================================================
+Name: ctor
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+Upsampler2xF64Sse2 <NC>::Upsampler2xF64Sse2 ()
+:	_filter ()
+{
+	for (int i = 0; i < _nbr_pairs + 1; ++i)
+	{
+		_mm_store_pd (_filter [i]._coef, _mm_setzero_pd ());
+	}
+	if (NBR_COEFS < _nbr_pairs * 2)
+	{
+		_filter [_nbr_pairs]._coef [1] = 1;
+	}
+
+	clear_buffers ();
+}
+
+
+
+/*
+==============================================================================
+Name: set_coefs
+Description:
+	Sets filter coefficients. Generate them with the PolyphaseIir2Designer
+	class.
+	Call this function before doing any processing.
+Input parameters:
+	- coef_arr: Array of coefficients. There should be as many coefficients as
+		mentioned in the class template parameter.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2xF64Sse2 <NC>::set_coefs (const double coef_arr [NBR_COEFS])
+{
+	assert (coef_arr != nullptr);
+
+	for (int i = 0; i < NBR_COEFS; ++i)
+	{
+		const int      stage = (i >> 1) + 1;
+		const int      pos   = i & 1;
+		_filter [stage]._coef [pos] = DataType (coef_arr [i]);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: process_sample
+Description:
+	Upsamples (x2) the input sample, generating two output samples.
+Input parameters:
+	- input: The input sample.
+Output parameters:
+	- out_0: First output sample.
+	- out_1: Second output sample.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2xF64Sse2 <NC>::process_sample (double &out_0, double &out_1, double input)
+{
+	auto           x = _mm_set1_pd (input);
+	StageProcF64Sse2 <_nbr_pairs>::process_sample_pos (_nbr_pairs, x, &_filter [0]);
+
+	out_0 = _mm_cvtsd_f64 (x);
+	out_1 = _mm_cvtsd_f64 (_mm_unpackhi_pd (x, x));
+}
+
+
+
+/*
+==============================================================================
+Name: process_block
+Description:
+	Upsamples (x2) the input sample block.
+	Input and output blocks may overlap, see assert() for details.
+Input parameters:
+	- in_ptr: Input array, containing nbr_spl samples.
+	- nbr_spl: Number of input samples to process, > 0
+Output parameters:
+	- out_ptr: Output sample array, capacity: nbr_spl * 2 samples.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2xF64Sse2 <NC>::process_block (double out_ptr [], const double in_ptr [], long nbr_spl)
+{
+	assert (out_ptr != nullptr);
+	assert (in_ptr  != nullptr);
+	assert (out_ptr >= in_ptr + nbr_spl || in_ptr >= out_ptr + nbr_spl);
+	assert (nbr_spl > 0);
+
+	for (long pos = 0; pos < nbr_spl; ++pos)
+	{
+		auto           x = _mm_set1_pd (in_ptr [pos]);
+		StageProcF64Sse2 <_nbr_pairs>::process_sample_pos (_nbr_pairs, x, &_filter [0]);
+		_mm_storeu_pd (out_ptr + pos * 2, x);
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: clear_buffers
+Description:
+	Clears filter memory, as if it processed silence since an infinite amount
+	of time.
+Throws: Nothing
+==============================================================================
+*/
+
+template <int NC>
+void	Upsampler2xF64Sse2 <NC>::clear_buffers ()
+{
+	for (int i = 0; i < _nbr_pairs + 1; ++i)
+	{
+		_mm_store_pd (_filter [i]._mem, _mm_setzero_pd ());
+	}
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+}  // namespace hiir
+
+}  // namespace PandaResampler
+
+
+
+#endif   // hiir_Upsampler2xF64Sse2_CODEHEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
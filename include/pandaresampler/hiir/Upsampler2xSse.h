@@ -33,7 +33,7 @@ http://www.wtfpl.net/ for more details.
 #include "pandaresampler/hiir/def.h"
 #include "pandaresampler/hiir/StageDataSse.h"
 
-#include <xmmintrin.h>
+#include "pandaresampler/simd.hh"
 
 #include <array>
 
@@ -24,7 +24,7 @@ http://www.wtfpl.net/ for more details.
 
 #include "pandaresampler/hiir/StageProcSseV2.h"
 
-#include <xmmintrin.h>
+#include "pandaresampler/simd.hh"
 
 #include <cassert>
 
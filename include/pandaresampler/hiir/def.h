@@ -60,6 +60,15 @@ namespace hiir
 	#define hiir_FORCEINLINE inline
 #endif
 
+// Functions using AVX are compiled with the target attribute (so the
+// rest of the code doesn't need to be built with -mavx); they must only
+// be called if the CPU supports AVX
+#if defined (__GNUC__) && (hiir_ARCHI == hiir_ARCHI_X86)
+	#define hiir_TARGET_AVX __attribute__ ((target ("avx")))
+#else
+	#define hiir_TARGET_AVX
+#endif
+
 // Alignment
 #if defined (_MSC_VER)
 	#define	hiir_TYPEDEF_ALIGN( alignsize, srctype, dsttype)	\
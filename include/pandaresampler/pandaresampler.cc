@@ -2,14 +2,31 @@
 #include "pandaresampler.hh"
 #include "pandaresampler/hiir/Downsampler2xFpu.h"
 #include "pandaresampler/hiir/Upsampler2xFpu.h"
-#ifdef __SSE__
+#include "pandaresampler/simd.hh"
+#ifdef PANDA_RESAMPLER_SIMD
 #include "pandaresampler/hiir/Downsampler2xSse.h"
 #include "pandaresampler/hiir/Upsampler2xSse.h"
+#include "pandaresampler/hiir/Downsampler2x2Sse.h"
+#include "pandaresampler/hiir/Upsampler2x2Sse.h"
 #endif
-#ifdef __SSE__
-#include <xmmintrin.h>
+#ifdef PANDA_RESAMPLER_SSE2
+#include "pandaresampler/hiir/Downsampler2xF64Sse2.h"
+#include "pandaresampler/hiir/Upsampler2xF64Sse2.h"
+#endif
+#if defined (PANDA_RESAMPLER_SSE) && (defined (__x86_64__) || defined (__i386__)) && defined (__GNUC__)
+/* AVX2 code is always compiled (using the target attribute), but only used
+ * if instruction_set_available() detects AVX2 + FMA support at runtime
+ */
+#include <immintrin.h>
+#define PANDA_RESAMPLER_AVX2
+#define PANDA_RESAMPLER_TARGET_AVX2 __attribute__((target ("avx2,fma")))
+#include "pandaresampler/hiir/Downsampler2x8Avx.h"
+#include "pandaresampler/hiir/Upsampler2x8Avx.h"
 #endif
 #include <math.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
 #include <string.h>
 
 #ifdef PANDA_RESAMPLER_HEADER_ONLY
@@ -18,38 +35,14 @@
 #  define PANDA_RESAMPLER_FN
 #endif
 
-#define PANDA_RESAMPLER_FN_ALWAYS_INLINE inline __attribute__((always_inline))
-
-#if defined (__ARM_NEON) || defined(__arm64__) || defined(__aarch64__)
-#include <arm_neon.h>
-#define PANDA_RESAMPLER_NEON
-#endif
-
 namespace PandaResampler
 {
 
-#ifdef PANDA_RESAMPLER_NEON
-/* use NEON instructions for FIR resampler code written for SSE */
-typedef float32x4_t __m128;
-
-static PANDA_RESAMPLER_FN_ALWAYS_INLINE
-__m128 _mm_mul_ps(__m128 a, __m128 b)
-{
-  return vmulq_f32(a, b);
-}
-
-static PANDA_RESAMPLER_FN_ALWAYS_INLINE
-__m128 _mm_add_ps(__m128 a, __m128 b)
-{
-  return vaddq_f32(a, b);
-}
-#endif
-
 /* see: http://ds9a.nl/gcc-simd/ */
 union F4Vector
 {
   float f[4];
-#if defined (__SSE__) || defined (PANDA_RESAMPLER_NEON)
+#ifdef PANDA_RESAMPLER_SIMD
   __m128 v;   // vector of four single floats
 #endif
 };
@@ -59,608 +52,4977 @@ using std::max;
 using std::copy;
 using std::vector;
 
+/* ResamplerBank stages with the same filters as the Resampler2 stages, see below */
+template<uint ORDER> static ResamplerBankStage *create_bank_fir_upsampler2 (const vector<double>& coeffs, uint n_groups, bool avx);
+template<uint ORDER> static ResamplerBankStage *create_bank_fir_downsampler2 (const vector<double>& coeffs, uint n_groups, bool avx);
+template<uint NC> static ResamplerBankStage *create_bank_iir_upsampler2 (const double *coeffs, uint n_groups, bool avx);
+template<uint NC> static ResamplerBankStage *create_bank_iir_downsampler2 (const double *coeffs, uint n_groups, bool avx);
+
+/*
+ * Vectorized multi-channel FIR resampling: each SIMD lane processes one
+ * channel, so every tap is broadcast once and applied to all channels, and
+ * no horizontal sums are needed. This uses the filter stages of
+ * ResamplerBank, which also runs all stages in one pass.
+ */
+class Resampler2::MultiChannelFIR final : public Resampler2::Impl {
+  ResamplerBank bank_;
+  uint          order_;
+public:
+  MultiChannelFIR (Mode mode, uint ratio, Precision precision, uint channels, uint order) :
+    bank_ (mode, ratio, precision, channels, FILTER_FIR),
+    order_ (order)
+  {
+  }
+  void
+  process_block (const float *, uint, float *) override
+  {
+    PANDA_RESAMPLER_CHECK (false); // only planar multi-channel processing is supported
+  }
+  void
+  process_block_planar (const float * const *input, uint n_input_samples, float * const *output) override
+  {
+    bank_.process_block (input, n_input_samples, output);
+  }
+  void
+  process_block_interleaved (const float *input, uint n_input_frames, float *output) override
+  {
+    bank_.process_block_interleaved (input, n_input_frames, output);
+  }
+  uint
+  order() const override
+  {
+    return order_;
+  }
+  double
+  delay() const override
+  {
+    return bank_.delay();
+  }
+  void
+  reset() override
+  {
+    bank_.reset();
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+
 /* --- Resampler2 methods --- */
 PANDA_RESAMPLER_FN
 Resampler2::Resampler2 (Mode      mode,
                         uint      ratio,
                         Precision precision,
                         bool      use_sse_if_available,
-                        Filter    filter)
+                        Filter    filter,
+                        uint      channels)
 {
   mode_ = mode;
   ratio_ = ratio;
+  channels_ = channels;
   precision_ = precision;
   use_sse_if_available_ = use_sse_if_available;
   filter_ = filter;
+  iset_ = use_sse_if_available ? instruction_set_available() : ISET_FPU;
+
+  /* time-parallel IIR evaluation is only faster than sequential evaluation with AVX2 */
+  if (filter_ == FILTER_IIR_PARALLEL && iset_ != ISET_AVX2)
+    filter_ = FILTER_IIR;
+
+  /* fixed-point FIR filters need SSE2, and are only accurate enough for low precisions */
+  if (filter_ == FILTER_FIR_FIXED)
+    {
+#ifdef PANDA_RESAMPLER_SSE2
+      const bool fixed_ok = iset_ != ISET_FPU && (precision_ == PREC_48DB || precision_ == PREC_72DB);
+#else
+      const bool fixed_ok = false;
+#endif
+      if (!fixed_ok)
+        filter_ = FILTER_FIR;
+    }
+
+#ifdef PANDA_RESAMPLER_SSE
+  /* IIR filters have SSE implementations only (and AVX for 8 channels or time-parallel evaluation) */
+  const bool iir_avx = (filter_ == FILTER_IIR && channels_ == 8) || filter_ == FILTER_IIR_PARALLEL;
+  const bool iir = filter_ == FILTER_IIR || filter_ == FILTER_IIR_PARALLEL;
+  if (iir && iset_ != ISET_FPU && !(iset_ == ISET_AVX2 && iir_avx))
+    iset_ = ISET_SSE;
+#endif
 
   PANDA_RESAMPLER_CHECK (ratio == 1 || ratio == 2 || ratio == 4 || ratio == 8);
+  PANDA_RESAMPLER_CHECK (channels >= 1 && channels <= MAX_CHANNELS);
 
   init_stage (impl_x2, 2);
   init_stage (impl_x4, 4);
   init_stage (impl_x8, 8);
+
+#ifdef PANDA_RESAMPLER_SIMD
+  /* mono IIR resampling for ratio 4 and 8 runs all stages in one pass */
+  if (filter_ == FILTER_IIR && iset_ != ISET_FPU && channels_ == 1 && ratio_ >= 4)
+    impl_cascade.reset (create_impl_iir_cascade());
+#endif
+
+  /* multi-channel FIR resampling processes one channel per SIMD lane */
+  if (multi_channel_fir())
+    impl_cascade.reset (new MultiChannelFIR (mode_, ratio_, precision_, channels_, impl_x2->order()));
 }
 
 PANDA_RESAMPLER_FN
 void
-Resampler2::init_stage (std::unique_ptr<Impl>& impl,
-                        uint                   stage_ratio)
+Resampler2::enable_double()
 {
-  /* only allocate/initialize stage if necessary */
-  if (stage_ratio > ratio_ || impl)
+  if (channels_ != 1 || impl_double_x2 || ratio_ == 1)
     return;
 
-  if (sse_available() && use_sse_if_available_)
+  /* double precision stages use the same filters as the float stages */
+  impl_double_x2.reset (impl_x2->create_double_stage());
+  if (ratio_ >= 4)
+    impl_double_x4.reset (impl_x4->create_double_stage());
+  if (ratio_ >= 8)
+    impl_double_x8.reset (impl_x8->create_double_stage());
+}
+
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_block (const double *input,
+                           uint          n_input_samples,
+                           double       *output)
+{
+  if (!PANDA_RESAMPLER_CHECK (channels_ == 1))
+    return;
+
+  if (ratio_ == 1)
     {
-      switch (filter_)
-        {
-          case FILTER_FIR: impl.reset (create_impl<true> (stage_ratio));
-                           break;
-          case FILTER_IIR: impl.reset (create_impl_iir<true> (stage_ratio));
-                           break;
-        }
+      if (input != output)
+        std::copy (input, input + n_input_samples, output);
+      return;
     }
-  else
+  enable_double();
+  if (!PANDA_RESAMPLER_CHECK (impl_double_x2 && (ratio_ < 4 || impl_double_x4) && (ratio_ < 8 || impl_double_x8)))
+    return;
+
+  if (ratio_ == 2 && !buffers_overlap (input, n_input_samples, output, n_output_samples (n_input_samples)))
     {
-      switch (filter_)
-        {
-          case FILTER_FIR: impl.reset (create_impl<false> (stage_ratio));
-                           break;
-          case FILTER_IIR: impl.reset (create_impl_iir<false> (stage_ratio));
-                           break;
-        }
+      impl_double_x2->process_block (input, n_input_samples, output);
+      return;
     }
-  // should have created an implementation at this point
-  PANDA_RESAMPLER_CHECK (impl.get());
+  if (tile_size_)
+    {
+      /* the io part of the scratch memory holds the double buffers for half a tile */
+      const uint tile_size = tile_size_ / 2;
+      double *tmp = reinterpret_cast<double *> (scratch_io());
+      process_double_tiles (input, n_input_samples, output, tile_size, tmp, tmp + (mode_ == UP ? tile_size * 2 : tile_size / 2));
+    }
+  else
+    process_block_double_stack (input, n_input_samples, output);
 }
 
-PANDA_RESAMPLER_FN
-bool
-Resampler2::sse_available()
+PANDA_RESAMPLER_FN PANDA_RESAMPLER_FN_NOINLINE
+void
+Resampler2::process_block_double_stack (const double *input,
+                                        uint          n_input_samples,
+                                        double       *output)
 {
-#if defined (__SSE__) || defined (PANDA_RESAMPLER_NEON)
-  return true;
-#else
-  return false;
-#endif
-}
+  const uint block_size = 512;
 
-PANDA_RESAMPLER_FN
-Resampler2::Precision
-Resampler2::find_precision_for_bits (uint bits)
-{
-  if (bits <= 1)
-    return PREC_LINEAR;
-  if (bits <= 8)
-    return PREC_48DB;
-  if (bits <= 12)
-    return PREC_72DB;
-  if (bits <= 16)
-    return PREC_96DB;
-  if (bits <= 20)
-    return PREC_120DB;
+  double tmp[block_size * 4];
+  double tmp2[block_size * 4];
 
-  /* thats the best precision we can deliver (and by the way also close to
-   * the best precision possible with floats anyway)
-   */
-  return PREC_144DB;
+  process_double_tiles (input, n_input_samples, output, block_size, tmp, tmp2);
 }
 
+/* like process_tiles(), for ratio 2 tmp holds a copy of the input (in-place processing) */
 PANDA_RESAMPLER_FN
-const char *
-Resampler2::precision_name (Precision precision)
+void
+Resampler2::process_double_tiles (const double *input,
+                                  uint          n_input_samples,
+                                  double       *output,
+                                  uint          tile_size,
+                                  double       *tmp,
+                                  double       *tmp2)
 {
-  switch (precision)
-  {
-  case PREC_LINEAR:  return "linear interpolation";
-  case PREC_48DB:    return "8 bit (48dB)";
-  case PREC_72DB:    return "12 bit (72dB)";
-  case PREC_96DB:    return "16 bit (96dB)";
-  case PREC_120DB:   return "20 bit (120dB)";
-  case PREC_144DB:   return "24 bit (144dB)";
-  default:			    return "unknown precision enum value";
-  }
-}
+  while (n_input_samples)
+    {
+      const uint n_todo_samples = min (tile_size, n_input_samples);
 
-namespace Aux {
+      if (ratio_ == 2)
+        {
+          /* in-place processing: copy each block of input first, see process_block_in_place() */
+          std::copy (input, input + n_todo_samples, tmp);
+          impl_double_x2->process_block (tmp, n_todo_samples, output);
+          output += n_output_samples (n_todo_samples);
+        }
+      else if (mode_ == UP)
+        {
+          if (ratio_ == 4)
+            {
+              impl_double_x2->process_block (input, n_todo_samples, tmp);
+              impl_double_x4->process_block (tmp, n_todo_samples * 2, output);
+            }
+          else /* ratio_ == 8 */
+            {
+              impl_double_x2->process_block (input, n_todo_samples, tmp);
+              impl_double_x4->process_block (tmp, n_todo_samples * 2, tmp2);
+              impl_double_x8->process_block (tmp2, n_todo_samples * 4, output);
+            }
+          output += n_todo_samples * ratio_;
+        }
+      else /* (mode_ == DOWN) */
+        {
+          if (ratio_ == 4)
+            {
+              impl_double_x4->process_block (input, n_todo_samples, tmp);
+              impl_double_x2->process_block (tmp, n_todo_samples / 2, output);
+            }
+          else /* ratio_ == 8 */
+            {
+              impl_double_x8->process_block (input, n_todo_samples, tmp);
+              impl_double_x4->process_block (tmp, n_todo_samples / 2, tmp2);
+              impl_double_x2->process_block (tmp2, n_todo_samples / 4, output);
+            }
+          output += n_todo_samples / ratio_;
+        }
+      input += n_todo_samples;
+      n_input_samples -= n_todo_samples;
+    }
+}
 
-/*
- * FIR filter routine
- *
- * A FIR filter has the characteristic that it has a finite impulse response,
- * and can be computed by convolution of the input signal with that finite
- * impulse response.
- *
- * Thus, we use this for computing the output of the FIR filter
- *
- * output = input[0] * taps[0] + input[1] * taps[1] + ... + input[N-1] * taps[N-1]
- *
- * where input is the input signal, taps are the filter coefficients, in
- * other texts sometimes called h[0]..h[N-1] (impulse response) or a[0]..a[N-1]
- * (non recursive part of a digital filter), and N is the filter order.
- */
-template<class Accumulator> static PANDA_RESAMPLER_FN_ALWAYS_INLINE
-Accumulator
-fir_process_one_sample (const float *input,
-                        const float *taps, /* [0..order-1] */
-			const uint   order)
+/* output[i] += input[i] * gain */
+static void
+add_scaled (const float *input, uint n, float *output, float gain)
 {
-  Accumulator out = 0;
-  for (uint i = 0; i < order; i++)
-    out += input[i] * taps[i];
-  return out;
+  uint i = 0;
+#ifdef PANDA_RESAMPLER_SIMD
+  const __m128 gain_v = _mm_set1_ps (gain);
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps (&output[i], _mm_add_ps (_mm_loadu_ps (&output[i]), _mm_mul_ps (_mm_loadu_ps (&input[i]), gain_v)));
+#endif
+  for (; i < n; i++)
+    output[i] += input[i] * gain;
 }
 
-/*
- * FIR filter routine for 4 samples simultaneously
- *
- * This routine produces (approximately) the same result as fir_process_one_sample
- * but computes four consecutive output values at once using vectorized SSE
- * instructions. Note that input and sse_taps need to be 16-byte aligned here.
- *
- * Also note that sse_taps is not a plain impulse response here, but a special
- * version that needs to be computed with fir_compute_sse_taps.
- */
-static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+PANDA_RESAMPLER_FN
 void
-fir_process_4samples_sse (const float *input,
-                          const float *sse_taps,
-			  const uint   order,
-			  float       *out0,
-			  float       *out1,
-			  float       *out2,
-			  float       *out3)
-{
-#if defined (__SSE__) || defined (PANDA_RESAMPLER_NEON)
-  /* input and taps must be 16-byte aligned */
-  const F4Vector *input_v = reinterpret_cast<const F4Vector *> (input);
-  const F4Vector *sse_taps_v = reinterpret_cast<const F4Vector *> (sse_taps);
-  F4Vector out0_v, out1_v, out2_v, out3_v;
-
-  out0_v.v = _mm_mul_ps (input_v[0].v, sse_taps_v[0].v);
-  out1_v.v = _mm_mul_ps (input_v[0].v, sse_taps_v[1].v);
-  out2_v.v = _mm_mul_ps (input_v[0].v, sse_taps_v[2].v);
-  out3_v.v = _mm_mul_ps (input_v[0].v, sse_taps_v[3].v);
+Resampler2::process_block_add (const float *input,
+                               uint         n_input_samples,
+                               float       *output,
+                               float        gain)
+{
+  if (!PANDA_RESAMPLER_CHECK (channels_ == 1))
+    return;
 
-  for (uint i = 1; i < (order + 6) / 4; i++)
+  /* the stages in processing order, the last one accumulates the output */
+  Impl *stages[3];
+  uint  n_stages = 0;
+  if (impl_cascade)
+    {
+      stages[n_stages++] = impl_cascade.get();
+    }
+  else if (mode_ == UP)
     {
-      out0_v.v = _mm_add_ps (out0_v.v, _mm_mul_ps (input_v[i].v, sse_taps_v[i * 4 + 0].v));
-      out1_v.v = _mm_add_ps (out1_v.v, _mm_mul_ps (input_v[i].v, sse_taps_v[i * 4 + 1].v));
-      out2_v.v = _mm_add_ps (out2_v.v, _mm_mul_ps (input_v[i].v, sse_taps_v[i * 4 + 2].v));
-      out3_v.v = _mm_add_ps (out3_v.v, _mm_mul_ps (input_v[i].v, sse_taps_v[i * 4 + 3].v));
+      for (Impl *impl : { impl_x2.get(), impl_x4.get(), impl_x8.get() })
+        if (impl)
+          stages[n_stages++] = impl;
     }
+  else
+    {
+      for (Impl *impl : { impl_x8.get(), impl_x4.get(), impl_x2.get() })
+        if (impl)
+          stages[n_stages++] = impl;
+    }
+  if (ratio_ == 1)
+    n_stages = 0;
 
-  *out0 = out0_v.f[0] + out0_v.f[1] + out0_v.f[2] + out0_v.f[3];
-  *out1 = out1_v.f[0] + out1_v.f[1] + out1_v.f[2] + out1_v.f[3];
-  *out2 = out2_v.f[0] + out2_v.f[1] + out2_v.f[2] + out2_v.f[3];
-  *out3 = out3_v.f[0] + out3_v.f[1] + out3_v.f[2] + out3_v.f[3];
-#else
-  PANDA_RESAMPLER_CHECK(false); // should not be reached
-#endif
+  if (tile_size_)
+    {
+      /* scratch memory layout: tmp, tmp2 (as for process_tiles), stage scratch, final output (io) */
+      process_add_tiles (stages, n_stages, input, n_input_samples, output, gain,
+                         tile_size_, scratch_, scratch_tmp2(), scratch_io());
+    }
+  else
+    process_block_add_stack (stages, n_stages, input, n_input_samples, output, gain);
 }
 
-
-/*
- * fir_compute_sse_taps takes a normal vector of FIR taps as argument and
- * computes a specially scrambled version of these taps, ready to be used
- * for SSE operations (by fir_process_4samples_sse).
- *
- * we require a special ordering of the FIR taps, to get maximum benefit of the SSE operations
- *
- * example: suppose the FIR taps are [ x1 x2 x3 x4 x5 x6 x7 x8 x9 ], then the SSE taps become
- *
- * [ x1 x2 x3 x4   0 x1 x2 x3   0  0 x1 x2   0  0  0 x1      <- for input[0]
- *   x5 x6 x7 x8  x4 x5 x6 x7  x3 x4 x5 x6  x2 x3 x4 x5      <- for input[1]
- *   x9  0  0  0  x8 x9  0  0  x7 x8 x9  0  x6 x7 x8 x9 ]    <- for input[2]
- * \------------/\-----------/\-----------/\-----------/
- *    for out0     for out1      for out2     for out3
- *
- * so that we can compute out0, out1, out2 and out3 simultaneously
- * from input[0]..input[2]
- */
-static inline vector<float>
-fir_compute_sse_taps (const vector<float>& taps)
+PANDA_RESAMPLER_FN PANDA_RESAMPLER_FN_NOINLINE
+void
+Resampler2::process_block_add_stack (Impl * const *stages,
+                                     uint          n_stages,
+                                     const float  *input,
+                                     uint          n_input_samples,
+                                     float        *output,
+                                     float         gain)
 {
-  const int order = taps.size();
-  vector<float> sse_taps ((order + 6) / 4 * 16);
+  const uint block_size = 512;
 
-  for (int j = 0; j < 4; j++)
-    for (int i = 0; i < order; i++)
-      {
-	int k = i + j;
-	sse_taps[(k / 4) * 16 + (k % 4) + j * 4] = taps[i];
-      }
+  float tmp[block_size * 2];  /* output of the first stage (ratio 8 upsampling: 2 * block_size) */
+  float tmp2[block_size * 4]; /* output of the second stage */
+  float out[block_size * 8];  /* output of the final stage (if it can't add) */
 
-  return sse_taps;
+  process_add_tiles (stages, n_stages, input, n_input_samples, output, gain, block_size, tmp, tmp2, out);
 }
 
-/*
- * This function tests the SSEified FIR filter code (that is, the reordering
- * done by fir_compute_sse_taps and the actual computation implemented in
- * fir_process_4samples_sse).
- *
- * It prints diagnostic information, and returns true if the filter
- * implementation works correctly, and false otherwise. The maximum filter
- * order to be tested can be optionally specified as argument.
- */
-static inline bool
-fir_test_filter_sse (bool       verbose,
-                     const uint max_order = 64)
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_add_tiles (Impl * const *stages,
+                               uint          n_stages,
+                               const float  *input,
+                               uint          n_input_samples,
+                               float        *output,
+                               float         gain,
+                               uint          tile_size,
+                               float        *tmp,
+                               float        *tmp2,
+                               float        *out)
 {
-  int errors = 0;
-  if (verbose)
-    printf ("testing SSE filter implementation:\n\n");
-
-  for (uint order = 0; order < max_order; order++)
+  while (n_input_samples)
     {
-      vector<float> taps (order);
-      for (uint i = 0; i < order; i++)
-	taps[i] = i + 1;
-
-      AlignedArray<float> sse_taps (fir_compute_sse_taps (taps));
-      if (verbose)
-	{
-	  for (uint i = 0; i < sse_taps.size(); i++)
-	    {
-	      printf ("%3d", (int) (sse_taps[i] + 0.5));
-	      if (i % 4 == 3)
-		printf ("  |");
-	      if (i % 16 == 15)
-		printf ("   ||| upper bound = %d\n", (order + 6) / 4);
-	    }
-	  printf ("\n\n");
-	}
+      const uint n_todo_samples = min (tile_size, n_input_samples);
+      const uint n_out_samples = n_output_samples (n_todo_samples);
 
-      AlignedArray<float> random_mem (order + 6);
-      for (uint i = 0; i < order + 6; i++)
-	random_mem[i] = 1.0 - rand() / (0.5 * RAND_MAX);
-
-      /* FIXME: the problem with this test is that we explicitely test SSE code
-       * here, but the test case is not compiled with -msse within the BEAST tree
-       */
-      float out[4];
-      fir_process_4samples_sse (&random_mem[0], &sse_taps[0], order,
-	                        &out[0], &out[1], &out[2], &out[3]);
-
-      double avg_diff = 0.0;
-      for (int i = 0; i < 4; i++)
-	{
-	  double diff = fir_process_one_sample<double> (&random_mem[i], taps.data(), order) - out[i];
-	  avg_diff += fabs (diff);
-	}
-      avg_diff /= (order + 1);
-      bool is_error = (avg_diff > 0.00001);
-      if (is_error || verbose)
-	printf ("*** order = %d, avg_diff = %g\n", order, avg_diff);
-      if (is_error)
-	errors++;
+      /* intermediate stages */
+      const float *in = input;
+      uint n_in = n_todo_samples;
+      for (uint s = 0; s + 1 < n_stages; s++)
+        {
+          float *stage_out = s == 0 ? tmp : tmp2;
+          stages[s]->process_block (in, n_in, stage_out);
+          n_in = mode_ == UP ? n_in * 2 : n_in / 2;
+          in = stage_out;
+        }
+      /* final stage */
+      if (n_stages == 0)
+        {
+          add_scaled (in, n_out_samples, output, gain);
+        }
+      else if (!stages[n_stages - 1]->process_block_add (in, n_in, output, gain))
+        {
+          stages[n_stages - 1]->process_block (in, n_in, out);
+          add_scaled (out, n_out_samples, output, gain);
+        }
+      output += n_out_samples;
+      input += n_todo_samples;
+      n_input_samples -= n_todo_samples;
     }
-  if (errors)
-    printf ("*** %d errors detected\n", errors);
-
-  return (errors == 0);
 }
 
-} // Aux
-
-using namespace Aux; // avoid anon namespace
-
 /*
- * Factor 2 upsampling of a data stream
- *
- * Template arguments:
- *   ORDER     number of resampling filter coefficients
- *   USE_SSE   whether to use SSE (vectorized) instructions or not
+ * Multi-channel resampling using one (single channel) implementation per
+ * channel; this is used if there is no vectorized multi-channel implementation
  */
-template<uint ORDER, bool USE_SSE>
-class Resampler2::Upsampler2 final : public Resampler2::Impl {
-  vector<float>       taps;
-  AlignedArray<float> history;
-  AlignedArray<float> sse_taps;
-protected:
-  /* fast SSE optimized convolution */
-  PANDA_RESAMPLER_FN_ALWAYS_INLINE
-  void
-  process_4samples_aligned (const float *input /* aligned */,
-                            float       *output)
-  {
-    const uint H = (ORDER / 2); /* half the filter length */
-
-    output[1] = input[H];
-    output[3] = input[H + 1];
-    output[5] = input[H + 2];
-    output[7] = input[H + 3];
-
-    fir_process_4samples_sse (input, &sse_taps[0], ORDER, &output[0], &output[2], &output[4], &output[6]);
-  }
-  /* slow convolution */
-  PANDA_RESAMPLER_FN_ALWAYS_INLINE
-  void
-  process_sample_unaligned (const float *input,
-                            float       *output)
+class Resampler2::MultiChannel final : public Resampler2::Impl {
+  vector<std::unique_ptr<Impl>> channel_impls;
+  Mode                          mode;
+public:
+  MultiChannel (const vector<Impl *>& impls, Mode impl_mode) :
+    mode (impl_mode)
   {
-    const uint H = (ORDER / 2); /* half the filter length */
-    output[0] = fir_process_one_sample<float> (&input[0], &taps[0], ORDER);
-    output[1] = input[H];
+    for (auto impl : impls)
+      channel_impls.emplace_back (impl);
   }
-  PANDA_RESAMPLER_FN_ALWAYS_INLINE
   void
-  process_block_aligned (const float *input,
-                         uint         n_input_samples,
-			 float       *output)
+  process_block (const float *, uint, float *) override
   {
-    uint i = 0;
-    if (USE_SSE)
-      {
-        /* (i + 6) -> need to take into account that the filter needs to access
-         * some samples after the end of the input data
-         */
-	while (i + 6 < n_input_samples)
-	  {
-	    process_4samples_aligned (&input[i], &output[i*2]);
-	    i += 4;
-	  }
-      }
-    while (i < n_input_samples)
-      {
-	process_sample_unaligned (&input[i], &output[2*i]);
-	i++;
-      }
+    PANDA_RESAMPLER_CHECK (false); // only planar multi-channel processing is supported
   }
-  PANDA_RESAMPLER_FN_ALWAYS_INLINE
   void
-  process_block_unaligned (const float *input,
-                           uint         n_input_samples,
-			   float       *output)
+  process_block_planar (const float * const *input, uint n_input_samples, float * const *output) override
   {
-    uint i = 0;
-    if (USE_SSE)
-      {
-	while ((reinterpret_cast<ptrdiff_t> (&input[i]) & 15) && i < n_input_samples)
-	  {
-	    process_sample_unaligned (&input[i], &output[2 * i]);
-	    i++;
-	  }
-      }
-    process_block_aligned (&input[i], n_input_samples - i, &output[2 * i]);
-  }
-public:
-  /*
-   * Constructs an Upsampler2 object with a given set of filter coefficients.
-   *
-   * init_taps: coefficients for the upsampling FIR halfband filter
-   */
-  Upsampler2 (float *init_taps) :
-    taps (init_taps, init_taps + ORDER),
-    history (2 * ORDER),
-    sse_taps (fir_compute_sse_taps (taps))
-  {
-    PANDA_RESAMPLER_CHECK ((ORDER & 1) == 0);    /* even order filter */
+    for (size_t c = 0; c < channel_impls.size(); c++)
+      channel_impls[c]->process_block (input[c], n_input_samples, output[c]);
   }
-  /*
-   * The function process_block() takes a block of input samples and produces a
-   * block with twice the length, containing interpolated output samples.
-   */
   void
-  process_block (const float *input,
-                 uint         n_input_samples,
-		 float       *output) override
+  process_block_interleaved (const float *input, uint n_input_frames, float *output) override
   {
-    const uint history_todo = min (n_input_samples, ORDER - 1);
+    /* the filters need contiguous samples, so small blocks (which stay in cache) are deinterleaved */
+    const uint channels = channel_impls.size();
+    const uint block_size = 128;
 
-    copy (input, input + history_todo, &history[ORDER - 1]);
-    process_block_aligned (&history[0], history_todo, output);
-    if (n_input_samples > history_todo)
-      {
-	process_block_unaligned (input, n_input_samples - history_todo, &output [2 * history_todo]);
+    float in[block_size];
+    float out[block_size * 2];
 
-	// build new history from new input
-	copy (input + n_input_samples - history_todo, input + n_input_samples, &history[0]);
-      }
-    else
+    uint pos = 0;
+    while (pos < n_input_frames)
       {
-	// build new history from end of old history
-	// (very expensive if n_input_samples tends to be a lot smaller than ORDER often)
-	memmove (&history[0], &history[n_input_samples], sizeof (history[0]) * (ORDER - 1));
+        const uint n_todo = min (block_size, n_input_frames - pos);
+        const uint n_out = mode == UP ? n_todo * 2 : n_todo / 2;
+        const uint out_pos = mode == UP ? pos * 2 : pos / 2;
+        for (uint c = 0; c < channels; c++)
+          {
+            for (uint i = 0; i < n_todo; i++)
+              in[i] = input[(pos + i) * channels + c];
+            channel_impls[c]->process_block (in, n_todo, out);
+            for (uint i = 0; i < n_out; i++)
+              output[(out_pos + i) * channels + c] = out[i];
+          }
+        pos += n_todo;
       }
   }
-  /*
-   * Returns the FIR filter order.
-   */
   uint
   order() const override
   {
-    return ORDER;
+    return channel_impls[0]->order();
   }
   double
   delay() const override
   {
-    return order() - 1;
+    return channel_impls[0]->delay();
   }
   void
   reset() override
   {
-    std::fill (history.begin(), history.end(), 0.0);
+    for (auto& impl : channel_impls)
+      impl->reset();
   }
   bool
   sse_enabled() const override
   {
-    return USE_SSE;
+    return channel_impls[0]->sse_enabled();
   }
 };
 
-/*
- * Factor 2 downsampling of a data stream
- *
- * Template arguments:
- *   ORDER    number of resampling filter coefficients
- *   USE_SSE  whether to use SSE (vectorized) instructions or not
- */
-template<uint ORDER, bool USE_SSE>
-class Resampler2::Downsampler2 final : public Resampler2::Impl {
-  vector<float>        taps;
-  AlignedArray<float> history_even;
-  AlignedArray<float> history_odd;
-  AlignedArray<float> sse_taps;
-  /* fast SSE optimized convolution */
-  template<int ODD_STEPPING> PANDA_RESAMPLER_FN_ALWAYS_INLINE
-  void
-  process_4samples_aligned (const float *input_even /* aligned */,
-                            const float *input_odd,
-			    float       *output)
-  {
-    const uint H = (ORDER / 2) - 1; /* half the filter length */
+/* returns true if the multi-channel IIR resampler uses the stereo SSE filters */
+PANDA_RESAMPLER_FN
+bool
+Resampler2::multi_channel_iir_sse() const
+{
+  return filter_ == FILTER_IIR && iset_ != ISET_FPU && channels_ == 2;
+}
 
-    fir_process_4samples_sse (input_even, &sse_taps[0], ORDER, &output[0], &output[1], &output[2], &output[3]);
+/* returns true if the multi-channel FIR resampler uses MultiChannelFIR */
+PANDA_RESAMPLER_FN
+bool
+Resampler2::multi_channel_fir() const
+{
+  /* the mono FIR kernels are vectorized over time, processing one channel per
+   * lane is only faster if all lanes are used
+   */
+  return filter_ == FILTER_FIR && iset_ != ISET_FPU && channels_ == ResamplerBank::LANES && ratio_ >= 2;
+}
 
-    output[0] += 0.5f * input_odd[H * ODD_STEPPING];
-    output[1] += 0.5f * input_odd[(H + 1) * ODD_STEPPING];
-    output[2] += 0.5f * input_odd[(H + 2) * ODD_STEPPING];
-    output[3] += 0.5f * input_odd[(H + 3) * ODD_STEPPING];
-  }
-  /* slow convolution */
-  template<int ODD_STEPPING> PANDA_RESAMPLER_FN_ALWAYS_INLINE
-  float
-  process_sample_unaligned (const float *input_even,
-                            const float *input_odd)
-  {
-    const uint H = (ORDER / 2) - 1; /* half the filter length */
+PANDA_RESAMPLER_FN
+void
+Resampler2::init_stage (std::unique_ptr<Impl>& impl,
+                        uint                   stage_ratio)
+{
+  /* only allocate/initialize stage if necessary */
+  if (stage_ratio > ratio_ || impl)
+    return;
 
-    return fir_process_one_sample<float> (&input_even[0], &taps[0], ORDER) + 0.5f * input_odd[H * ODD_STEPPING];
-  }
-  template<int ODD_STEPPING> PANDA_RESAMPLER_FN_ALWAYS_INLINE
-  void
-  process_block_aligned (const float *input_even,
-                         const float *input_odd,
-			 float       *output,
-			 uint         n_output_samples)
-  {
-    uint i = 0;
-    if (USE_SSE)
-      {
-        /* (i + 6) -> need to take into account that the filter needs to access
-         * some samples after the end of the input data
-         */
-	while (i + 6 < n_output_samples)
-	  {
-	    process_4samples_aligned<ODD_STEPPING> (&input_even[i], &input_odd[i * ODD_STEPPING], &output[i]);
-	    i += 4;
-	  }
-      }
-    while (i < n_output_samples)
-      {
-	output[i] = process_sample_unaligned<ODD_STEPPING> (&input_even[i], &input_odd[i * ODD_STEPPING]);
-	i++;
-      }
-  }
-  template<int ODD_STEPPING> PANDA_RESAMPLER_FN_ALWAYS_INLINE
-  void
-  process_block_unaligned (const float *input_even,
-                           const float *input_odd,
-			   float       *output,
-			   uint         n_output_samples)
-  {
-    uint i = 0;
-    if (USE_SSE)
-      {
-	while ((reinterpret_cast<ptrdiff_t> (&input_even[i]) & 15) && i < n_output_samples)
-	  {
-	    output[i] = process_sample_unaligned<ODD_STEPPING> (&input_even[i], &input_odd[i * ODD_STEPPING]);
-	    i++;
-	  }
-      }
-    process_block_aligned<ODD_STEPPING> (&input_even[i], &input_odd[i * ODD_STEPPING], &output[i], n_output_samples);
-  }
-  void
-  deinterleave2 (const float *data,
-                 uint         n_data_values,
-		 float       *output)
-  {
-    for (uint i = 0; i < n_data_values; i += 2)
-      output[i / 2] = data[i];
-  }
-public:
-  /*
-   * Constructs a Downsampler2 class using a given set of filter coefficients.
-   *
-   * init_taps: coefficients for the downsampling FIR halfband filter
-   */
-  Downsampler2 (float *init_taps) :
-    taps (init_taps, init_taps + ORDER),
-    history_even (2 * ORDER),
-    history_odd (2 * ORDER),
-    sse_taps (fir_compute_sse_taps (taps))
-  {
-    PANDA_RESAMPLER_CHECK ((ORDER & 1) == 0);    /* even order filter */
-  }
-  /*
-   * The function process_block() takes a block of input samples and produces
-   * a block with half the length, containing downsampled output samples.
+  /* vectorized multi-channel implementations only need one (mono) stage for
+   * order() and delay(), the processing is done by one impl for all channels
    */
-  void
-  process_block (const float *input,
-                 uint         n_input_samples,
-		 float       *output) override
-  {
-    if (!PANDA_RESAMPLER_CHECK ((n_input_samples & 1) == 0))
-      return;
+  const bool vectorized = (filter_ == FILTER_IIR && iset_ == ISET_AVX2) || multi_channel_iir_sse() || multi_channel_fir();
+  if (channels_ > 1 && !vectorized)
+    {
+      /* two channels (stereo or complex I/Q samples): filter both channels in one pass, if supported */
+      if (channels_ == 2)
+        {
+          std::unique_ptr<Impl> mono_impl (create_stage (stage_ratio));
+          impl.reset (mono_impl->create_two_channel_stage());
 
-    const uint BLOCKSIZE = 1024;
+          /* the x2 stage is always created first */
+          two_channel_stages_ = impl && (stage_ratio == 2 || two_channel_stages_);
+        }
+      if (!impl)
+        {
+          /* no vectorized multi-channel implementation: use one filter per channel */
+          vector<Impl *> channel_impls;
+          for (uint c = 0; c < channels_; c++)
+            channel_impls.push_back (create_stage (stage_ratio));
 
-    F4Vector  block[BLOCKSIZE / 4]; /* using F4Vector ensures 16-byte alignment */
-    float    *input_even = &block[0].f[0];
+          impl.reset (new MultiChannel (channel_impls, mode_));
+        }
+    }
+  else
+    {
+      impl.reset (create_stage (stage_ratio));
+    }
+  // should have created an implementation at this point
+  PANDA_RESAMPLER_CHECK (impl.get());
+}
 
-    while (n_input_samples)
-      {
-	uint n_input_todo = min (n_input_samples, BLOCKSIZE * 2);
+PANDA_RESAMPLER_FN
+Resampler2::Impl *
+Resampler2::create_stage (uint stage_ratio)
+{
+#ifdef PANDA_RESAMPLER_SSE2
+  /* the fixed-point stages use the coefficients of the float stages, see create_impl_with_coeffs() */
+  if (filter_ == FILTER_FIR_FIXED)
+    return create_impl<ISET_SSE> (stage_ratio);
+#endif
+  if (filter_ != FILTER_FIR)
+    return create_impl_iir (stage_ratio);
 
-        /* since the halfband filter contains zeros every other sample
-	 * and since we're using SSE instructions, which expect the
-	 * data to be consecutively represented in memory, we prepare
-	 * a block of samples containing only even-indexed samples
-	 *
-	 * we keep the deinterleaved data on the stack (instead of per-class
-	 * allocated memory), to ensure that even running a lot of these
-	 * downsampler streams will not result in cache trashing
-	 *
-         * FIXME: this implementation is suboptimal for non-SSE, because it
-	 * performs an extra deinterleaving step in any case, but deinterleaving
-	 * is only required for SSE instructions
-	 */
-	deinterleave2 (input, n_input_todo, input_even);
+  switch (iset_)
+    {
+      case ISET_FPU:  return create_impl<ISET_FPU> (stage_ratio);
+#ifdef PANDA_RESAMPLER_SSE
+      case ISET_SSE:  return create_impl<ISET_SSE> (stage_ratio);
+#endif
+#ifdef PANDA_RESAMPLER_VECTOR
+      /* NEON uses the same (portable) vector extension code */
+      case ISET_NEON:
+      case ISET_VECTOR: return create_impl<ISET_VECTOR> (stage_ratio);
+#endif
+#ifdef PANDA_RESAMPLER_AVX2
+      case ISET_AVX2: return create_impl<ISET_AVX2> (stage_ratio);
+#endif
+      default:        return nullptr;
+    }
+}
 
-	const float       *input_odd = input + 1; /* we process this one with a stepping of 2 */
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_block (const float * const *input,
+                           uint                 n_input_samples,
+                           float * const       *output)
+{
+  if (channels_ == 1)
+    {
+      process_block (input[0], n_input_samples, output[0]);
+      return;
+    }
+  if (two_channel_stages_ && ratio_ >= 2 && !impl_cascade)
+    {
+      /* in-place processing is safe: the input is copied before processing */
+      process_block_two_channel_planar (input, n_input_samples, output);
+      return;
+    }
+  if (impl_cascade || ratio_ == 2)
+    {
+      for (uint c = 0; c < channels_; c++)
+        if (buffers_overlap (input[c], n_input_samples, output[c], n_output_samples (n_input_samples)))
+          {
+            process_block_planar_in_place (input, n_input_samples, output);
+            return;
+          }
+      if (impl_cascade)
+        impl_cascade->process_block_planar (input, n_input_samples, output);
+      else
+        impl_x2->process_block_planar (input, n_input_samples, output);
+      return;
+    }
+  if (ratio_ == 1)
+    {
+      for (uint c = 0; c < channels_; c++)
+        if (input[c] != output[c])
+          std::copy (input[c], input[c] + n_input_samples, output[c]);
+      return;
+    }
 
-	const uint n_output_todo = n_input_todo / 2;
-	const uint history_todo = min (n_output_todo, ORDER - 1);
+  if (tile_size_)
+    process_planar_tiles (input, n_input_samples, output, tile_size_, scratch_, scratch_tmp2());
+  else
+    process_block_planar_stack (input, n_input_samples, output);
+}
 
-	copy (input_even, input_even + history_todo, &history_even[ORDER - 1]);
-	deinterleave2 (input_odd, history_todo * 2, &history_odd[ORDER - 1]);
+/* not inlined: the stack memory is only used without scratch memory */
+PANDA_RESAMPLER_FN PANDA_RESAMPLER_FN_NOINLINE
+void
+Resampler2::process_block_planar_stack (const float * const *input,
+                                        uint                 n_input_samples,
+                                        float * const       *output)
+{
+  /* like the mono version, but with a smaller block size, since we need
+   * temporary buffers for all channels
+   */
+  const uint block_size = 128;
 
-	process_block_aligned <1> (&history_even[0], &history_odd[0], output, history_todo);
-	if (n_output_todo > history_todo)
-	  {
-	    process_block_unaligned<2> (input_even, input_odd, &output[history_todo], n_output_todo - history_todo);
+  float tmp[MAX_CHANNELS * block_size * 4];
+  float tmp2[MAX_CHANNELS * block_size * 4];
 
-	    // build new history from new input (here: history_todo == ORDER - 1)
-	    copy (input_even + n_output_todo - history_todo, input_even + n_output_todo, &history_even[0]);
-	    deinterleave2 (input_odd + n_input_todo - history_todo * 2, history_todo * 2, &history_odd[0]); /* FIXME: can be optimized */
-	  }
-	else
-	  {
-	    // build new history from end of old history
-	    // (very expensive if n_output_todo tends to be a lot smaller than ORDER often)
-	    memmove (&history_even[0], &history_even[n_output_todo], sizeof (history_even[0]) * (ORDER - 1));
-	    memmove (&history_odd[0], &history_odd[n_output_todo], sizeof (history_odd[0]) * (ORDER - 1));
-	  }
+  process_planar_tiles (input, n_input_samples, output, block_size, tmp, tmp2);
+}
 
-	n_input_samples -= n_input_todo;
-	input += n_input_todo;
-	output += n_output_todo;
-      }
-  }
-  /*
-   * Returns the filter order.
-   */
+/* like process_tiles(), for planar data: tmp and tmp2 are split into one part per channel */
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_planar_tiles (const float * const *input,
+                                  uint                 n_input_samples,
+                                  float * const       *output,
+                                  uint                 tile_size,
+                                  float               *tmp,
+                                  float               *tmp2)
+{
+  const uint tmp_size = mode_ == UP ? tile_size * 2 : tile_size / 2;
+  const uint tmp2_size = mode_ == UP ? tile_size * 4 : tile_size / 4;
+
+  const float *in[MAX_CHANNELS];
+  float       *out[MAX_CHANNELS];
+  float       *tmp_p[MAX_CHANNELS];
+  float       *tmp2_p[MAX_CHANNELS];
+  for (uint c = 0; c < channels_; c++)
+    {
+      in[c] = input[c];
+      out[c] = output[c];
+      tmp_p[c] = tmp + c * tmp_size;
+      tmp2_p[c] = tmp2 + c * tmp2_size;
+    }
+
+  while (n_input_samples)
+    {
+      const uint n_todo_samples = min (tile_size, n_input_samples);
+
+      if (mode_ == UP)
+        {
+          if (ratio_ == 4)
+            {
+              impl_x2->process_block_planar (in, n_todo_samples, tmp_p);
+              impl_x4->process_block_planar (tmp_p, n_todo_samples * 2, out);
+            }
+          else /* ratio_ == 8 */
+            {
+              impl_x2->process_block_planar (in, n_todo_samples, tmp_p);
+              impl_x4->process_block_planar (tmp_p, n_todo_samples * 2, tmp2_p);
+              impl_x8->process_block_planar (tmp2_p, n_todo_samples * 4, out);
+            }
+          for (uint c = 0; c < channels_; c++)
+            out[c] += n_todo_samples * ratio_;
+        }
+      else /* (mode_ == DOWN) */
+        {
+          if (ratio_ == 4)
+            {
+              impl_x4->process_block_planar (in, n_todo_samples, tmp_p);
+              impl_x2->process_block_planar (tmp_p, n_todo_samples / 2, out);
+            }
+          else /* ratio_ == 8 */
+            {
+              impl_x8->process_block_planar (in, n_todo_samples, tmp_p);
+              impl_x4->process_block_planar (tmp_p, n_todo_samples / 2, tmp2_p);
+              impl_x2->process_block_planar (tmp2_p, n_todo_samples / 4, out);
+            }
+          for (uint c = 0; c < channels_; c++)
+            out[c] += n_todo_samples / ratio_;
+        }
+      for (uint c = 0; c < channels_; c++)
+        in[c] += n_todo_samples;
+      n_input_samples -= n_todo_samples;
+    }
+}
+
+/*
+ * The single pass stages (ratio 2 or cascade) read the input while writing the
+ * output, so they don't support overlapping buffers. Here, each block of input
+ * is copied before it is processed. This is sufficient for the in-place cases
+ * (see process_block()): for DOWN mode, the output of a block ends before the
+ * input of the next block starts, and for UP mode with the input at the end of
+ * the output buffer, the output of a block ends before the input of the next
+ * block, too (the output catches up with the input only after the last block).
+ */
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_block_in_place (const float *input,
+                                    uint         n_input_frames,
+                                    float       *output)
+{
+  if (tile_size_)
+    process_in_place_tiles (input, n_input_frames, output, tile_size_, scratch_io());
+  else
+    process_block_in_place_stack (input, n_input_frames, output);
+}
+
+PANDA_RESAMPLER_FN PANDA_RESAMPLER_FN_NOINLINE
+void
+Resampler2::process_block_in_place_stack (const float *input,
+                                          uint         n_input_frames,
+                                          float       *output)
+{
+  const uint block_size = 256; /* multiple of 8 (for downsampling) */
+
+  float in[MAX_CHANNELS * block_size];
+
+  process_in_place_tiles (input, n_input_frames, output, block_size, in);
+}
+
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_in_place_tiles (const float *input,
+                                    uint         n_input_frames,
+                                    float       *output,
+                                    uint         tile_size,
+                                    float       *in)
+{
+  Impl *impl = impl_cascade ? impl_cascade.get() : impl_x2.get();
+
+  while (n_input_frames)
+    {
+      const uint n_todo_frames = min (tile_size, n_input_frames);
+
+      std::copy (input, input + n_todo_frames * channels_, in);
+      if (channels_ == 1)
+        impl->process_block (in, n_todo_frames, output);
+      else
+        impl->process_block_interleaved (in, n_todo_frames, output);
+
+      output += n_output_samples (n_todo_frames) * channels_;
+      input += n_todo_frames * channels_;
+      n_input_frames -= n_todo_frames;
+    }
+}
+
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_block_planar_in_place (const float * const *input,
+                                           uint                 n_input_samples,
+                                           float * const       *output)
+{
+  if (tile_size_)
+    process_planar_in_place_tiles (input, n_input_samples, output, tile_size_, scratch_io());
+  else
+    process_block_planar_in_place_stack (input, n_input_samples, output);
+}
+
+PANDA_RESAMPLER_FN PANDA_RESAMPLER_FN_NOINLINE
+void
+Resampler2::process_block_planar_in_place_stack (const float * const *input,
+                                                 uint                 n_input_samples,
+                                                 float * const       *output)
+{
+  const uint block_size = 256;
+
+  float in[MAX_CHANNELS * block_size];
+
+  process_planar_in_place_tiles (input, n_input_samples, output, block_size, in);
+}
+
+/* in holds tile_size samples for each channel */
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_planar_in_place_tiles (const float * const *input,
+                                           uint                 n_input_samples,
+                                           float * const       *output,
+                                           uint                 tile_size,
+                                           float               *in)
+{
+  Impl *impl = impl_cascade ? impl_cascade.get() : impl_x2.get();
+
+  const float *in_p[MAX_CHANNELS];
+  float       *out_p[MAX_CHANNELS];
+  for (uint c = 0; c < channels_; c++)
+    {
+      in_p[c] = in + c * tile_size;
+      out_p[c] = output[c];
+    }
+
+  uint pos = 0;
+  while (pos < n_input_samples)
+    {
+      const uint n_todo_samples = min (tile_size, n_input_samples - pos);
+
+      for (uint c = 0; c < channels_; c++)
+        std::copy (input[c] + pos, input[c] + pos + n_todo_samples, in + c * tile_size);
+      impl->process_block_planar (in_p, n_todo_samples, out_p);
+
+      for (uint c = 0; c < channels_; c++)
+        out_p[c] += n_output_samples (n_todo_samples);
+      pos += n_todo_samples;
+    }
+}
+
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_block_two_channel_planar (const float * const *input,
+                                              uint                 n_input_samples,
+                                              float * const       *output)
+{
+  if (tile_size_)
+    {
+      float *in = scratch_io();
+      process_two_channel_tiles (input, n_input_samples, output, tile_size_, in, in + tile_size_ * 2);
+    }
+  else
+    process_block_two_channel_planar_stack (input, n_input_samples, output);
+}
+
+PANDA_RESAMPLER_FN PANDA_RESAMPLER_FN_NOINLINE
+void
+Resampler2::process_block_two_channel_planar_stack (const float * const *input,
+                                                    uint                 n_input_samples,
+                                                    float * const       *output)
+{
+  const uint block_size = 128;
+
+  alignas (32) float in[block_size * 2];
+  alignas (32) float out[block_size * 8 * 2];
+
+  process_two_channel_tiles (input, n_input_samples, output, block_size, in, out);
+}
+
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_two_channel_tiles (const float * const *input,
+                                       uint                 n_input_samples,
+                                       float * const       *output,
+                                       uint                 tile_size,
+                                       float               *in,
+                                       float               *out)
+{
+  /* the two channel stages work on interleaved frames: convert only once for
+   * the whole cascade instead of once for each stage
+   */
+  const float *in_l = input[0], *in_r = input[1];
+  float *out_l = output[0], *out_r = output[1];
+
+  while (n_input_samples)
+    {
+      const uint n_todo_samples = min (tile_size, n_input_samples);
+      const uint n_out_samples = mode_ == UP ? n_todo_samples * ratio_ : n_todo_samples / ratio_;
+
+      for (uint i = 0; i < n_todo_samples; i++)
+        {
+          in[i * 2]     = in_l[i];
+          in[i * 2 + 1] = in_r[i];
+        }
+      process_block_interleaved (in, n_todo_samples, out);
+      for (uint i = 0; i < n_out_samples; i++)
+        {
+          out_l[i] = out[i * 2];
+          out_r[i] = out[i * 2 + 1];
+        }
+      in_l += n_todo_samples;
+      in_r += n_todo_samples;
+      out_l += n_out_samples;
+      out_r += n_out_samples;
+      n_input_samples -= n_todo_samples;
+    }
+}
+
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_block_interleaved (const float *input,
+                                       uint         n_input_frames,
+                                       float       *output)
+{
+  if (channels_ == 1)
+    {
+      process_block (input, n_input_frames, output);
+      return;
+    }
+  if ((impl_cascade || ratio_ == 2) &&
+      buffers_overlap (input, n_input_frames * channels_, output, n_output_samples (n_input_frames) * channels_))
+    {
+      process_block_in_place (input, n_input_frames, output);
+      return;
+    }
+  if (impl_cascade)
+    {
+      impl_cascade->process_block_interleaved (input, n_input_frames, output);
+      return;
+    }
+  if (ratio_ == 2)
+    {
+      impl_x2->process_block_interleaved (input, n_input_frames, output);
+      return;
+    }
+  if (ratio_ == 1)
+    {
+      if (input != output)
+        std::copy (input, input + n_input_frames * channels_, output);
+      return;
+    }
+
+  process_block_multi_stage (input, n_input_frames, output);
+}
+
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_block_multi_stage (const float *input,
+                                       uint         n_input_frames,
+                                       float       *output)
+{
+  if (tile_size_)
+    process_tiles (input, n_input_frames, output, tile_size_, scratch_, scratch_tmp2());
+  else
+    process_block_multi_stage_stack (input, n_input_frames, output);
+}
+
+/* not inlined: the stack memory is only used without scratch memory */
+PANDA_RESAMPLER_FN PANDA_RESAMPLER_FN_NOINLINE
+void
+Resampler2::process_block_multi_stage_stack (const float *input,
+                                             uint         n_input_frames,
+                                             float       *output)
+{
+  /* multi-channel: smaller blocks, the temporary buffers are interleaved, too */
+  const uint block_size = channels_ == 1 ? 1024 : 128;
+
+  float tmp[MAX_CHANNELS * 128 * 4];
+  float tmp2[MAX_CHANNELS * 128 * 4];
+
+  process_tiles (input, n_input_frames, output, block_size, tmp, tmp2);
+}
+
+/*
+ * process mono or interleaved data with ratio 4 or 8, the outputs of the
+ * intermediate stages for one tile are stored in tmp and tmp2
+ *
+ * in-place processing works without extra copies here: each tile is read
+ * completely by the first stage before the last stage writes the output
+ */
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_tiles (const float *input,
+                           uint         n_input_frames,
+                           float       *output,
+                           uint         tile_size,
+                           float       *tmp,
+                           float       *tmp2)
+{
+  while (n_input_frames)
+    {
+      const uint n_todo_frames = min (tile_size, n_input_frames);
+
+      if (mode_ == UP)
+        {
+          if (ratio_ == 4)
+            {
+              impl_x2->process_block_interleaved (input, n_todo_frames, tmp);
+              impl_x4->process_block_interleaved (tmp, n_todo_frames * 2, output);
+            }
+          else /* ratio_ == 8 */
+            {
+              impl_x2->process_block_interleaved (input, n_todo_frames, tmp);
+              impl_x4->process_block_interleaved (tmp, n_todo_frames * 2, tmp2);
+              impl_x8->process_block_interleaved (tmp2, n_todo_frames * 4, output);
+            }
+          output += n_todo_frames * ratio_ * channels_;
+        }
+      else /* (mode_ == DOWN) */
+        {
+          if (ratio_ == 4)
+            {
+              impl_x4->process_block_interleaved (input, n_todo_frames, tmp);
+              impl_x2->process_block_interleaved (tmp, n_todo_frames / 2, output);
+            }
+          else /* ratio_ == 8 */
+            {
+              impl_x8->process_block_interleaved (input, n_todo_frames, tmp);
+              impl_x4->process_block_interleaved (tmp, n_todo_frames / 2, tmp2);
+              impl_x2->process_block_interleaved (tmp2, n_todo_frames / 4, output);
+            }
+          output += n_todo_frames / ratio_ * channels_;
+        }
+      input += n_todo_frames * channels_;
+      n_input_frames -= n_todo_frames;
+    }
+}
+
+/* --- tiled processing --- */
+
+/*
+ * scratch memory layout:
+ *
+ *  - tmp, tmp2: outputs of the intermediate stages (multi-stage processing)
+ *  - stage:     deinterleaved input of the mono downsampling stages
+ *  - io:        copies of the input and / or output of one tile (in-place
+ *               processing, two channel planar, add, double and PCM processing)
+ *
+ * The paths that use io call process_block_interleaved() or a stage on it, so
+ * io is separate from tmp, tmp2 and stage. Only tmp, tmp2 and stage are used
+ * for the (most common) mono and interleaved processing.
+ */
+PANDA_RESAMPLER_FN
+size_t
+Resampler2::tile_tmp_size (uint tile_size) const
+{
+  if (ratio_ < 4 || impl_cascade)
+    return 0;
+
+  /* UP: 2 * tile_size (+ 4 * tile_size for ratio 8), DOWN: tile_size / 2 (+ tile_size / 4) */
+  const size_t tmp_size  = mode_ == UP ? tile_size * 2 : tile_size / 2;
+  const size_t tmp2_size = ratio_ == 8 ? (mode_ == UP ? tile_size * 4 : tile_size / 4) : 0;
+  return (tmp_size + tmp2_size) * channels_;
+}
+
+PANDA_RESAMPLER_FN
+size_t
+Resampler2::tile_stage_size (uint tile_size) const
+{
+  /* mono downsampling stages: deinterleaved (even) input samples */
+  return mode_ == DOWN && channels_ == 1 && ratio_ >= 2 && !impl_cascade ? tile_size / 2 : 0;
+}
+
+/* input and output of one tile; this also fits the double precision
+ * intermediate outputs for half a tile (at most 6 * tile_size floats)
+ */
+PANDA_RESAMPLER_FN
+size_t
+Resampler2::tile_io_size (uint tile_size) const
+{
+  return size_t (tile_size + n_output_samples (tile_size)) * channels_;
+}
+
+PANDA_RESAMPLER_FN
+size_t
+Resampler2::scratch_size (uint tile_size) const
+{
+  return tile_tmp_size (tile_size) + tile_stage_size (tile_size) + tile_io_size (tile_size);
+}
+
+PANDA_RESAMPLER_FN
+float *
+Resampler2::scratch_tmp2() const
+{
+  return scratch_ + (mode_ == UP ? tile_size_ * 2 : tile_size_ / 2) * channels_;
+}
+
+PANDA_RESAMPLER_FN
+float *
+Resampler2::scratch_io() const
+{
+  return scratch_ + tile_tmp_size (tile_size_) + tile_stage_size (tile_size_);
+}
+
+PANDA_RESAMPLER_FN
+uint
+Resampler2::default_tile_size() const
+{
+  /* 16 KB: leaves room for input, output and filter state in a 32 KB L1 cache */
+  const size_t budget = 4096;
+  const uint   max_tile_size = 4096;
+
+  /* scratch memory used by mono / interleaved processing of 16 input frames (io is not used there) */
+  const size_t size16 = tile_tmp_size (16) + tile_stage_size (16);
+  if (size16 == 0)
+    return max_tile_size;
+
+  return std::max<uint> (16, std::min<size_t> (max_tile_size, budget / size16 * 16));
+}
+
+PANDA_RESAMPLER_FN
+void
+Resampler2::set_tile_size (uint   tile_size,
+                           float *scratch)
+{
+  if (!PANDA_RESAMPLER_CHECK (tile_size % 16 == 0))
+    return;
+
+  scratch_buffer_.reset();
+  if (tile_size && !scratch)
+    {
+      scratch_buffer_.reset (new AlignedArray<float> (scratch_size (tile_size)));
+      scratch = scratch_buffer_->begin();
+    }
+  tile_size_ = tile_size;
+  scratch_ = tile_size ? scratch : nullptr;
+
+  /* downsampling stages deinterleave their input into the scratch memory after tmp and tmp2 */
+  float *stage_scratch = scratch_ ? scratch_ + tile_tmp_size (tile_size) : nullptr;
+  uint   stage_size = tile_stage_size (tile_size);
+  for (auto impl : { impl_x2.get(), impl_x4.get(), impl_x8.get() })
+    if (impl)
+      impl->set_scratch (stage_size ? stage_scratch : nullptr, stage_size);
+}
+
+/* --- integer PCM conversion --- */
+
+static inline float
+pcm_scale (Resampler2::SampleFormat format)
+{
+  switch (format)
+    {
+      case Resampler2::FORMAT_S16: return 32768;
+      case Resampler2::FORMAT_S24: return 8388608;
+      case Resampler2::FORMAT_S32: return 2147483648.f;
+    }
+  return 1;
+}
+
+static inline uint
+pcm_sample_size (Resampler2::SampleFormat format)
+{
+  switch (format)
+    {
+      case Resampler2::FORMAT_S16: return 2;
+      case Resampler2::FORMAT_S24: return 3;
+      case Resampler2::FORMAT_S32: return 4;
+    }
+  return 0;
+}
+
+/* largest float value that can be converted to the format without overflow (2^31 - 128 for S32) */
+static inline float
+pcm_max (Resampler2::SampleFormat format)
+{
+  return format == Resampler2::FORMAT_S32 ? 2147483520.f : pcm_scale (format) - 1;
+}
+
+static inline int32_t
+pcm_read_s24 (const uint8_t *p)
+{
+  /* sign extension: assemble the sample in the upper 24 bits, then shift */
+  return int32_t (uint32_t (p[0]) << 8 | uint32_t (p[1]) << 16 | uint32_t (p[2]) << 24) >> 8;
+}
+
+static inline void
+pcm_write_s24 (uint8_t *p, int32_t value)
+{
+  p[0] = value;
+  p[1] = value >> 8;
+  p[2] = value >> 16;
+}
+
+/* converts n samples to float, output must be 16-byte aligned */
+static void
+pcm_to_float (const void *input, Resampler2::SampleFormat format, uint n, float *output)
+{
+  const float factor = 1 / pcm_scale (format);
+  uint i = 0;
+
+  switch (format)
+    {
+      case Resampler2::FORMAT_S16:
+        {
+          const int16_t *in = static_cast<const int16_t *> (input);
+#ifdef PANDA_RESAMPLER_SSE2
+          const __m128 vfactor = _mm_set1_ps (factor);
+          for (; i + 8 <= n; i += 8)
+            {
+              const __m128i x = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (in + i));
+              /* sign extension: move each int16 into the upper half of an int32, then shift */
+              const __m128i lo = _mm_srai_epi32 (_mm_unpacklo_epi16 (x, x), 16);
+              const __m128i hi = _mm_srai_epi32 (_mm_unpackhi_epi16 (x, x), 16);
+              _mm_store_ps (output + i, _mm_mul_ps (_mm_cvtepi32_ps (lo), vfactor));
+              _mm_store_ps (output + i + 4, _mm_mul_ps (_mm_cvtepi32_ps (hi), vfactor));
+            }
+#endif
+          for (; i < n; i++)
+            output[i] = in[i] * factor;
+          break;
+        }
+      case Resampler2::FORMAT_S24:
+        {
+          /* packed 24 bit samples can't be loaded with SSE2 shuffles */
+          const uint8_t *in = static_cast<const uint8_t *> (input);
+          for (; i < n; i++)
+            output[i] = pcm_read_s24 (in + i * 3) * factor;
+          break;
+        }
+      case Resampler2::FORMAT_S32:
+        {
+          const int32_t *in = static_cast<const int32_t *> (input);
+#ifdef PANDA_RESAMPLER_SSE2
+          const __m128 vfactor = _mm_set1_ps (factor);
+          for (; i + 4 <= n; i += 4)
+            {
+              const __m128i x = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (in + i));
+              _mm_store_ps (output + i, _mm_mul_ps (_mm_cvtepi32_ps (x), vfactor));
+            }
+#endif
+          for (; i < n; i++)
+            output[i] = in[i] * factor;
+          break;
+        }
+    }
+}
+
+/* converts n float samples to the integer format (rounded and saturated), input must be 16-byte aligned */
+static void
+float_to_pcm (const float *input, uint n, void *output, Resampler2::SampleFormat format)
+{
+  const float factor = pcm_scale (format);
+  const float max_value = pcm_max (format);
+  const float min_value = -factor;
+  uint i = 0;
+
+#ifdef PANDA_RESAMPLER_SSE2
+  const __m128 vfactor = _mm_set1_ps (factor);
+  const __m128 vmax = _mm_set1_ps (max_value);
+  const __m128 vmin = _mm_set1_ps (min_value);
+
+  /* _mm_cvtps_epi32 rounds to nearest (default rounding mode) */
+  auto convert = [&] (const float *p) {
+    return _mm_cvtps_epi32 (_mm_min_ps (_mm_max_ps (_mm_mul_ps (_mm_load_ps (p), vfactor), vmin), vmax));
+  };
+#endif
+  switch (format)
+    {
+      case Resampler2::FORMAT_S16:
+        {
+          int16_t *out = static_cast<int16_t *> (output);
+#ifdef PANDA_RESAMPLER_SSE2
+          for (; i + 8 <= n; i += 8)
+            {
+              const __m128i x = _mm_packs_epi32 (convert (input + i), convert (input + i + 4));
+              _mm_storeu_si128 (reinterpret_cast<__m128i *> (out + i), x);
+            }
+#endif
+          for (; i < n; i++)
+            out[i] = lrintf (min (max (input[i] * factor, min_value), max_value));
+          break;
+        }
+      case Resampler2::FORMAT_S24:
+        {
+          uint8_t *out = static_cast<uint8_t *> (output);
+#ifdef PANDA_RESAMPLER_SSE2
+          for (; i + 4 <= n; i += 4)
+            {
+              alignas (16) int32_t x[4];
+              _mm_store_si128 (reinterpret_cast<__m128i *> (x), convert (input + i));
+              for (uint j = 0; j < 4; j++)
+                pcm_write_s24 (out + (i + j) * 3, x[j]);
+            }
+#endif
+          for (; i < n; i++)
+            pcm_write_s24 (out + i * 3, lrintf (min (max (input[i] * factor, min_value), max_value)));
+          break;
+        }
+      case Resampler2::FORMAT_S32:
+        {
+          int32_t *out = static_cast<int32_t *> (output);
+#ifdef PANDA_RESAMPLER_SSE2
+          for (; i + 4 <= n; i += 4)
+            _mm_storeu_si128 (reinterpret_cast<__m128i *> (out + i), convert (input + i));
+#endif
+          for (; i < n; i++)
+            out[i] = lrintf (min (max (input[i] * factor, min_value), max_value));
+          break;
+        }
+    }
+}
+
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_block_pcm (const void   *input,
+                               SampleFormat  input_format,
+                               uint          n_input_frames,
+                               void         *output,
+                               SampleFormat  output_format)
+{
+  if (tile_size_)
+    {
+      float *in = scratch_io();
+      process_pcm_tiles (input, input_format, n_input_frames, output, output_format,
+                         tile_size_, in, in + tile_size_ * channels_);
+    }
+  else
+    process_block_pcm_stack (input, input_format, n_input_frames, output, output_format);
+}
+
+PANDA_RESAMPLER_FN PANDA_RESAMPLER_FN_NOINLINE
+void
+Resampler2::process_block_pcm_stack (const void   *input,
+                                     SampleFormat  input_format,
+                                     uint          n_input_frames,
+                                     void         *output,
+                                     SampleFormat  output_format)
+{
+  /* the block size is a multiple of 8 frames, so that the downsampler always
+   * gets complete output samples
+   */
+  const uint block_samples = 1024;
+  const uint block_frames = (block_samples / channels_) & ~7u;
+
+  alignas (16) float in[block_samples];
+  alignas (16) float out[block_samples * 8];
+
+  process_pcm_tiles (input, input_format, n_input_frames, output, output_format, block_frames, in, out);
+}
+
+/* in and out must be 16-byte aligned, tile_size must be a multiple of 8 */
+PANDA_RESAMPLER_FN
+void
+Resampler2::process_pcm_tiles (const void   *input,
+                               SampleFormat  input_format,
+                               uint          n_input_frames,
+                               void         *output,
+                               SampleFormat  output_format,
+                               uint          tile_size,
+                               float        *in,
+                               float        *out)
+{
+  const uint8_t *in_p = static_cast<const uint8_t *> (input);
+  uint8_t *out_p = static_cast<uint8_t *> (output);
+  const uint in_frame_size = pcm_sample_size (input_format) * channels_;
+  const uint out_frame_size = pcm_sample_size (output_format) * channels_;
+
+  while (n_input_frames)
+    {
+      const uint n_todo_frames = min (tile_size, n_input_frames);
+      const uint n_out_frames = mode_ == UP ? n_todo_frames * ratio_ : n_todo_frames / ratio_;
+
+      pcm_to_float (in_p, input_format, n_todo_frames * channels_, in);
+      process_block_interleaved (in, n_todo_frames, out);
+      float_to_pcm (out, n_out_frames * channels_, out_p, output_format);
+
+      in_p += n_todo_frames * in_frame_size;
+      out_p += n_out_frames * out_frame_size;
+      n_input_frames -= n_todo_frames;
+    }
+}
+
+PANDA_RESAMPLER_FN
+bool
+Resampler2::sse_available()
+{
+  return instruction_set_available() != ISET_FPU;
+}
+
+PANDA_RESAMPLER_FN
+Resampler2::InstructionSet
+Resampler2::instruction_set_available()
+{
+  static const InstructionSet iset = [] {
+#if defined (PANDA_RESAMPLER_AVX2)
+    /* cpuid is only executed once, the result is cached */
+    if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+      return ISET_AVX2;
+#endif
+#if defined (PANDA_RESAMPLER_SSE)
+    return ISET_SSE;
+#elif defined (PANDA_RESAMPLER_VECTOR) && (defined (__ARM_NEON) || defined (__aarch64__))
+    return ISET_NEON;
+#elif defined (PANDA_RESAMPLER_VECTOR)
+    return ISET_VECTOR;
+#else
+    return ISET_FPU;
+#endif
+  }();
+  return iset;
+}
+
+PANDA_RESAMPLER_FN
+const char *
+Resampler2::instruction_set_name (InstructionSet iset)
+{
+  switch (iset)
+  {
+  case ISET_FPU:     return "FPU";
+  case ISET_SSE:     return "SSE";
+  case ISET_AVX2:    return "AVX2";
+  case ISET_NEON:    return "NEON";
+  case ISET_VECTOR:  return "VECTOR";
+  default:           return "unknown instruction set enum value";
+  }
+}
+
+PANDA_RESAMPLER_FN
+Resampler2::Precision
+Resampler2::find_precision_for_bits (uint bits)
+{
+  if (bits <= 1)
+    return PREC_LINEAR;
+  if (bits <= 8)
+    return PREC_48DB;
+  if (bits <= 12)
+    return PREC_72DB;
+  if (bits <= 16)
+    return PREC_96DB;
+  if (bits <= 20)
+    return PREC_120DB;
+
+  /* thats the best precision we can deliver (and by the way also close to
+   * the best precision possible with floats anyway)
+   */
+  return PREC_144DB;
+}
+
+PANDA_RESAMPLER_FN
+const char *
+Resampler2::precision_name (Precision precision)
+{
+  switch (precision)
+  {
+  case PREC_LINEAR:  return "linear interpolation";
+  case PREC_48DB:    return "8 bit (48dB)";
+  case PREC_72DB:    return "12 bit (72dB)";
+  case PREC_96DB:    return "16 bit (96dB)";
+  case PREC_120DB:   return "20 bit (120dB)";
+  case PREC_144DB:   return "24 bit (144dB)";
+  default:			    return "unknown precision enum value";
+  }
+}
+
+namespace Aux {
+
+/*
+ * FIR filter routine
+ *
+ * A FIR filter has the characteristic that it has a finite impulse response,
+ * and can be computed by convolution of the input signal with that finite
+ * impulse response.
+ *
+ * Thus, we use this for computing the output of the FIR filter
+ *
+ * output = input[0] * taps[0] + input[1] * taps[1] + ... + input[N-1] * taps[N-1]
+ *
+ * where input is the input signal, taps are the filter coefficients, in
+ * other texts sometimes called h[0]..h[N-1] (impulse response) or a[0]..a[N-1]
+ * (non recursive part of a digital filter), and N is the filter order.
+ */
+template<class Accumulator, int STEPPING = 1> static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+Accumulator
+fir_process_one_sample (const float *input,
+                        const float *taps, /* [0..order-1] */
+			const uint   order)
+{
+  Accumulator out = 0;
+  for (uint i = 0; i < order; i++)
+    out += input[i * STEPPING] * taps[i];
+  return out;
+}
+
+/*
+ * FIR filter routine for 4 samples simultaneously
+ *
+ * This routine produces (approximately) the same result as fir_process_one_sample
+ * but computes four consecutive output values at once using vectorized SSE
+ * instructions. Note that sse_taps needs to be 16-byte aligned here, whereas
+ * input can have any alignment.
+ *
+ * Also note that sse_taps is not a plain impulse response here, but a special
+ * version that needs to be computed with fir_compute_sse_taps.
+ *
+ * The four output values are returned in one vector (out->v), so they can be
+ * stored using vector instructions.
+ */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void
+fir_process_4samples_sse (const float *input,
+                          const float *sse_taps,
+			  const uint   order,
+			  F4Vector    *out)
+{
+#ifdef PANDA_RESAMPLER_SIMD
+  /* taps must be 16-byte aligned, input is loaded with unaligned loads */
+  const F4Vector *sse_taps_v = reinterpret_cast<const F4Vector *> (sse_taps);
+  F4Vector out0_v, out1_v, out2_v, out3_v;
+
+  __m128 in_v = _mm_loadu_ps (input);
+  out0_v.v = _mm_mul_ps (in_v, sse_taps_v[0].v);
+  out1_v.v = _mm_mul_ps (in_v, sse_taps_v[1].v);
+  out2_v.v = _mm_mul_ps (in_v, sse_taps_v[2].v);
+  out3_v.v = _mm_mul_ps (in_v, sse_taps_v[3].v);
+
+  for (uint i = 1; i < (order + 6) / 4; i++)
+    {
+      in_v = _mm_loadu_ps (input + i * 4);
+      out0_v.v = _mm_add_ps (out0_v.v, _mm_mul_ps (in_v, sse_taps_v[i * 4 + 0].v));
+      out1_v.v = _mm_add_ps (out1_v.v, _mm_mul_ps (in_v, sse_taps_v[i * 4 + 1].v));
+      out2_v.v = _mm_add_ps (out2_v.v, _mm_mul_ps (in_v, sse_taps_v[i * 4 + 2].v));
+      out3_v.v = _mm_add_ps (out3_v.v, _mm_mul_ps (in_v, sse_taps_v[i * 4 + 3].v));
+    }
+
+  /* horizontal sums without leaving the registers: transpose the four
+   * accumulators (unpack) and add, so that out->v = [ sum out0_v, ..., sum out3_v ]
+   */
+  const __m128 s01 = _mm_add_ps (_mm_unpacklo_ps (out0_v.v, out1_v.v), _mm_unpackhi_ps (out0_v.v, out1_v.v));
+  const __m128 s23 = _mm_add_ps (_mm_unpacklo_ps (out2_v.v, out3_v.v), _mm_unpackhi_ps (out2_v.v, out3_v.v));
+  out->v = _mm_add_ps (_mm_movelh_ps (s01, s23), _mm_movehl_ps (s23, s01));
+#else
+  PANDA_RESAMPLER_CHECK(false); // should not be reached
+#endif
+}
+
+
+/*
+ * fir_compute_sse_taps takes a normal vector of FIR taps as argument and
+ * computes a specially scrambled version of these taps, ready to be used
+ * for SSE operations (by fir_process_4samples_sse).
+ *
+ * we require a special ordering of the FIR taps, to get maximum benefit of the SSE operations
+ *
+ * example: suppose the FIR taps are [ x1 x2 x3 x4 x5 x6 x7 x8 x9 ], then the SSE taps become
+ *
+ * [ x1 x2 x3 x4   0 x1 x2 x3   0  0 x1 x2   0  0  0 x1      <- for input[0]
+ *   x5 x6 x7 x8  x4 x5 x6 x7  x3 x4 x5 x6  x2 x3 x4 x5      <- for input[1]
+ *   x9  0  0  0  x8 x9  0  0  x7 x8 x9  0  x6 x7 x8 x9 ]    <- for input[2]
+ * \------------/\-----------/\-----------/\-----------/
+ *    for out0     for out1      for out2     for out3
+ *
+ * so that we can compute out0, out1, out2 and out3 simultaneously
+ * from input[0]..input[2]
+ */
+static inline vector<float>
+fir_compute_sse_taps (const vector<float>& taps)
+{
+  const int order = taps.size();
+  vector<float> sse_taps ((order + 6) / 4 * 16);
+
+  for (int j = 0; j < 4; j++)
+    for (int i = 0; i < order; i++)
+      {
+	int k = i + j;
+	sse_taps[(k / 4) * 16 + (k % 4) + j * 4] = taps[i];
+      }
+
+  return sse_taps;
+}
+
+/*
+ * fir_taps_symmetric returns true if the impulse response is symmetric, that
+ * is taps[i] == taps[order - 1 - i], and the order is even (all halfband
+ * designs we use fulfill this)
+ *
+ * The symmetric kernels need at least four taps (since the taps are padded,
+ * they would read before the start of the input otherwise), the ResamplerBank
+ * kernels don't pad the taps and can use min_order 2.
+ */
+template<class T> static inline bool
+fir_taps_symmetric (const vector<T>& taps, size_t min_order = 4)
+{
+  const size_t order = taps.size();
+  if (order < min_order || (order & 1))
+    return false;
+
+  for (size_t i = 0; i < order / 2; i++)
+    if (taps[i] != taps[order - 1 - i])
+      return false;
+  return true;
+}
+
+/*
+ * Symmetric FIR filter routine for 4 samples simultaneously
+ *
+ * For symmetric taps, we can add the mirrored input values first and
+ * multiply by only one half of the taps:
+ *
+ * output = (input[0] + input[N-1]) * taps[0] + (input[1] + input[N-2]) * taps[1] + ...
+ *
+ * Each vector operation computes the same term for four consecutive outputs,
+ * so we don't need to compute horizontal sums at the end. Input doesn't need
+ * to be aligned, sym_taps needs to be computed with fir_compute_symmetric_taps,
+ * with the same WIDTH.
+ *
+ * For two interleaved channels (like complex I/Q samples), STRIDE is 2: then
+ * the four outputs are two consecutive frames, and both channels are filtered
+ * with the same taps in one pass.
+ */
+template<uint WIDTH = 4, uint STRIDE = 1> static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void
+fir_process_4samples_symmetric_sse (const float *input,
+                                    const float *sym_taps,
+                                    const uint   order,
+                                    F4Vector    *out)
+{
+#ifdef PANDA_RESAMPLER_SIMD
+  /* sym_taps may be computed for a larger width, we only use the first four values of each tap */
+  const F4Vector *sym_taps_v = reinterpret_cast<const F4Vector *> (sym_taps);
+  const uint      S = WIDTH / 4;
+  const float    *input_r = input + (order - 1) * STRIDE;
+
+  /* use four accumulators to avoid a long dependency chain of additions */
+  __m128 out0_v = _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input), _mm_loadu_ps (input_r)), sym_taps_v[0].v);
+  __m128 out1_v = _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + STRIDE), _mm_loadu_ps (input_r - STRIDE)), sym_taps_v[S].v);
+  __m128 out2_v = _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + 2 * STRIDE), _mm_loadu_ps (input_r - 2 * STRIDE)), sym_taps_v[2 * S].v);
+  __m128 out3_v = _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + 3 * STRIDE), _mm_loadu_ps (input_r - 3 * STRIDE)), sym_taps_v[3 * S].v);
+
+  for (uint i = 4; i < order / 2; i += 4)
+    {
+      out0_v = _mm_add_ps (out0_v, _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + i * STRIDE), _mm_loadu_ps (input_r - i * STRIDE)), sym_taps_v[i * S].v));
+      out1_v = _mm_add_ps (out1_v, _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + (i + 1) * STRIDE), _mm_loadu_ps (input_r - (i + 1) * STRIDE)), sym_taps_v[(i + 1) * S].v));
+      out2_v = _mm_add_ps (out2_v, _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + (i + 2) * STRIDE), _mm_loadu_ps (input_r - (i + 2) * STRIDE)), sym_taps_v[(i + 2) * S].v));
+      out3_v = _mm_add_ps (out3_v, _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + (i + 3) * STRIDE), _mm_loadu_ps (input_r - (i + 3) * STRIDE)), sym_taps_v[(i + 3) * S].v));
+    }
+  out->v = _mm_add_ps (_mm_add_ps (out0_v, out1_v), _mm_add_ps (out2_v, out3_v));
+#else
+  PANDA_RESAMPLER_CHECK(false); // should not be reached
+#endif
+}
+
+/*
+ * Output stores of the FIR stages: for ADD == false, the values are stored,
+ * for ADD == true, the values multiplied by gain are added to the output
+ * (see Resampler2::process_block_add)
+ */
+template<bool ADD> static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void
+fir_store_sample (float *output,
+                  float  value,
+                  float  gain)
+{
+  if (ADD)
+    *output += value * gain;
+  else
+    *output = value;
+}
+
+#ifdef PANDA_RESAMPLER_SIMD
+template<bool ADD> static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void
+fir_store_4samples (float  *output,
+                    __m128  value_v,
+                    float   gain)
+{
+  if (ADD)
+    value_v = _mm_add_ps (_mm_loadu_ps (output), _mm_mul_ps (value_v, _mm_set1_ps (gain)));
+  _mm_storeu_ps (output, value_v);
+}
+#endif
+
+/* filters up to this order use the fully unrolled kernels, with taps kept in registers */
+static constexpr uint FIR_SHORT_ORDER = 16;
+
+/*
+ * Symmetric FIR filter routine for short filters, 8 samples simultaneously
+ *
+ * The filter order is a template argument, so the loop over the taps is fully
+ * unrolled by the compiler. taps_v contains one vector per tap (first half of
+ * the taps only), which the caller loads once per block, so that for short
+ * filters (like the ones used for the x4 and x8 stages) the taps stay in
+ * registers. Two groups of four outputs are computed, which allows reusing
+ * each loaded input vector for both groups.
+ */
+template<uint ORDER> static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void
+fir_process_8samples_symmetric_short_sse (const float    *input,
+                                          const F4Vector *taps_v,
+                                          F4Vector       *out)
+{
+#ifdef PANDA_RESAMPLER_SIMD
+  const float *input_r = input + ORDER - 1;
+
+  __m128 out0_v = _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input), _mm_loadu_ps (input_r)), taps_v[0].v);
+  __m128 out1_v = _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + 4), _mm_loadu_ps (input_r + 4)), taps_v[0].v);
+  for (uint i = 1; i < ORDER / 2; i++)
+    {
+      out0_v = _mm_add_ps (out0_v, _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + i), _mm_loadu_ps (input_r - i)), taps_v[i].v));
+      out1_v = _mm_add_ps (out1_v, _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (input + 4 + i), _mm_loadu_ps (input_r + 4 - i)), taps_v[i].v));
+    }
+  out[0].v = out0_v;
+  out[1].v = out1_v;
+#else
+  PANDA_RESAMPLER_CHECK(false); // should not be reached
+#endif
+}
+
+/*
+ * fir_compute_symmetric_taps computes the tap layout used by the symmetric
+ * FIR kernels: the first half of the (symmetric) taps, each tap repeated
+ * width times (4 for SSE, 8 for AVX). The number of taps is padded with
+ * zeros to a multiple of four (so the kernels can use four accumulators).
+ */
+static inline vector<float>
+fir_compute_symmetric_taps (const vector<float>& taps,
+                            uint                 width)
+{
+  const uint half = (taps.size() / 2 + 3) / 4 * 4;
+  vector<float> sym_taps (half * width);
+
+  for (uint i = 0; i < taps.size() / 2; i++)
+    for (uint j = 0; j < width; j++)
+      sym_taps[i * width + j] = taps[i];
+
+  return sym_taps;
+}
+
+/*
+ * fir_compute_avx_taps computes the scrambled taps for fir_process_8samples_avx
+ *
+ * this uses the same scheme as fir_compute_sse_taps, only with eight outputs
+ * and eight floats per input vector
+ */
+static inline vector<float>
+fir_compute_avx_taps (const vector<float>& taps)
+{
+  const int order = taps.size();
+  vector<float> avx_taps ((order + 14) / 8 * 64);
+
+  for (int j = 0; j < 8; j++)
+    for (int i = 0; i < order; i++)
+      {
+        int k = i + j;
+        avx_taps[(k / 8) * 64 + (k % 8) + j * 8] = taps[i];
+      }
+
+  return avx_taps;
+}
+
+#ifdef PANDA_RESAMPLER_AVX2
+/* AVX2 version of fir_store_4samples */
+template<bool ADD> static PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void
+fir_store_8samples_avx (float  *output,
+                        __m256  value_v,
+                        float   gain)
+{
+  if (ADD)
+    value_v = _mm256_fmadd_ps (value_v, _mm256_set1_ps (gain), _mm256_loadu_ps (output));
+  _mm256_storeu_ps (output, value_v);
+}
+
+/*
+ * FIR filter routine for 8 samples simultaneously
+ *
+ * This is the AVX2/FMA version of fir_process_4samples_sse: it computes eight
+ * consecutive output values at once and returns them in one vector. Input
+ * doesn't need to be aligned, but avx_taps must be 32-byte aligned and needs
+ * to be computed with fir_compute_avx_taps.
+ */
+static PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m256
+fir_process_8samples_avx (const float *input,
+                          const float *avx_taps,
+                          const uint   order)
+{
+  const __m256 *avx_taps_v = reinterpret_cast<const __m256 *> (avx_taps);
+
+  __m256 in_v = _mm256_loadu_ps (input);
+  __m256 out0_v = _mm256_mul_ps (in_v, avx_taps_v[0]);
+  __m256 out1_v = _mm256_mul_ps (in_v, avx_taps_v[1]);
+  __m256 out2_v = _mm256_mul_ps (in_v, avx_taps_v[2]);
+  __m256 out3_v = _mm256_mul_ps (in_v, avx_taps_v[3]);
+  __m256 out4_v = _mm256_mul_ps (in_v, avx_taps_v[4]);
+  __m256 out5_v = _mm256_mul_ps (in_v, avx_taps_v[5]);
+  __m256 out6_v = _mm256_mul_ps (in_v, avx_taps_v[6]);
+  __m256 out7_v = _mm256_mul_ps (in_v, avx_taps_v[7]);
+
+  for (uint i = 1; i < (order + 14) / 8; i++)
+    {
+      in_v = _mm256_loadu_ps (input + i * 8);
+      out0_v = _mm256_fmadd_ps (in_v, avx_taps_v[i * 8 + 0], out0_v);
+      out1_v = _mm256_fmadd_ps (in_v, avx_taps_v[i * 8 + 1], out1_v);
+      out2_v = _mm256_fmadd_ps (in_v, avx_taps_v[i * 8 + 2], out2_v);
+      out3_v = _mm256_fmadd_ps (in_v, avx_taps_v[i * 8 + 3], out3_v);
+      out4_v = _mm256_fmadd_ps (in_v, avx_taps_v[i * 8 + 4], out4_v);
+      out5_v = _mm256_fmadd_ps (in_v, avx_taps_v[i * 8 + 5], out5_v);
+      out6_v = _mm256_fmadd_ps (in_v, avx_taps_v[i * 8 + 6], out6_v);
+      out7_v = _mm256_fmadd_ps (in_v, avx_taps_v[i * 8 + 7], out7_v);
+    }
+
+  /* horizontal sums: after two rounds of hadd, each 128-bit half contains
+   * partial sums for out0..out3 (t0) and out4..out7 (t1)
+   */
+  const __m256 t0 = _mm256_hadd_ps (_mm256_hadd_ps (out0_v, out1_v), _mm256_hadd_ps (out2_v, out3_v));
+  const __m256 t1 = _mm256_hadd_ps (_mm256_hadd_ps (out4_v, out5_v), _mm256_hadd_ps (out6_v, out7_v));
+
+  return _mm256_add_ps (_mm256_permute2f128_ps (t0, t1, 0x20), _mm256_permute2f128_ps (t0, t1, 0x31));
+}
+
+/*
+ * Symmetric FIR filter routine for 8 samples simultaneously
+ *
+ * This is the AVX2/FMA version of fir_process_4samples_symmetric_sse.
+ */
+template<uint STRIDE = 1> static PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m256
+fir_process_8samples_symmetric_avx (const float *input,
+                                    const float *sym_taps,
+                                    const uint   order)
+{
+  const __m256 *sym_taps_v = reinterpret_cast<const __m256 *> (sym_taps);
+  const float  *input_r = input + (order - 1) * STRIDE;
+
+  __m256 out0_v = _mm256_mul_ps (_mm256_add_ps (_mm256_loadu_ps (input), _mm256_loadu_ps (input_r)), sym_taps_v[0]);
+  __m256 out1_v = _mm256_mul_ps (_mm256_add_ps (_mm256_loadu_ps (input + STRIDE), _mm256_loadu_ps (input_r - STRIDE)), sym_taps_v[1]);
+  __m256 out2_v = _mm256_mul_ps (_mm256_add_ps (_mm256_loadu_ps (input + 2 * STRIDE), _mm256_loadu_ps (input_r - 2 * STRIDE)), sym_taps_v[2]);
+  __m256 out3_v = _mm256_mul_ps (_mm256_add_ps (_mm256_loadu_ps (input + 3 * STRIDE), _mm256_loadu_ps (input_r - 3 * STRIDE)), sym_taps_v[3]);
+
+  for (uint i = 4; i < order / 2; i += 4)
+    {
+      out0_v = _mm256_fmadd_ps (_mm256_add_ps (_mm256_loadu_ps (input + i * STRIDE), _mm256_loadu_ps (input_r - i * STRIDE)), sym_taps_v[i], out0_v);
+      out1_v = _mm256_fmadd_ps (_mm256_add_ps (_mm256_loadu_ps (input + (i + 1) * STRIDE), _mm256_loadu_ps (input_r - (i + 1) * STRIDE)), sym_taps_v[i + 1], out1_v);
+      out2_v = _mm256_fmadd_ps (_mm256_add_ps (_mm256_loadu_ps (input + (i + 2) * STRIDE), _mm256_loadu_ps (input_r - (i + 2) * STRIDE)), sym_taps_v[i + 2], out2_v);
+      out3_v = _mm256_fmadd_ps (_mm256_add_ps (_mm256_loadu_ps (input + (i + 3) * STRIDE), _mm256_loadu_ps (input_r - (i + 3) * STRIDE)), sym_taps_v[i + 3], out3_v);
+    }
+  return _mm256_add_ps (_mm256_add_ps (out0_v, out1_v), _mm256_add_ps (out2_v, out3_v));
+}
+
+/*
+ * Symmetric FIR filter routine for short filters, 16 samples simultaneously
+ *
+ * This is the AVX2/FMA version of fir_process_8samples_symmetric_short_sse.
+ */
+template<uint ORDER> static PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void
+fir_process_16samples_symmetric_short_avx (const float  *input,
+                                           const __m256 *taps_v,
+                                           __m256       *out)
+{
+  const float *input_r = input + ORDER - 1;
+
+  __m256 out0_v = _mm256_mul_ps (_mm256_add_ps (_mm256_loadu_ps (input), _mm256_loadu_ps (input_r)), taps_v[0]);
+  __m256 out1_v = _mm256_mul_ps (_mm256_add_ps (_mm256_loadu_ps (input + 8), _mm256_loadu_ps (input_r + 8)), taps_v[0]);
+  for (uint i = 1; i < ORDER / 2; i++)
+    {
+      out0_v = _mm256_fmadd_ps (_mm256_add_ps (_mm256_loadu_ps (input + i), _mm256_loadu_ps (input_r - i)), taps_v[i], out0_v);
+      out1_v = _mm256_fmadd_ps (_mm256_add_ps (_mm256_loadu_ps (input + 8 + i), _mm256_loadu_ps (input_r + 8 - i)), taps_v[i], out1_v);
+    }
+  out[0] = out0_v;
+  out[1] = out1_v;
+}
+
+/*
+ * transpose_8x8_avx transposes an 8x8 matrix of floats (stored as eight row
+ * vectors); this is used to convert between planar multi-channel data and
+ * vectors containing one sample of each channel
+ */
+static PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void
+transpose_8x8_avx (__m256 *rows)
+{
+  const __m256 t0 = _mm256_unpacklo_ps (rows[0], rows[1]);
+  const __m256 t1 = _mm256_unpackhi_ps (rows[0], rows[1]);
+  const __m256 t2 = _mm256_unpacklo_ps (rows[2], rows[3]);
+  const __m256 t3 = _mm256_unpackhi_ps (rows[2], rows[3]);
+  const __m256 t4 = _mm256_unpacklo_ps (rows[4], rows[5]);
+  const __m256 t5 = _mm256_unpackhi_ps (rows[4], rows[5]);
+  const __m256 t6 = _mm256_unpacklo_ps (rows[6], rows[7]);
+  const __m256 t7 = _mm256_unpackhi_ps (rows[6], rows[7]);
+
+  const __m256 s0 = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (1, 0, 1, 0));
+  const __m256 s1 = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (3, 2, 3, 2));
+  const __m256 s2 = _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (1, 0, 1, 0));
+  const __m256 s3 = _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (3, 2, 3, 2));
+  const __m256 s4 = _mm256_shuffle_ps (t4, t6, _MM_SHUFFLE (1, 0, 1, 0));
+  const __m256 s5 = _mm256_shuffle_ps (t4, t6, _MM_SHUFFLE (3, 2, 3, 2));
+  const __m256 s6 = _mm256_shuffle_ps (t5, t7, _MM_SHUFFLE (1, 0, 1, 0));
+  const __m256 s7 = _mm256_shuffle_ps (t5, t7, _MM_SHUFFLE (3, 2, 3, 2));
+
+  rows[0] = _mm256_permute2f128_ps (s0, s4, 0x20);
+  rows[1] = _mm256_permute2f128_ps (s1, s5, 0x20);
+  rows[2] = _mm256_permute2f128_ps (s2, s6, 0x20);
+  rows[3] = _mm256_permute2f128_ps (s3, s7, 0x20);
+  rows[4] = _mm256_permute2f128_ps (s0, s4, 0x31);
+  rows[5] = _mm256_permute2f128_ps (s1, s5, 0x31);
+  rows[6] = _mm256_permute2f128_ps (s2, s6, 0x31);
+  rows[7] = _mm256_permute2f128_ps (s3, s7, 0x31);
+}
+
+/*
+ * tests fir_process_16samples_symmetric_short_avx for one filter order,
+ * returns the number of errors
+ */
+template<uint ORDER> static inline PANDA_RESAMPLER_TARGET_AVX2
+int
+fir_test_filter_short_avx (bool verbose)
+{
+  vector<float> taps (ORDER);
+  for (uint i = 0; i < ORDER / 2; i++)
+    taps[i] = taps[ORDER - 1 - i] = i + 1;
+
+  AlignedArray<float> sym_taps (fir_compute_symmetric_taps (taps, 8));
+  AlignedArray<float> random_mem (ORDER + 15);
+  for (uint i = 0; i < ORDER + 15; i++)
+    random_mem[i] = 1.0 - rand() / (0.5 * RAND_MAX);
+
+  __m256 taps_v[ORDER / 2];
+  for (uint t = 0; t < ORDER / 2; t++)
+    taps_v[t] = _mm256_load_ps (&sym_taps[t * 8]);
+
+  __m256 out_v[2];
+  fir_process_16samples_symmetric_short_avx<ORDER> (&random_mem[0], taps_v, out_v);
+
+  float out[16];
+  _mm256_storeu_ps (&out[0], out_v[0]);
+  _mm256_storeu_ps (&out[8], out_v[1]);
+
+  double avg_diff = 0.0;
+  for (int i = 0; i < 16; i++)
+    {
+      double diff = fir_process_one_sample<double> (&random_mem[i], taps.data(), ORDER) - out[i];
+      avg_diff += fabs (diff);
+    }
+  avg_diff /= (ORDER + 1);
+  bool is_error = (avg_diff > 0.00001);
+  if (is_error || verbose)
+    printf ("*** order = %d, short, avg_diff = %g\n", ORDER, avg_diff);
+  return is_error ? 1 : 0;
+}
+
+/*
+ * This function tests the AVX2/FMA FIR filter code (fir_compute_avx_taps and
+ * fir_process_8samples_avx), see fir_test_filter_sse.
+ */
+static inline PANDA_RESAMPLER_TARGET_AVX2 bool
+fir_test_filter_avx (bool       verbose,
+                     const uint max_order = 64)
+{
+  int errors = 0;
+  if (verbose)
+    printf ("testing AVX filter implementation:\n\n");
+
+  for (uint order = 0; order < max_order; order++)
+    {
+      vector<float> taps (order);
+      for (uint i = 0; i < order; i++)
+        taps[i] = i + 1;
+
+      AlignedArray<float> avx_taps (fir_compute_avx_taps (taps));
+      AlignedArray<float> random_mem (order + 14);
+      for (uint i = 0; i < order + 14; i++)
+        random_mem[i] = 1.0 - rand() / (0.5 * RAND_MAX);
+
+      float out[8];
+      _mm256_storeu_ps (out, fir_process_8samples_avx (&random_mem[0], &avx_taps[0], order));
+
+      double avg_diff = 0.0;
+      for (int i = 0; i < 8; i++)
+        {
+          double diff = fir_process_one_sample<double> (&random_mem[i], taps.data(), order) - out[i];
+          avg_diff += fabs (diff);
+        }
+      avg_diff /= (order + 1);
+      bool is_error = (avg_diff > 0.00001);
+      if (is_error || verbose)
+        printf ("*** order = %d, avg_diff = %g\n", order, avg_diff);
+      if (is_error)
+        errors++;
+
+      if (order >= 4 && (order & 1) == 0)
+        {
+          /* symmetric kernel */
+          for (uint i = 0; i < order / 2; i++)
+            taps[order - 1 - i] = taps[i];
+
+          AlignedArray<float> sym_taps (fir_compute_symmetric_taps (taps, 8));
+          _mm256_storeu_ps (out, fir_process_8samples_symmetric_avx (&random_mem[0], &sym_taps[0], order));
+
+          avg_diff = 0.0;
+          for (int i = 0; i < 8; i++)
+            {
+              double diff = fir_process_one_sample<double> (&random_mem[i], taps.data(), order) - out[i];
+              avg_diff += fabs (diff);
+            }
+          avg_diff /= (order + 1);
+          is_error = (avg_diff > 0.00001);
+          if (is_error || verbose)
+            printf ("*** order = %d, symmetric, avg_diff = %g\n", order, avg_diff);
+          if (is_error)
+            errors++;
+        }
+    }
+  /* fully unrolled kernels for short filters */
+  errors += fir_test_filter_short_avx<4> (verbose) + fir_test_filter_short_avx<6> (verbose) + fir_test_filter_short_avx<8> (verbose) +
+            fir_test_filter_short_avx<10> (verbose) + fir_test_filter_short_avx<12> (verbose) + fir_test_filter_short_avx<14> (verbose) +
+            fir_test_filter_short_avx<16> (verbose);
+  if (errors)
+    printf ("*** %d errors detected\n", errors);
+
+  return (errors == 0);
+}
+#endif /* PANDA_RESAMPLER_AVX2 */
+
+/*
+ * tests fir_process_8samples_symmetric_short_sse for one filter order,
+ * returns the number of errors
+ */
+template<uint ORDER> static inline int
+fir_test_filter_short_sse (bool verbose)
+{
+#ifdef PANDA_RESAMPLER_SIMD
+  vector<float> taps (ORDER);
+  for (uint i = 0; i < ORDER / 2; i++)
+    taps[i] = taps[ORDER - 1 - i] = i + 1;
+
+  AlignedArray<float> sym_taps (fir_compute_symmetric_taps (taps, 4));
+  AlignedArray<float> random_mem (ORDER + 7);
+  for (uint i = 0; i < ORDER + 7; i++)
+    random_mem[i] = 1.0 - rand() / (0.5 * RAND_MAX);
+
+  F4Vector taps_v[ORDER / 2];
+  for (uint t = 0; t < ORDER / 2; t++)
+    taps_v[t].v = _mm_loadu_ps (&sym_taps[t * 4]);
+
+  F4Vector out[2];
+  fir_process_8samples_symmetric_short_sse<ORDER> (&random_mem[0], taps_v, out);
+
+  double avg_diff = 0.0;
+  for (int i = 0; i < 8; i++)
+    {
+      double diff = fir_process_one_sample<double> (&random_mem[i], taps.data(), ORDER) - out[i / 4].f[i % 4];
+      avg_diff += fabs (diff);
+    }
+  avg_diff /= (ORDER + 1);
+  bool is_error = (avg_diff > 0.00001);
+  if (is_error || verbose)
+    printf ("*** order = %d, short, avg_diff = %g\n", ORDER, avg_diff);
+  return is_error ? 1 : 0;
+#else
+  return 0;
+#endif
+}
+
+/*
+ * This function tests the SSEified FIR filter code (that is, the reordering
+ * done by fir_compute_sse_taps and the actual computation implemented in
+ * fir_process_4samples_sse).
+ *
+ * It prints diagnostic information, and returns true if the filter
+ * implementation works correctly, and false otherwise. The maximum filter
+ * order to be tested can be optionally specified as argument.
+ */
+static inline bool
+fir_test_filter_sse (bool       verbose,
+                     const uint max_order = 64)
+{
+  int errors = 0;
+  if (verbose)
+    printf ("testing SSE filter implementation:\n\n");
+
+  for (uint order = 0; order < max_order; order++)
+    {
+      vector<float> taps (order);
+      for (uint i = 0; i < order; i++)
+	taps[i] = i + 1;
+
+      AlignedArray<float> sse_taps (fir_compute_sse_taps (taps));
+      if (verbose)
+	{
+	  for (uint i = 0; i < sse_taps.size(); i++)
+	    {
+	      printf ("%3d", (int) (sse_taps[i] + 0.5));
+	      if (i % 4 == 3)
+		printf ("  |");
+	      if (i % 16 == 15)
+		printf ("   ||| upper bound = %d\n", (order + 6) / 4);
+	    }
+	  printf ("\n\n");
+	}
+
+      AlignedArray<float> random_mem (order + 6);
+      for (uint i = 0; i < order + 6; i++)
+	random_mem[i] = 1.0 - rand() / (0.5 * RAND_MAX);
+
+      /* FIXME: the problem with this test is that we explicitely test SSE code
+       * here, but the test case is not compiled with -msse within the BEAST tree
+       */
+      F4Vector out;
+      fir_process_4samples_sse (&random_mem[0], &sse_taps[0], order, &out);
+
+      double avg_diff = 0.0;
+      for (int i = 0; i < 4; i++)
+	{
+	  double diff = fir_process_one_sample<double> (&random_mem[i], taps.data(), order) - out.f[i];
+	  avg_diff += fabs (diff);
+	}
+      avg_diff /= (order + 1);
+      bool is_error = (avg_diff > 0.00001);
+      if (is_error || verbose)
+	printf ("*** order = %d, avg_diff = %g\n", order, avg_diff);
+      if (is_error)
+	errors++;
+
+      if (order >= 4 && (order & 1) == 0)
+        {
+          /* symmetric kernel: make taps symmetric and compare again */
+          for (uint i = 0; i < order / 2; i++)
+            taps[order - 1 - i] = taps[i];
+
+          AlignedArray<float> sym_taps (fir_compute_symmetric_taps (taps, 4));
+          F4Vector out_v;
+          fir_process_4samples_symmetric_sse (&random_mem[0], &sym_taps[0], order, &out_v);
+
+          avg_diff = 0.0;
+          for (int i = 0; i < 4; i++)
+            {
+              double diff = fir_process_one_sample<double> (&random_mem[i], taps.data(), order) - out_v.f[i];
+              avg_diff += fabs (diff);
+            }
+          avg_diff /= (order + 1);
+          is_error = (avg_diff > 0.00001);
+          if (is_error || verbose)
+            printf ("*** order = %d, symmetric, avg_diff = %g\n", order, avg_diff);
+          if (is_error)
+            errors++;
+        }
+    }
+  /* fully unrolled kernels for short filters */
+  errors += fir_test_filter_short_sse<4> (verbose) + fir_test_filter_short_sse<6> (verbose) + fir_test_filter_short_sse<8> (verbose) +
+            fir_test_filter_short_sse<10> (verbose) + fir_test_filter_short_sse<12> (verbose) + fir_test_filter_short_sse<14> (verbose) +
+            fir_test_filter_short_sse<16> (verbose);
+  if (errors)
+    printf ("*** %d errors detected\n", errors);
+
+  return (errors == 0);
+}
+
+} // Aux
+
+using namespace Aux; // avoid anon namespace
+
+/* --- tap layouts of the double precision, fixed-point and ResamplerBank stages ---
+ *
+ * These are only needed by processes that use these stages, so unlike the
+ * float layouts (FIRTaps), each has its own cache, see fir_shared_layout()
+ */
+
+/* four double precision samples, the compiler uses one AVX register (or two SSE2 registers) */
+typedef double DoubleLanes __attribute__((vector_size (4 * sizeof (double))));
+
+static inline void
+double_lanes_set (DoubleLanes& v, double d)
+{
+  for (uint l = 0; l < 4; l++)
+    v[l] = d;
+}
+
+/* first half of the taps, followed by 0.5 (for the odd samples when downsampling) */
+struct DoubleFIRTaps
+{
+  AlignedArray<DoubleLanes> lanes;
+
+  DoubleFIRTaps (const vector<double>& coeffs) :
+    lanes (coeffs.size() / 2 + 1)
+  {
+    const uint half = coeffs.size() / 2;
+    for (uint k = 0; k < half; k++)
+      double_lanes_set (lanes[k], coeffs[k]);
+    double_lanes_set (lanes[half], 0.5);
+  }
+};
+
+/* one sample of each stream of a group */
+typedef float BankLanes __attribute__((vector_size (ResamplerBank::LANES * sizeof (float))));
+
+static inline void
+bank_lanes_set (BankLanes& v, float f)
+{
+  for (uint l = 0; l < ResamplerBank::LANES; l++)
+    v[l] = f;
+}
+
+/* same layout as DoubleFIRTaps */
+struct BankFIRTaps
+{
+  AlignedArray<BankLanes> lanes;
+
+  BankFIRTaps (const vector<double>& coeffs) :
+    lanes (coeffs.size() / 2 + 1)
+  {
+    const uint half = coeffs.size() / 2;
+    for (uint k = 0; k < half; k++)
+      bank_lanes_set (lanes[k], coeffs[k]);
+    bank_lanes_set (lanes[half], 0.5);
+  }
+};
+
+#ifdef PANDA_RESAMPLER_SSE2
+/* int16 samples are float samples scaled by this factor (one bit of headroom, see the fixed-point FIR stages) */
+static constexpr float FIXED_SAMPLE_SCALE = 16384;
+
+/* coefficients quantized to int16, each vector contains the pair taps[2 * m], taps[2 * m + 1] eight times */
+struct FixedTaps
+{
+  const vector<double>& coeffs; /* for the double precision stage, see fir_shared_layout() */
+  AlignedArray<int32_t> pairs;
+  uint                  split;  /* the pairs [0, split) and [split, order / 2) are accumulated separately */
+  float                 scale;  /* converts the int32 filter output to float */
+
+  FixedTaps (const vector<double>& taps) :
+    coeffs (taps),
+    pairs (taps.size() * 4),
+    split (taps.size() / 4)
+  {
+    /* use the full int16 range for the largest coefficient, but neither of the
+     * two int32 accumulators may overflow, even for a full scale input signal
+     * with the worst case signs
+     */
+    double max_abs = 0, sum_abs[2] = { 0, 0 };
+    for (uint i = 0; i < taps.size(); i++)
+      {
+        max_abs = max (max_abs, fabs (taps[i]));
+        sum_abs[i / 2 >= split] += fabs (taps[i]);
+      }
+    double tap_scale = 32767 / max_abs;
+    for (auto s : sum_abs)
+      tap_scale = min (tap_scale, 2147483000.0 / (s * 32768 + taps.size()));
+
+    for (uint m = 0; m < taps.size() / 2; m++)
+      {
+        const uint16_t t0 = lrint (taps[2 * m] * tap_scale);
+        const uint16_t t1 = lrint (taps[2 * m + 1] * tap_scale);
+        for (uint l = 0; l < 8; l++)
+          pairs[m * 8 + l] = t0 | (uint32_t (t1) << 16);
+      }
+    scale = 1 / (FIXED_SAMPLE_SCALE * tap_scale);
+  }
+};
+#endif
+
+/* returns the layout for the coefficients, these are only created once per process
+ *
+ * The cache entries are never removed, so a layout may keep a reference to
+ * its coefficients (the key of its entry).
+ */
+template<class Layout> std::shared_ptr<const Layout>
+fir_shared_layout (const vector<double>& coeffs)
+{
+  static std::mutex                                               mutex;
+  static std::map<vector<double>, std::shared_ptr<const Layout>> cache;
+
+  std::lock_guard<std::mutex> lock (mutex);
+
+  auto entry = cache.emplace (coeffs, nullptr).first;
+  if (!entry->second)
+    entry->second = std::make_shared<const Layout> (entry->first);
+  return entry->second;
+}
+
+/*
+ * FIR filter history, stored in a buffer of four times the history size
+ *
+ * New values are appended to the history, and the start of the history moves
+ * forward through the buffer, so the history and the new values are always
+ * one contiguous block of memory. Only if the end of the buffer is reached, the
+ * history is copied to the start of the buffer. So unlike moving the history
+ * for each block, the average cost per block only depends on the number of new
+ * values, not on the filter order.
+ *
+ * Memory vs. speed: with a buffer of N times the history size, the history is
+ * copied once per (N - 2) * history_size new values. Three times the history
+ * size would be enough (one copy per history_size values), four times halves
+ * the copy cost per value, larger buffers mostly cost memory per instance.
+ */
+class FIRHistory {
+  AlignedArray<float> buffer;
+  const uint          history_size;
+  uint                pos = 0;    /* start of the history in the buffer */
+public:
+  FIRHistory (uint history_size) :
+    buffer (4 * history_size),
+    history_size (history_size)
+  {
+  }
+  /* returns the history, followed by space for up to history_size new values */
+  float *
+  data()
+  {
+    return buffer.begin() + pos;
+  }
+  /* after n new values have been written behind the history: drop the n oldest values */
+  void
+  advance (uint n)
+  {
+    pos += n;
+    if (pos + 2 * history_size > buffer.size())
+      {
+        std::copy (buffer.begin() + pos, buffer.begin() + pos + history_size, buffer.begin());
+        pos = 0;
+      }
+  }
+  void
+  reset()
+  {
+    std::fill (buffer.begin(), buffer.end(), 0.0f);
+    pos = 0;
+  }
+};
+
+/*
+ * FIR filter coefficients, prepared for the kernels of one instruction set
+ *
+ * The prepared taps never change after construction, so all FIR stages with
+ * the same coefficients and instruction set share one FIRTaps object (see
+ * fir_shared_taps()), and each stage only needs memory for its history. The
+ * double precision, fixed-point and ResamplerBank stages with the same filter
+ * request their own layouts for coeffs, see fir_shared_layout().
+ */
+struct FIRTaps
+{
+  const vector<double>& coeffs; /* the key of the cache entry, see fir_shared_taps() */
+  vector<float>         taps;
+  bool                  symmetric;
+  AlignedArray<float>   sse_taps;
+  AlignedArray<float>   avx_taps;
+  AlignedArray<float>   sym_taps;
+
+  FIRTaps (const vector<double>& init_taps, Resampler2::InstructionSet iset) :
+    coeffs (init_taps),
+    taps (init_taps.begin(), init_taps.end()),
+    symmetric (fir_taps_symmetric (taps)),
+    sse_taps (symmetric ? vector<float>() : fir_compute_sse_taps (taps)),
+    avx_taps (iset == Resampler2::ISET_AVX2 && !symmetric ? fir_compute_avx_taps (taps) : vector<float>()),
+    sym_taps (symmetric ? fir_compute_symmetric_taps (taps, iset == Resampler2::ISET_AVX2 ? 8 : 4) : vector<float>())
+  {
+  }
+};
+
+/* returns the prepared taps for the coefficients, these are only created once per process
+ * (the cache entries are never removed, FIRTaps keeps a reference to the key)
+ */
+template<Resampler2::InstructionSet ISET> std::shared_ptr<const FIRTaps>
+fir_shared_taps (const double *init_taps,
+                 uint          order)
+{
+  static std::mutex                                                mutex;
+  static std::map<vector<double>, std::shared_ptr<const FIRTaps>> cache;
+
+  const vector<double> coeffs (init_taps, init_taps + order);
+
+  std::lock_guard<std::mutex> lock (mutex);
+
+  auto entry = cache.emplace (coeffs, nullptr).first;
+  if (!entry->second)
+    entry->second = std::make_shared<const FIRTaps> (entry->first, ISET);
+  return entry->second;
+}
+
+/*
+ * Factor 2 upsampling of a data stream
+ *
+ * Template arguments:
+ *   ORDER     number of resampling filter coefficients
+ *   ISET      instruction set to use (ISET_FPU: no vectorized instructions)
+ */
+template<uint ORDER, Resampler2::InstructionSet ISET>
+class Resampler2::Upsampler2 final : public Resampler2::Impl {
+  static constexpr uint SYM_WIDTH = ISET == ISET_AVX2 ? 8 : 4;
+  static constexpr bool SHORT_TAPS = ORDER <= FIR_SHORT_ORDER;
+
+  const std::shared_ptr<const FIRTaps> fir_taps; /* shared by all stages with the same taps */
+  FIRHistory                           history;
+  float                                add_gain = 1; /* output gain for process_block_add() */
+protected:
+#ifdef PANDA_RESAMPLER_AVX2
+  /* store eight filtered values interleaved with the unfiltered values input[H]..input[H + 7] */
+  template<bool ADD> PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  store_8samples_avx (const float *input,
+                      __m256       fir_v,
+                      float       *output)
+  {
+    const uint H = (ORDER / 2); /* half the filter length */
+
+    const __m256 mid_v = _mm256_loadu_ps (&input[H]);
+
+    /* interleave: output[2 * i] = fir_v[i], output[2 * i + 1] = input[H + i] */
+    const __m256 lo_v = _mm256_unpacklo_ps (fir_v, mid_v);
+    const __m256 hi_v = _mm256_unpackhi_ps (fir_v, mid_v);
+    fir_store_8samples_avx<ADD> (&output[0], _mm256_permute2f128_ps (lo_v, hi_v, 0x20), add_gain);
+    fir_store_8samples_avx<ADD> (&output[8], _mm256_permute2f128_ps (lo_v, hi_v, 0x31), add_gain);
+  }
+  /* fast AVX2/FMA optimized convolution */
+  template<bool ADD, bool SYMMETRIC> PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  process_8samples_avx (const float *input,
+                        float       *output)
+  {
+    const __m256 fir_v = SYMMETRIC ? fir_process_8samples_symmetric_avx (input, &fir_taps->sym_taps[0], ORDER)
+                                   : fir_process_8samples_avx (input, &fir_taps->avx_taps[0], ORDER);
+    store_8samples_avx<ADD> (input, fir_v, output);
+  }
+  /* returns the number of input samples processed */
+  template<bool ADD> PANDA_RESAMPLER_TARGET_AVX2
+  uint
+  process_block_avx (const float *input,
+                     uint         n_input_samples,
+                     float       *output)
+  {
+    uint i = 0;
+    if (fir_taps->symmetric && SHORT_TAPS)
+      {
+        /* short filters: keep the taps in registers for the whole block, 16 samples per iteration */
+        __m256 taps_v[ORDER / 2];
+        for (uint t = 0; t < ORDER / 2; t++)
+          taps_v[t] = _mm256_load_ps (&fir_taps->sym_taps[t * SYM_WIDTH]);
+
+        while (i + 16 <= n_input_samples)
+          {
+            __m256 fir_v[2];
+            fir_process_16samples_symmetric_short_avx<ORDER> (&input[i], taps_v, fir_v);
+            store_8samples_avx<ADD> (&input[i], fir_v[0], &output[i * 2]);
+            store_8samples_avx<ADD> (&input[i + 8], fir_v[1], &output[i * 2 + 16]);
+            i += 16;
+          }
+      }
+    /* (i + 8) and (i + 14) -> for the same reason as in process_block_fir, with eight samples */
+    if (fir_taps->symmetric)
+      {
+        while (i + 8 <= n_input_samples)
+          {
+            process_8samples_avx<ADD, true> (&input[i], &output[i*2]);
+            i += 8;
+          }
+      }
+    else
+      {
+        while (i + 14 < n_input_samples)
+          {
+            process_8samples_avx<ADD, false> (&input[i], &output[i*2]);
+            i += 8;
+          }
+      }
+    return i;
+  }
+#endif
+  /* store four filtered values interleaved with the unfiltered values input[H]..input[H + 3] */
+  template<bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  store_4samples (const float    *input,
+                  const F4Vector &fir_v,
+                  float          *output)
+  {
+#ifdef PANDA_RESAMPLER_SIMD
+    const uint H = (ORDER / 2); /* half the filter length */
+
+    const __m128 mid_v = _mm_loadu_ps (&input[H]);
+    fir_store_4samples<ADD> (&output[0], _mm_unpacklo_ps (fir_v.v, mid_v), add_gain);
+    fir_store_4samples<ADD> (&output[4], _mm_unpackhi_ps (fir_v.v, mid_v), add_gain);
+#endif
+  }
+  /* fast SSE optimized convolution */
+  template<bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  process_4samples_scrambled (const float *input,
+                            float       *output)
+  {
+    F4Vector fir_v;
+    fir_process_4samples_sse (input, &fir_taps->sse_taps[0], ORDER, &fir_v);
+    store_4samples<ADD> (input, fir_v, output);
+  }
+  /* fast SSE optimized convolution for symmetric taps */
+  template<bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  process_4samples_symmetric (const float *input,
+                              float       *output)
+  {
+    F4Vector fir_v;
+    fir_process_4samples_symmetric_sse<SYM_WIDTH> (input, &fir_taps->sym_taps[0], ORDER, &fir_v);
+    store_4samples<ADD> (input, fir_v, output);
+  }
+  /* short symmetric filters: keep the taps in registers for the whole block, returns the number of input samples processed */
+  template<bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  uint
+  process_block_short (const float *input,
+                       uint         n_input_samples,
+                       float       *output)
+  {
+    uint i = 0;
+#ifdef PANDA_RESAMPLER_SIMD
+    F4Vector taps_v[ORDER / 2];
+    for (uint t = 0; t < ORDER / 2; t++)
+      taps_v[t].v = _mm_loadu_ps (&fir_taps->sym_taps[t * SYM_WIDTH]);
+
+    /* the last iteration reads input[i + ORDER + 6], see process_block_fir */
+    while (i + 8 <= n_input_samples)
+      {
+        F4Vector fir_v[2];
+        fir_process_8samples_symmetric_short_sse<ORDER> (&input[i], taps_v, fir_v);
+        store_4samples<ADD> (&input[i], fir_v[0], &output[i * 2]);
+        store_4samples<ADD> (&input[i + 4], fir_v[1], &output[i * 2 + 8]);
+        i += 8;
+      }
+#endif
+    return i;
+  }
+  /* slow convolution */
+  template<bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  process_sample_unaligned (const float *input,
+                            float       *output)
+  {
+    const uint H = (ORDER / 2); /* half the filter length */
+    fir_store_sample<ADD> (&output[0], fir_process_one_sample<float> (&input[0], &fir_taps->taps[0], ORDER), add_gain);
+    fir_store_sample<ADD> (&output[1], input[H], add_gain);
+  }
+  /* process the last (at most four) samples of a block with the SIMD kernels */
+  template<bool ADD>
+  void
+  process_tail (const float *input,
+                uint         n_input_samples,
+                float       *output)
+  {
+#ifdef PANDA_RESAMPLER_SIMD
+    const uint H = (ORDER / 2); /* half the filter length */
+
+    /* the kernels would read beyond the end of the input data, so we use a
+     * zero padded copy (fir_process_4samples_sse reads up to ORDER + 6 values)
+     */
+    F4Vector  padded[(ORDER + 9) / 4];
+    float    *padded_input = &padded[0].f[0];
+    const uint n_values = n_input_samples + ORDER - 1;
+
+    std::fill (std::copy (input, input + n_values, padded_input), padded_input + (ORDER + 9) / 4 * 4, 0.0f);
+
+    F4Vector fir_v;
+    if (fir_taps->symmetric && ORDER >= 4) /* ORDER >= 4: see fir_taps_symmetric */
+      fir_process_4samples_symmetric_sse<SYM_WIDTH> (padded_input, &fir_taps->sym_taps[0], ORDER, &fir_v);
+    else
+      fir_process_4samples_sse (padded_input, &fir_taps->sse_taps[0], ORDER, &fir_v);
+
+    for (uint i = 0; i < n_input_samples; i++)
+      {
+        fir_store_sample<ADD> (&output[2 * i], fir_v.f[i], add_gain);
+        fir_store_sample<ADD> (&output[2 * i + 1], input[H + i], add_gain);
+      }
+#endif
+  }
+  template<bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  process_block_fir (const float *input,
+                     uint         n_input_samples,
+                     float       *output)
+  {
+    uint i = 0;
+#ifdef PANDA_RESAMPLER_AVX2
+    if (ISET == ISET_AVX2)
+      i = process_block_avx<ADD> (input, n_input_samples, output);
+#endif
+    if (ISET != ISET_FPU)
+      {
+        if (fir_taps->symmetric && SHORT_TAPS)
+          i += process_block_short<ADD> (&input[i], n_input_samples - i, &output[i * 2]);
+
+        /* need to take into account that the filter needs to access some
+         * samples after the end of the input data: the symmetric kernel reads
+         * up to input[i + ORDER + 2], the scrambled kernel up to input[i + ORDER + 5]
+         */
+        if (fir_taps->symmetric)
+          {
+            while (i + 4 <= n_input_samples)
+              {
+                process_4samples_symmetric<ADD> (&input[i], &output[i*2]);
+                i += 4;
+              }
+          }
+        else
+          {
+            while (i + 6 < n_input_samples)
+              {
+                process_4samples_scrambled<ADD> (&input[i], &output[i*2]);
+                i += 4;
+              }
+          }
+        /* a single sample is computed faster without copying the input */
+        while (i + 1 < n_input_samples)
+          {
+            const uint todo = min (n_input_samples - i, 4u);
+
+            process_tail<ADD> (&input[i], todo, &output[i*2]);
+            i += todo;
+          }
+      }
+    while (i < n_input_samples)
+      {
+	process_sample_unaligned<ADD> (&input[i], &output[2*i]);
+	i++;
+      }
+  }
+  template<bool ADD>
+  void
+  process_block_history (const float *input,
+                         uint         n_input_samples,
+                         float       *output)
+  {
+    const uint history_todo = min (n_input_samples, ORDER - 1);
+
+    copy (input, input + history_todo, history.data() + ORDER - 1);
+    process_block_fir<ADD> (history.data(), history_todo, output);
+    if (n_input_samples > history_todo)
+      {
+	process_block_fir<ADD> (input, n_input_samples - history_todo, &output [2 * history_todo]);
+
+	// build new history from new input (here: history_todo == ORDER - 1)
+	copy (input + n_input_samples - history_todo, input + n_input_samples, history.data() + ORDER - 1);
+      }
+    history.advance (history_todo);
+  }
+public:
+  /*
+   * Constructs an Upsampler2 object with a given set of filter coefficients.
+   *
+   * init_taps: coefficients for the upsampling FIR halfband filter
+   *
+   * If the coefficients are symmetric, the (faster) symmetric FIR kernels are used.
+   */
+  Upsampler2 (const double *init_taps) :
+    fir_taps (fir_shared_taps<ISET> (init_taps, ORDER)),
+    history (ORDER - 1)
+  {
+    PANDA_RESAMPLER_CHECK ((ORDER & 1) == 0);    /* even order filter */
+  }
+  /*
+   * The function process_block() takes a block of input samples and produces a
+   * block with twice the length, containing interpolated output samples.
+   */
+  void
+  process_block (const float *input,
+                 uint         n_input_samples,
+		 float       *output) override
+  {
+    process_block_history<false> (input, n_input_samples, output);
+  }
+  /*
+   * Like process_block(), but adds the interpolated output samples multiplied
+   * by gain to the output block.
+   */
+  bool
+  process_block_add (const float *input,
+                     uint         n_input_samples,
+                     float       *output,
+                     float        gain) override
+  {
+    add_gain = gain;
+    process_block_history<true> (input, n_input_samples, output);
+    return true;
+  }
+  /*
+   * Returns the FIR filter order.
+   */
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return order() - 1;
+  }
+  void
+  reset() override
+  {
+    history.reset();
+  }
+  ResamplerBankStage *
+  create_bank_stage (uint n_groups, bool avx) const override
+  {
+    /* the bank only implements symmetric FIR filters */
+    return fir_taps_symmetric (fir_taps->taps, 2) ? create_bank_fir_upsampler2<ORDER> (fir_taps->coeffs, n_groups, avx) : nullptr;
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    /* the double precision kernels only implement symmetric FIR filters */
+    return fir_taps_symmetric (fir_taps->taps, 2) ? new DoubleFIRUpsampler2<ORDER> (fir_taps->coeffs, ISET) : nullptr;
+  }
+#ifdef PANDA_RESAMPLER_SSE2
+  /* creates a 16 bit fixed-point stage for the coefficients, see create_impl_with_coeffs() */
+  static Impl *
+  create_fixed (const double *init_taps, InstructionSet iset)
+  {
+    return new FixedFIRUpsampler2<ORDER> (vector<double> (init_taps, init_taps + ORDER), iset);
+  }
+#endif
+  Impl *
+  create_two_channel_stage() const override
+  {
+#ifdef PANDA_RESAMPLER_SIMD
+    /* the two channel kernels only implement symmetric FIR filters */
+    if (ISET != ISET_FPU && fir_taps->symmetric)
+      return new Upsampler2x2<ORDER, ISET> (fir_taps);
+#endif
+    return nullptr;
+  }
+  bool
+  sse_enabled() const override
+  {
+    return ISET != ISET_FPU;
+  }
+};
+
+/*
+ * Factor 2 downsampling of a data stream
+ *
+ * Template arguments:
+ *   ORDER    number of resampling filter coefficients
+ *   ISET     instruction set to use (ISET_FPU: no vectorized instructions)
+ */
+template<uint ORDER, Resampler2::InstructionSet ISET>
+class Resampler2::Downsampler2 final : public Resampler2::Impl {
+  static constexpr uint SYM_WIDTH = ISET == ISET_AVX2 ? 8 : 4;
+  static constexpr bool SHORT_TAPS = ORDER <= FIR_SHORT_ORDER;
+
+  const std::shared_ptr<const FIRTaps> fir_taps; /* shared by all stages with the same taps */
+  FIRHistory                           history;      /* interleaved history (ISET_FPU) */
+  FIRHistory                           history_even; /* deinterleaved history (SIMD) */
+  FIRHistory                           history_odd;
+  float                                add_gain = 1; /* output gain for process_block_add() */
+  float                               *scratch = nullptr; /* see set_scratch() */
+  uint                                 scratch_size = 0;
+#ifdef PANDA_RESAMPLER_AVX2
+  /* add 0.5 * input_odd[H]..input_odd[H + 7] to eight filtered values and store them */
+  template<int ODD_STEPPING, bool ADD> PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  store_8samples_avx (const float *input_odd,
+                      __m256       fir_v,
+                      float       *output)
+  {
+    const uint H = (ORDER / 2) - 1; /* half the filter length */
+
+    __m256 odd_v;
+    if (ODD_STEPPING == 1)
+      {
+        odd_v = _mm256_loadu_ps (&input_odd[H]);
+      }
+    else
+      {
+        /* pick every other value from 16 consecutive floats */
+        const __m256 a_v = _mm256_loadu_ps (&input_odd[H * ODD_STEPPING]);
+        const __m256 b_v = _mm256_loadu_ps (&input_odd[H * ODD_STEPPING + 8]);
+        const __m256 ab_v = _mm256_shuffle_ps (a_v, b_v, _MM_SHUFFLE (2, 0, 2, 0));
+        odd_v = _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (ab_v), _MM_SHUFFLE (3, 1, 2, 0)));
+      }
+    fir_store_8samples_avx<ADD> (output, _mm256_fmadd_ps (odd_v, _mm256_set1_ps (0.5f), fir_v), add_gain);
+  }
+  /* fast AVX2/FMA optimized convolution */
+  template<int ODD_STEPPING, bool ADD, bool SYMMETRIC> PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  process_8samples_avx (const float *input_even,
+                        const float *input_odd,
+                        float       *output)
+  {
+    const __m256 fir_v = SYMMETRIC ? fir_process_8samples_symmetric_avx (input_even, &fir_taps->sym_taps[0], ORDER)
+                                   : fir_process_8samples_avx (input_even, &fir_taps->avx_taps[0], ORDER);
+    store_8samples_avx<ODD_STEPPING, ADD> (input_odd, fir_v, output);
+  }
+  /* returns the number of output samples computed */
+  template<int ODD_STEPPING, bool ADD> PANDA_RESAMPLER_TARGET_AVX2
+  uint
+  process_block_avx (const float *input_even,
+                     const float *input_odd,
+                     float       *output,
+                     uint         n_output_samples)
+  {
+    uint i = 0;
+    if (fir_taps->symmetric && SHORT_TAPS)
+      {
+        /* short filters: keep the taps in registers for the whole block, 16 samples per iteration */
+        __m256 taps_v[ORDER / 2];
+        for (uint t = 0; t < ORDER / 2; t++)
+          taps_v[t] = _mm256_load_ps (&fir_taps->sym_taps[t * SYM_WIDTH]);
+
+        while (i + 16 <= n_output_samples)
+          {
+            __m256 fir_v[2];
+            fir_process_16samples_symmetric_short_avx<ORDER> (&input_even[i], taps_v, fir_v);
+            store_8samples_avx<ODD_STEPPING, ADD> (&input_odd[i * ODD_STEPPING], fir_v[0], &output[i]);
+            store_8samples_avx<ODD_STEPPING, ADD> (&input_odd[(i + 8) * ODD_STEPPING], fir_v[1], &output[i + 8]);
+            i += 16;
+          }
+      }
+    /* (i + 8) and (i + 14) -> for the same reason as in process_block_fir, with eight samples */
+    if (fir_taps->symmetric)
+      {
+        while (i + 8 <= n_output_samples)
+          {
+            process_8samples_avx<ODD_STEPPING, ADD, true> (&input_even[i], &input_odd[i * ODD_STEPPING], &output[i]);
+            i += 8;
+          }
+      }
+    else
+      {
+        while (i + 14 < n_output_samples)
+          {
+            process_8samples_avx<ODD_STEPPING, ADD, false> (&input_even[i], &input_odd[i * ODD_STEPPING], &output[i]);
+            i += 8;
+          }
+      }
+    return i;
+  }
+#endif
+  /* add 0.5 * input_odd[H]..input_odd[H + 3] to four filtered values and store them */
+  template<int ODD_STEPPING, bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  store_4samples (const float    *input_odd,
+                  const F4Vector &fir_v,
+                  float          *output)
+  {
+#ifdef PANDA_RESAMPLER_SIMD
+    const uint H = (ORDER / 2) - 1; /* half the filter length */
+
+    __m128 odd_v;
+    if (ODD_STEPPING == 1)
+      {
+        odd_v = _mm_loadu_ps (&input_odd[H]);
+      }
+    else
+      {
+        /* pick every other value from 8 consecutive floats */
+        const __m128 a_v = _mm_loadu_ps (&input_odd[H * ODD_STEPPING]);
+        const __m128 b_v = _mm_loadu_ps (&input_odd[H * ODD_STEPPING + 4]);
+        odd_v = _mm_unpacklo_ps (_mm_unpacklo_ps (a_v, b_v), _mm_unpackhi_ps (a_v, b_v));
+      }
+    fir_store_4samples<ADD> (output, _mm_add_ps (fir_v.v, _mm_mul_ps (odd_v, _mm_set1_ps (0.5f))), add_gain);
+#endif
+  }
+  /* fast SSE optimized convolution */
+  template<int ODD_STEPPING, bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  process_4samples_scrambled (const float *input_even,
+                            const float *input_odd,
+			    float       *output)
+  {
+    F4Vector fir_v;
+    fir_process_4samples_sse (input_even, &fir_taps->sse_taps[0], ORDER, &fir_v);
+    store_4samples<ODD_STEPPING, ADD> (input_odd, fir_v, output);
+  }
+  /* fast SSE optimized convolution for symmetric taps */
+  template<int ODD_STEPPING, bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  process_4samples_symmetric (const float *input_even,
+                              const float *input_odd,
+                              float       *output)
+  {
+    F4Vector fir_v;
+    fir_process_4samples_symmetric_sse<SYM_WIDTH> (input_even, &fir_taps->sym_taps[0], ORDER, &fir_v);
+    store_4samples<ODD_STEPPING, ADD> (input_odd, fir_v, output);
+  }
+  /* short symmetric filters: keep the taps in registers for the whole block, returns the number of output samples computed */
+  template<int ODD_STEPPING, bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  uint
+  process_block_short (const float *input_even,
+                       const float *input_odd,
+                       float       *output,
+                       uint         n_output_samples)
+  {
+    uint i = 0;
+#ifdef PANDA_RESAMPLER_SIMD
+    F4Vector taps_v[ORDER / 2];
+    for (uint t = 0; t < ORDER / 2; t++)
+      taps_v[t].v = _mm_loadu_ps (&fir_taps->sym_taps[t * SYM_WIDTH]);
+
+    /* the last iteration reads input_even[i + ORDER + 6], see process_block_fir */
+    while (i + 8 <= n_output_samples)
+      {
+        F4Vector fir_v[2];
+        fir_process_8samples_symmetric_short_sse<ORDER> (&input_even[i], taps_v, fir_v);
+        store_4samples<ODD_STEPPING, ADD> (&input_odd[i * ODD_STEPPING], fir_v[0], &output[i]);
+        store_4samples<ODD_STEPPING, ADD> (&input_odd[(i + 4) * ODD_STEPPING], fir_v[1], &output[i + 4]);
+        i += 8;
+      }
+#endif
+    return i;
+  }
+  /* slow convolution */
+  template<int ODD_STEPPING> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  float
+  process_sample_unaligned (const float *input_even,
+                            const float *input_odd)
+  {
+    const uint H = (ORDER / 2) - 1; /* half the filter length */
+
+    return fir_process_one_sample<float> (&input_even[0], &fir_taps->taps[0], ORDER) + 0.5f * input_odd[H * ODD_STEPPING];
+  }
+  /* process the last (at most four) samples of a block with the SIMD kernels */
+  template<int ODD_STEPPING, bool ADD>
+  void
+  process_tail (const float *input_even,
+                const float *input_odd,
+                float       *output,
+                uint         n_output_samples)
+  {
+#ifdef PANDA_RESAMPLER_SIMD
+    const uint H = (ORDER / 2) - 1; /* half the filter length */
+
+    /* the kernels would read beyond the end of the input data, so we use a
+     * zero padded copy (fir_process_4samples_sse reads up to ORDER + 6 values)
+     */
+    F4Vector  padded[(ORDER + 9) / 4];
+    float    *padded_input = &padded[0].f[0];
+    const uint n_values = n_output_samples + ORDER - 1;
+
+    std::fill (std::copy (input_even, input_even + n_values, padded_input), padded_input + (ORDER + 9) / 4 * 4, 0.0f);
+
+    F4Vector fir_v;
+    if (fir_taps->symmetric && ORDER >= 4) /* ORDER >= 4: see fir_taps_symmetric */
+      fir_process_4samples_symmetric_sse<SYM_WIDTH> (padded_input, &fir_taps->sym_taps[0], ORDER, &fir_v);
+    else
+      fir_process_4samples_sse (padded_input, &fir_taps->sse_taps[0], ORDER, &fir_v);
+
+    for (uint i = 0; i < n_output_samples; i++)
+      fir_store_sample<ADD> (&output[i], fir_v.f[i] + 0.5f * input_odd[(H + i) * ODD_STEPPING], add_gain);
+#endif
+  }
+  template<int ODD_STEPPING, bool ADD> PANDA_RESAMPLER_FN_ALWAYS_INLINE
+  void
+  process_block_fir (const float *input_even,
+                     const float *input_odd,
+                     float       *output,
+                     uint         n_output_samples)
+  {
+    uint i = 0;
+#ifdef PANDA_RESAMPLER_AVX2
+    if (ISET == ISET_AVX2)
+      i = process_block_avx<ODD_STEPPING, ADD> (input_even, input_odd, output, n_output_samples);
+#endif
+    if (ISET != ISET_FPU)
+      {
+        if (fir_taps->symmetric && SHORT_TAPS)
+          i += process_block_short<ODD_STEPPING, ADD> (&input_even[i], &input_odd[i * ODD_STEPPING], &output[i], n_output_samples - i);
+
+        /* (i + 4) and (i + 6) -> for the same reason as in Upsampler2::process_block_fir */
+        if (fir_taps->symmetric)
+          {
+            while (i + 4 <= n_output_samples)
+              {
+                process_4samples_symmetric<ODD_STEPPING, ADD> (&input_even[i], &input_odd[i * ODD_STEPPING], &output[i]);
+                i += 4;
+              }
+          }
+        else
+          {
+            while (i + 6 < n_output_samples)
+              {
+                process_4samples_scrambled<ODD_STEPPING, ADD> (&input_even[i], &input_odd[i * ODD_STEPPING], &output[i]);
+                i += 4;
+              }
+          }
+        /* a single sample is computed faster without copying the input */
+        while (i + 1 < n_output_samples)
+          {
+            const uint todo = min (n_output_samples - i, 4u);
+
+            process_tail<ODD_STEPPING, ADD> (&input_even[i], &input_odd[i * ODD_STEPPING], &output[i], todo);
+            i += todo;
+          }
+      }
+    while (i < n_output_samples)
+      {
+	fir_store_sample<ADD> (&output[i], process_sample_unaligned<ODD_STEPPING> (&input_even[i], &input_odd[i * ODD_STEPPING]), add_gain);
+	i++;
+      }
+  }
+  /* slow convolution of interleaved input, without SIMD no deinterleaving is necessary */
+  template<bool ADD>
+  void
+  process_block_interleaved (const float *input,
+                             float       *output,
+                             uint         n_output_samples)
+  {
+    const uint H = (ORDER / 2) - 1; /* half the filter length */
+
+    for (uint i = 0; i < n_output_samples; i++)
+      fir_store_sample<ADD> (&output[i], fir_process_one_sample<float, 2> (&input[2 * i], &fir_taps->taps[0], ORDER) + 0.5f * input[(H + i) * 2 + 1], add_gain);
+  }
+  /* copies the even values of the data, the SIMD code splits even and odd values with shuffles */
+  void
+  deinterleave2 (const float *data,
+                 uint         n_data_values,
+		 float       *output)
+  {
+    uint i = 0;
+#ifdef PANDA_RESAMPLER_SIMD
+    /* (i + 8 < n_data_values): data[n_data_values - 1] may be beyond the end of the input if data points to odd values */
+    while (i + 8 < n_data_values)
+      {
+        _mm_storeu_ps (&output[i / 2], _mm_shuffle_ps (_mm_loadu_ps (&data[i]), _mm_loadu_ps (&data[i + 4]), _MM_SHUFFLE (2, 0, 2, 0)));
+        i += 8;
+      }
+#endif
+    while (i < n_data_values)
+      {
+        output[i / 2] = data[i];
+        i += 2;
+      }
+  }
+  template<bool ADD>
+  void
+  process_block_history (const float *input,
+                         uint         n_input_samples,
+                         float       *output)
+  {
+    if (!PANDA_RESAMPLER_CHECK ((n_input_samples & 1) == 0))
+      return;
+
+    if (ISET == ISET_FPU)
+      process_block_fpu<ADD> (input, n_input_samples, output);
+    else if (scratch)
+      process_block_even<ADD> (input, n_input_samples, output, scratch, scratch_size);
+    else
+      process_block_stack<ADD> (input, n_input_samples, output);
+  }
+  /* the FPU code processes the interleaved input (and history) directly, so no deinterleaving is necessary */
+  template<bool ADD>
+  void
+  process_block_fpu (const float *input,
+                     uint         n_input_samples,
+                     float       *output)
+  {
+    const uint n_output_samples = n_input_samples / 2;
+    const uint history_todo = min (n_output_samples, ORDER - 1);
+
+    copy (input, input + history_todo * 2, history.data() + (ORDER - 1) * 2);
+    process_block_interleaved<ADD> (history.data(), output, history_todo);
+    if (n_output_samples > history_todo)
+      {
+        process_block_interleaved<ADD> (input, &output[history_todo], n_output_samples - history_todo);
+
+        // build new history from new input (here: history_todo == ORDER - 1)
+        copy (input + n_input_samples - history_todo * 2, input + n_input_samples, history.data() + (ORDER - 1) * 2);
+      }
+    history.advance (history_todo * 2);
+  }
+  /* not inlined: the stack memory is only used if there is no scratch memory */
+  template<bool ADD> PANDA_RESAMPLER_FN_NOINLINE
+  void
+  process_block_stack (const float *input,
+                       uint         n_input_samples,
+                       float       *output)
+  {
+    const uint BLOCKSIZE = 1024;
+
+    F4Vector  block[BLOCKSIZE / 4]; /* using F4Vector ensures 16-byte alignment */
+
+    process_block_even<ADD> (input, n_input_samples, output, &block[0].f[0], BLOCKSIZE);
+  }
+  /* input_even: 16-byte aligned memory for block_size deinterleaved (even) input samples */
+  template<bool ADD>
+  void
+  process_block_even (const float *input,
+                      uint         n_input_samples,
+                      float       *output,
+                      float       *input_even,
+                      uint         block_size)
+  {
+    while (n_input_samples)
+      {
+	uint n_input_todo = min (n_input_samples, block_size * 2);
+
+        /* since the halfband filter contains zeros every other sample
+	 * and since we're using SSE instructions, which expect the
+	 * data to be consecutively represented in memory, we prepare
+	 * a block of samples containing only even-indexed samples
+	 *
+	 * we keep the deinterleaved data on the stack or in the scratch memory
+	 * of the resampler (instead of per-class allocated memory), to ensure
+	 * that even running a lot of these downsampler streams will not result
+	 * in cache trashing
+	 *
+	 * the odd samples are read from the input (with shuffles that pick
+	 * every other value), so only the even samples need to be copied
+	 */
+	deinterleave2 (input, n_input_todo, input_even);
+
+	const float       *input_odd = input + 1; /* we process this one with a stepping of 2 */
+
+	const uint n_output_todo = n_input_todo / 2;
+	const uint history_todo = min (n_output_todo, ORDER - 1);
+
+	copy (input_even, input_even + history_todo, history_even.data() + ORDER - 1);
+	deinterleave2 (input_odd, history_todo * 2, history_odd.data() + ORDER - 1);
+
+	process_block_fir<1, ADD> (history_even.data(), history_odd.data(), output, history_todo);
+	if (n_output_todo > history_todo)
+	  {
+	    process_block_fir<2, ADD> (input_even, input_odd, &output[history_todo], n_output_todo - history_todo);
+
+	    // build new history from new input (here: history_todo == ORDER - 1)
+	    copy (input_even + n_output_todo - history_todo, input_even + n_output_todo, history_even.data() + ORDER - 1);
+	    deinterleave2 (input_odd + n_input_todo - history_todo * 2, history_todo * 2, history_odd.data() + ORDER - 1);
+	  }
+	history_even.advance (history_todo);
+	history_odd.advance (history_todo);
+
+	n_input_samples -= n_input_todo;
+	input += n_input_todo;
+	output += n_output_todo;
+      }
+  }
+public:
+  /*
+   * Constructs a Downsampler2 class using a given set of filter coefficients.
+   *
+   * init_taps: coefficients for the downsampling FIR halfband filter
+   *
+   * If the coefficients are symmetric, the (faster) symmetric FIR kernels are used.
+   */
+  Downsampler2 (const double *init_taps) :
+    fir_taps (fir_shared_taps<ISET> (init_taps, ORDER)),
+    history (ISET == ISET_FPU ? (ORDER - 1) * 2 : 0),
+    history_even (ISET == ISET_FPU ? 0 : ORDER - 1),
+    history_odd (ISET == ISET_FPU ? 0 : ORDER - 1)
+  {
+    PANDA_RESAMPLER_CHECK ((ORDER & 1) == 0);    /* even order filter */
+  }
+  /*
+   * The function process_block() takes a block of input samples and produces
+   * a block with half the length, containing downsampled output samples.
+   */
+  void
+  process_block (const float *input,
+                 uint         n_input_samples,
+		 float       *output) override
+  {
+    process_block_history<false> (input, n_input_samples, output);
+  }
+  /*
+   * Like process_block(), but adds the downsampled output samples multiplied
+   * by gain to the output block.
+   */
+  bool
+  process_block_add (const float *input,
+                     uint         n_input_samples,
+                     float       *output,
+                     float        gain) override
+  {
+    add_gain = gain;
+    process_block_history<true> (input, n_input_samples, output);
+    return true;
+  }
+  /*
+   * Returns the filter order.
+   */
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return order() / 2 - 0.5;
+  }
+  void
+  reset() override
+  {
+    history.reset();
+    history_even.reset();
+    history_odd.reset();
+  }
+  void
+  set_scratch (float *new_scratch, uint n_floats) override
+  {
+    scratch = n_floats ? new_scratch : nullptr;
+    scratch_size = n_floats;
+  }
+  ResamplerBankStage *
+  create_bank_stage (uint n_groups, bool avx) const override
+  {
+    /* the bank only implements symmetric FIR filters */
+    return fir_taps_symmetric (fir_taps->taps, 2) ? create_bank_fir_downsampler2<ORDER> (fir_taps->coeffs, n_groups, avx) : nullptr;
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    /* the double precision kernels only implement symmetric FIR filters */
+    return fir_taps_symmetric (fir_taps->taps, 2) ? new DoubleFIRDownsampler2<ORDER> (fir_taps->coeffs, ISET) : nullptr;
+  }
+#ifdef PANDA_RESAMPLER_SSE2
+  /* creates a 16 bit fixed-point stage for the coefficients, see create_impl_with_coeffs() */
+  static Impl *
+  create_fixed (const double *init_taps, InstructionSet iset)
+  {
+    return new FixedFIRDownsampler2<ORDER> (vector<double> (init_taps, init_taps + ORDER), iset);
+  }
+#endif
+  Impl *
+  create_two_channel_stage() const override
+  {
+#ifdef PANDA_RESAMPLER_SIMD
+    /* the two channel kernels only implement symmetric FIR filters */
+    if (ISET != ISET_FPU && fir_taps->symmetric)
+      return new Downsampler2x2<ORDER, ISET> (fir_taps);
+#endif
+    return nullptr;
+  }
+  bool
+  sse_enabled() const override
+  {
+    return ISET != ISET_FPU;
+  }
+};
+
+#ifdef PANDA_RESAMPLER_SIMD
+/*
+ * Factor 2 upsampling of two interleaved channels (stereo or complex I/Q
+ * samples), frame i consists of input[2 * i] and input[2 * i + 1]
+ *
+ * Both channels are filtered with the same taps in one SIMD pass (the symmetric
+ * FIR kernels with STRIDE 2), so the data doesn't need to be deinterleaved.
+ *
+ * Template arguments:
+ *   ORDER     number of resampling filter coefficients (symmetric taps, ORDER >= 4)
+ *   ISET      instruction set to use
+ */
+template<uint ORDER, Resampler2::InstructionSet ISET>
+class Resampler2::Upsampler2x2 final : public Resampler2::Impl {
+  static constexpr uint SYM_WIDTH = ISET == ISET_AVX2 ? 8 : 4;
+
+  const std::shared_ptr<const FIRTaps> fir_taps; /* shared with the mono stage, see Upsampler2 */
+  FIRHistory                           history;
+#ifdef PANDA_RESAMPLER_AVX2
+  /* returns the number of input frames processed */
+  PANDA_RESAMPLER_TARGET_AVX2
+  uint
+  process_block_avx (const float *input,
+                     uint         n_input_frames,
+                     float       *output)
+  {
+    const uint H = (ORDER / 2); /* half the filter length */
+
+    uint i = 0;
+    while (i + 4 <= n_input_frames)
+      {
+        /* one frame (two floats) is one double, so frames can be shuffled using the pd instructions */
+        const __m256d fir_v = _mm256_castps_pd (fir_process_8samples_symmetric_avx<2> (&input[i * 2], &fir_taps->sym_taps[0], ORDER));
+        const __m256d mid_v = _mm256_castps_pd (_mm256_loadu_ps (&input[(i + H) * 2]));
+
+        /* interleave: output frame 2 * k = fir frame k, output frame 2 * k + 1 = input frame H + k */
+        const __m256d lo_v = _mm256_unpacklo_pd (fir_v, mid_v);
+        const __m256d hi_v = _mm256_unpackhi_pd (fir_v, mid_v);
+        _mm256_storeu_ps (&output[i * 4], _mm256_castpd_ps (_mm256_permute2f128_pd (lo_v, hi_v, 0x20)));
+        _mm256_storeu_ps (&output[i * 4 + 8], _mm256_castpd_ps (_mm256_permute2f128_pd (lo_v, hi_v, 0x31)));
+        i += 4;
+      }
+    return i;
+  }
+#endif
+  void
+  process_block_fir (const float *input,
+                     uint         n_input_frames,
+                     float       *output)
+  {
+    const uint H = (ORDER / 2); /* half the filter length */
+
+    uint i = 0;
+#ifdef PANDA_RESAMPLER_AVX2
+    if (ISET == ISET_AVX2)
+      i = process_block_avx (input, n_input_frames, output);
+#endif
+    while (i + 2 <= n_input_frames)
+      {
+        F4Vector fir_v;
+        fir_process_4samples_symmetric_sse<SYM_WIDTH, 2> (&input[i * 2], &fir_taps->sym_taps[0], ORDER, &fir_v);
+
+        const __m128 mid_v = _mm_loadu_ps (&input[(i + H) * 2]);
+        _mm_storeu_ps (&output[i * 4], _mm_movelh_ps (fir_v.v, mid_v));
+        _mm_storeu_ps (&output[i * 4 + 4], _mm_movehl_ps (mid_v, fir_v.v));
+        i += 2;
+      }
+    while (i < n_input_frames)
+      {
+        output[i * 4]     = fir_process_one_sample<float, 2> (&input[i * 2], &fir_taps->taps[0], ORDER);
+        output[i * 4 + 1] = fir_process_one_sample<float, 2> (&input[i * 2 + 1], &fir_taps->taps[0], ORDER);
+        output[i * 4 + 2] = input[(i + H) * 2];
+        output[i * 4 + 3] = input[(i + H) * 2 + 1];
+        i++;
+      }
+  }
+public:
+  Upsampler2x2 (const std::shared_ptr<const FIRTaps>& init_taps) :
+    fir_taps (init_taps),
+    history ((ORDER - 1) * 2)
+  {
+    PANDA_RESAMPLER_CHECK (fir_taps->symmetric && fir_taps->taps.size() == ORDER);
+  }
+  void
+  process_block (const float *, uint, float *) override
+  {
+    PANDA_RESAMPLER_CHECK (false); // only planar multi-channel processing is supported
+  }
+  void
+  process_block_planar (const float * const *input, uint n_input_samples, float * const *output) override
+  {
+    /* interleave small blocks (which stay in cache) */
+    const uint block_size = 128;
+
+    alignas (32) float in[block_size * 2];
+    alignas (32) float out[block_size * 4];
+
+    const float *in_l = input[0], *in_r = input[1];
+    float *out_l = output[0], *out_r = output[1];
+
+    uint pos = 0;
+    while (pos < n_input_samples)
+      {
+        const uint n_todo = min (block_size, n_input_samples - pos);
+        for (uint i = 0; i < n_todo; i++)
+          {
+            in[i * 2]     = in_l[pos + i];
+            in[i * 2 + 1] = in_r[pos + i];
+          }
+        process_block_interleaved (in, n_todo, out);
+        for (uint i = 0; i < n_todo * 2; i++)
+          {
+            out_l[pos * 2 + i] = out[i * 2];
+            out_r[pos * 2 + i] = out[i * 2 + 1];
+          }
+        pos += n_todo;
+      }
+  }
+  void
+  process_block_interleaved (const float *input, uint n_input_frames, float *output) override
+  {
+    const uint history_todo = min (n_input_frames, ORDER - 1);
+
+    copy (input, input + history_todo * 2, history.data() + (ORDER - 1) * 2);
+    process_block_fir (history.data(), history_todo, output);
+    if (n_input_frames > history_todo)
+      {
+        process_block_fir (input, n_input_frames - history_todo, &output[history_todo * 4]);
+
+        // build new history from new input (here: history_todo == ORDER - 1)
+        copy (input + (n_input_frames - history_todo) * 2, input + n_input_frames * 2, history.data() + (ORDER - 1) * 2);
+      }
+    history.advance (history_todo * 2);
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return order() - 1;
+  }
+  void
+  reset() override
+  {
+    history.reset();
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+
+/*
+ * Factor 2 downsampling of two interleaved channels (stereo or complex I/Q
+ * samples), frame i consists of input[2 * i] and input[2 * i + 1]
+ *
+ * Both channels are filtered with the same taps in one SIMD pass, see
+ * Upsampler2x2.
+ */
+template<uint ORDER, Resampler2::InstructionSet ISET>
+class Resampler2::Downsampler2x2 final : public Resampler2::Impl {
+  static constexpr uint SYM_WIDTH = ISET == ISET_AVX2 ? 8 : 4;
+
+  const std::shared_ptr<const FIRTaps> fir_taps; /* shared with the mono stage, see Downsampler2 */
+  FIRHistory                           history_even;
+  FIRHistory                           history_odd;
+#ifdef PANDA_RESAMPLER_AVX2
+  /* returns the number of output frames computed */
+  template<int ODD_STEPPING> PANDA_RESAMPLER_TARGET_AVX2
+  uint
+  process_block_avx (const float *input_even,
+                     const float *input_odd,
+                     float       *output,
+                     uint         n_output_frames)
+  {
+    const uint H = (ORDER / 2) - 1; /* half the filter length */
+
+    uint i = 0;
+    while (i + 4 <= n_output_frames)
+      {
+        const __m256 fir_v = fir_process_8samples_symmetric_avx<2> (&input_even[i * 2], &fir_taps->sym_taps[0], ORDER);
+
+        __m256 odd_v;
+        if (ODD_STEPPING == 1)
+          {
+            odd_v = _mm256_loadu_ps (&input_odd[(H + i) * 2]);
+          }
+        else
+          {
+            /* pick every other frame (one frame = one double): a = o0 e1 o1 e2, b = e2 o2 e3 o3 */
+            const __m256d a_v = _mm256_castps_pd (_mm256_loadu_ps (&input_odd[(H + i) * 4]));
+            const __m256d b_v = _mm256_castps_pd (_mm256_loadu_ps (&input_odd[(H + i) * 4 + 6]));
+            const __m256d ab_v = _mm256_blend_pd (a_v, b_v, 0xa);
+            odd_v = _mm256_castpd_ps (_mm256_permute4x64_pd (ab_v, _MM_SHUFFLE (3, 1, 2, 0)));
+          }
+        _mm256_storeu_ps (&output[i * 2], _mm256_fmadd_ps (odd_v, _mm256_set1_ps (0.5f), fir_v));
+        i += 4;
+      }
+    return i;
+  }
+#endif
+  template<int ODD_STEPPING>
+  void
+  process_block_fir (const float *input_even,
+                     const float *input_odd,
+                     float       *output,
+                     uint         n_output_frames)
+  {
+    const uint H = (ORDER / 2) - 1; /* half the filter length */
+
+    uint i = 0;
+#ifdef PANDA_RESAMPLER_AVX2
+    if (ISET == ISET_AVX2)
+      i = process_block_avx<ODD_STEPPING> (input_even, input_odd, output, n_output_frames);
+#endif
+    while (i + 2 <= n_output_frames)
+      {
+        F4Vector fir_v;
+        fir_process_4samples_symmetric_sse<SYM_WIDTH, 2> (&input_even[i * 2], &fir_taps->sym_taps[0], ORDER, &fir_v);
+
+        __m128 odd_v;
+        if (ODD_STEPPING == 1)
+          {
+            odd_v = _mm_loadu_ps (&input_odd[(H + i) * 2]);
+          }
+        else
+          {
+            /* pick every other frame from four consecutive frames */
+            const __m128 a_v = _mm_loadu_ps (&input_odd[(H + i) * 4]);
+            const __m128 b_v = _mm_loadu_ps (&input_odd[(H + i) * 4 + 4]);
+            odd_v = _mm_movelh_ps (a_v, b_v);
+          }
+        _mm_storeu_ps (&output[i * 2], _mm_add_ps (fir_v.v, _mm_mul_ps (odd_v, _mm_set1_ps (0.5f))));
+        i += 2;
+      }
+    while (i < n_output_frames)
+      {
+        for (uint c = 0; c < 2; c++)
+          output[i * 2 + c] = fir_process_one_sample<float, 2> (&input_even[i * 2 + c], &fir_taps->taps[0], ORDER) +
+                              0.5f * input_odd[(H + i) * 2 * ODD_STEPPING + c];
+        i++;
+      }
+  }
+  /* copies the even frames (two values each) of the data */
+  void
+  deinterleave_frames (const float *data,
+                       uint         n_data_frames,
+                       float       *output)
+  {
+    uint i = 0;
+    /* (i + 4 < n_data_frames): the last frame may be beyond the end of the input if data points to odd frames */
+    while (i + 4 < n_data_frames)
+      {
+        _mm_storeu_ps (&output[i], _mm_movelh_ps (_mm_loadu_ps (&data[i * 2]), _mm_loadu_ps (&data[i * 2 + 4])));
+        i += 4;
+      }
+    while (i < n_data_frames)
+      {
+        output[i]     = data[i * 2];
+        output[i + 1] = data[i * 2 + 1];
+        i += 2;
+      }
+  }
+public:
+  Downsampler2x2 (const std::shared_ptr<const FIRTaps>& init_taps) :
+    fir_taps (init_taps),
+    history_even ((ORDER - 1) * 2),
+    history_odd ((ORDER - 1) * 2)
+  {
+    PANDA_RESAMPLER_CHECK (fir_taps->symmetric && fir_taps->taps.size() == ORDER);
+  }
+  void
+  process_block (const float *, uint, float *) override
+  {
+    PANDA_RESAMPLER_CHECK (false); // only planar multi-channel processing is supported
+  }
+  void
+  process_block_planar (const float * const *input, uint n_input_samples, float * const *output) override
+  {
+    /* interleave small blocks (which stay in cache) */
+    const uint block_size = 256;
+
+    alignas (32) float in[block_size * 2];
+    alignas (32) float out[block_size];
+
+    const float *in_l = input[0], *in_r = input[1];
+    float *out_l = output[0], *out_r = output[1];
+
+    uint pos = 0;
+    while (pos < n_input_samples)
+      {
+        const uint n_todo = min (block_size, n_input_samples - pos);
+        for (uint i = 0; i < n_todo; i++)
+          {
+            in[i * 2]     = in_l[pos + i];
+            in[i * 2 + 1] = in_r[pos + i];
+          }
+        process_block_interleaved (in, n_todo, out);
+        for (uint i = 0; i < n_todo / 2; i++)
+          {
+            out_l[pos / 2 + i] = out[i * 2];
+            out_r[pos / 2 + i] = out[i * 2 + 1];
+          }
+        pos += n_todo;
+      }
+  }
+  void
+  process_block_interleaved (const float *input, uint n_input_frames, float *output) override
+  {
+    if (!PANDA_RESAMPLER_CHECK ((n_input_frames & 1) == 0))
+      return;
+
+    const uint BLOCKSIZE = 512;
+
+    F4Vector  block[BLOCKSIZE / 2]; /* BLOCKSIZE even frames, 16-byte aligned */
+    float    *input_even = &block[0].f[0];
+
+    while (n_input_frames)
+      {
+        const uint n_input_todo = min (n_input_frames, BLOCKSIZE * 2);
+
+        /* like Downsampler2, the SIMD kernels process a block containing only the even frames */
+        deinterleave_frames (input, n_input_todo, input_even);
+
+        const float *input_odd = input + 2; /* we process this one with a stepping of two frames */
+
+        const uint n_output_todo = n_input_todo / 2;
+        const uint history_todo = min (n_output_todo, ORDER - 1);
+
+        copy (input_even, input_even + history_todo * 2, history_even.data() + (ORDER - 1) * 2);
+        deinterleave_frames (input_odd, history_todo * 2, history_odd.data() + (ORDER - 1) * 2);
+
+        process_block_fir<1> (history_even.data(), history_odd.data(), output, history_todo);
+        if (n_output_todo > history_todo)
+          {
+            process_block_fir<2> (input_even, input_odd, &output[history_todo * 2], n_output_todo - history_todo);
+
+            // build new history from new input (here: history_todo == ORDER - 1)
+            copy (input_even + (n_output_todo - history_todo) * 2, input_even + n_output_todo * 2, history_even.data() + (ORDER - 1) * 2);
+            deinterleave_frames (input_odd + (n_input_todo - history_todo * 2) * 2, history_todo * 2, history_odd.data() + (ORDER - 1) * 2);
+          }
+        history_even.advance (history_todo * 2);
+        history_odd.advance (history_todo * 2);
+
+        n_input_frames -= n_input_todo;
+        input += n_input_todo * 2;
+        output += n_output_todo * 2;
+      }
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return order() / 2 - 0.5;
+  }
+  void
+  reset() override
+  {
+    history_even.reset();
+    history_odd.reset();
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+#endif /* PANDA_RESAMPLER_SIMD */
+
+template<class Filter> Resampler2::Impl*
+Resampler2::create_impl_with_coeffs (const double *d,
+                                     uint          order,
+                                     double        scaling)
+{
+  double taps[order];
+  for (uint i = 0; i < order; i++)
+    taps[i] = d[i] * scaling;
+
+  Resampler2::Impl *filter;
+#ifdef PANDA_RESAMPLER_SSE2
+  if (filter_ == FILTER_FIR_FIXED)
+    filter = Filter::create_fixed (taps, iset_);
+  else
+#endif
+    filter = new Filter (taps);
+  if (!PANDA_RESAMPLER_CHECK (order == filter->order()))
+    return nullptr;
+
+  return filter;
+}
+
+template<Resampler2::InstructionSet ISET> Resampler2::Impl*
+Resampler2::create_impl (uint stage_ratio)
+{
+  // START generated code
+  static constexpr double coeffs2_24[52] =
+  {
+    -1.896649020687189e-07,
+    8.9375397078734594e-07,
+    -2.9108958281584469e-06,
+    7.7609698680954118e-06,
+    -1.8119956302920787e-05,
+    3.8375105842230682e-05,
+    -7.5309071659470099e-05,
+    0.00013889694095199994,
+    -0.00024318689587188649,
+    0.00040722732084584021,
+    -0.00065600665137277646,
+    0.001021395018417595,
+    -0.0015431295374089733,
+    0.0022699842719303941,
+    -0.0032614400850958444,
+    0.0045904754831414861,
+    -0.0063486601639801904,
+    0.0086558345711950594,
+    -0.011679015470590512,
+    0.015670714074410223,
+    -0.021051408534455165,
+    0.028604536062639324,
+    -0.040008178410666853,
+    0.059644444619411124,
+    -0.10364569487012831,
+    0.31748269557078473,
+    0.31748269557078473,
+    -0.10364569487012831,
+    0.059644444619411124,
+    -0.040008178410666853,
+    0.028604536062639324,
+    -0.021051408534455165,
+    0.015670714074410223,
+    -0.011679015470590512,
+    0.0086558345711950594,
+    -0.0063486601639801904,
+    0.0045904754831414861,
+    -0.0032614400850958444,
+    0.0022699842719303941,
+    -0.0015431295374089733,
+    0.001021395018417595,
+    -0.00065600665137277646,
+    0.00040722732084584021,
+    -0.00024318689587188649,
+    0.00013889694095199994,
+    -7.5309071659470099e-05,
+    3.8375105842230682e-05,
+    -1.8119956302920787e-05,
+    7.7609698680954118e-06,
+    -2.9108958281584469e-06,
+    8.9375397078734594e-07,
+    -1.896649020687189e-07,
+  };
+  if (stage_ratio == 2 && precision_ == 24 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<52, ISET> > (coeffs2_24, 52, 2.0);
+  if (stage_ratio == 2 && precision_ == 24 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<52, ISET> > (coeffs2_24, 52, 1.0);
+  static constexpr double coeffs4_24[16] =
+  {
+    -7.8113862062895476e-06,
+    0.00011777177340253331,
+    -0.00080979027642968178,
+    0.0035914299596685019,
+    -0.011907675232141868,
+    0.032618531462663004,
+    -0.083680449562963555,
+    0.31007801153486508,
+    0.31007801153486508,
+    -0.083680449562963555,
+    0.032618531462663004,
+    -0.011907675232141868,
+    0.0035914299596685019,
+    -0.00080979027642968178,
+    0.00011777177340253331,
+    -7.8113862062895476e-06,
+  };
+  if (stage_ratio == 4 && precision_ == 24 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<16, ISET> > (coeffs4_24, 16, 2.0);
+  if (stage_ratio == 4 && precision_ == 24 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<16, ISET> > (coeffs4_24, 16, 1.0);
+  static constexpr double coeffs8_24[12] =
+  {
+    -3.0345557546583312e-05,
+    0.00057384655742621254,
+    -0.0043830674681261195,
+    0.020226878808907018,
+    -0.070915964811982507,
+    0.30452864347609143,
+    0.30452864347609143,
+    -0.070915964811982507,
+    0.020226878808907018,
+    -0.0043830674681261195,
+    0.00057384655742621254,
+    -3.0345557546583312e-05,
+  };
+  if (stage_ratio == 8 && precision_ == 24 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<12, ISET> > (coeffs8_24, 12, 2.0);
+  if (stage_ratio == 8 && precision_ == 24 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<12, ISET> > (coeffs8_24, 12, 1.0);
+  static constexpr double coeffs2_20[42] =
+  {
+    2.4629216796772203e-06,
+    -9.7990456966301657e-06,
+    2.8137964376908064e-05,
+    -6.7464881821884139e-05,
+    0.00014336862073315604,
+    -0.000278702763263149,
+    0.00050528391212770792,
+    -0.00086555167177917124,
+    0.001414202687011217,
+    -0.0022199926486379607,
+    0.003368236285452741,
+    -0.0049651473206043309,
+    0.0071463283371987034,
+    -0.010094148846828722,
+    0.014074361299068285,
+    -0.019516906264665349,
+    0.0272094990821482,
+    -0.038828382182376338,
+    0.058747406804456566,
+    -0.10308466896169781,
+    0.31729177522077334,
+    0.31729177522077334,
+    -0.10308466896169781,
+    0.058747406804456566,
+    -0.038828382182376338,
+    0.0272094990821482,
+    -0.019516906264665349,
+    0.014074361299068285,
+    -0.010094148846828722,
+    0.0071463283371987034,
+    -0.0049651473206043309,
+    0.003368236285452741,
+    -0.0022199926486379607,
+    0.001414202687011217,
+    -0.00086555167177917124,
+    0.00050528391212770792,
+    -0.000278702763263149,
+    0.00014336862073315604,
+    -6.7464881821884139e-05,
+    2.8137964376908064e-05,
+    -9.7990456966301657e-06,
+    2.4629216796772203e-06,
+  };
+  if (stage_ratio == 2 && precision_ == 20 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<42, ISET> > (coeffs2_20, 42, 2.0);
+  if (stage_ratio == 2 && precision_ == 20 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<42, ISET> > (coeffs2_20, 42, 1.0);
+  static constexpr double coeffs4_20[14] =
+  {
+    4.3979674631863943e-05,
+    -0.00050306469192140939,
+    0.0027962504087410051,
+    -0.010470114594085408,
+    0.030755143193163859,
+    -0.082041866707154076,
+    0.30941949170527272,
+    0.30941949170527272,
+    -0.082041866707154076,
+    0.030755143193163859,
+    -0.010470114594085408,
+    0.0027962504087410051,
+    -0.00050306469192140939,
+    4.3979674631863943e-05,
+  };
+  if (stage_ratio == 4 && precision_ == 20 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<14, ISET> > (coeffs4_20, 14, 2.0);
+  if (stage_ratio == 4 && precision_ == 20 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<14, ISET> > (coeffs4_20, 14, 1.0);
+  static constexpr double coeffs8_20[10] =
+  {
+    0.00017230594713343064,
+    -0.002551731819446271,
+    0.015994679393099207,
+    -0.06565066677090392,
+    0.30203532650661641,
+    0.30203532650661641,
+    -0.06565066677090392,
+    0.015994679393099207,
+    -0.002551731819446271,
+    0.00017230594713343064,
+  };
+  if (stage_ratio == 8 && precision_ == 20 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<10, ISET> > (coeffs8_20, 10, 2.0);
+  if (stage_ratio == 8 && precision_ == 20 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<10, ISET> > (coeffs8_20, 10, 1.0);
+  static constexpr double coeffs2_16[32] =
+  {
+    -3.5142734993474452e-05,
+    0.00011358789579768951,
+    -0.00028037958674221312,
+    0.00059293788160310029,
+    -0.0011294540908177168,
+    0.0019917372726928405,
+    -0.0033089217809884803,
+    0.0052441962508097874,
+    -0.0080093910223938553,
+    0.011898075091115748,
+    -0.017362581771322445,
+    0.025204120984314127,
+    -0.037100932061169559,
+    0.057416112765805175,
+    -0.10224463341225128,
+    0.31700464719515836,
+    0.31700464719515836,
+    -0.10224463341225128,
+    0.057416112765805175,
+    -0.037100932061169559,
+    0.025204120984314127,
+    -0.017362581771322445,
+    0.011898075091115748,
+    -0.0080093910223938553,
+    0.0052441962508097874,
+    -0.0033089217809884803,
+    0.0019917372726928405,
+    -0.0011294540908177168,
+    0.00059293788160310029,
+    -0.00028037958674221312,
+    0.00011358789579768951,
+    -3.5142734993474452e-05,
+  };
+  if (stage_ratio == 2 && precision_ == 16 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<32, ISET> > (coeffs2_16, 32, 2.0);
+  if (stage_ratio == 2 && precision_ == 16 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<32, ISET> > (coeffs2_16, 32, 1.0);
+  static constexpr double coeffs4_16[10] =
+  {
+    0.00055713256761683592,
+    -0.0048543666906354314,
+    0.021809335002826412,
+    -0.073141515220609826,
+    0.30562814686107148,
+    0.30562814686107148,
+    -0.073141515220609826,
+    0.021809335002826412,
+    -0.0048543666906354314,
+    0.00055713256761683592,
+  };
+  if (stage_ratio == 4 && precision_ == 16 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<10, ISET> > (coeffs4_16, 10, 2.0);
+  if (stage_ratio == 4 && precision_ == 16 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<10, ISET> > (coeffs4_16, 10, 1.0);
+  static constexpr double coeffs8_16[8] =
+  {
+    -0.0010885239331601664,
+    0.011649378449320126,
+    -0.059557473859641011,
+    0.29900137394294291,
+    0.29900137394294291,
+    -0.059557473859641011,
+    0.011649378449320126,
+    -0.0010885239331601664,
+  };
+  if (stage_ratio == 8 && precision_ == 16 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<8, ISET> > (coeffs8_16, 8, 2.0);
+  if (stage_ratio == 8 && precision_ == 16 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<8, ISET> > (coeffs8_16, 8, 1.0);
+  static constexpr double coeffs2_12[24] =
+  {
+    -0.00031919473602139891,
+    0.00083854004488146685,
+    -0.0017905303270299995,
+    0.0033731130894814397,
+    -0.0058408892523820347,
+    0.0095314079754320758,
+    -0.014935625615431904,
+    0.022881655727240446,
+    -0.035057791064865292,
+    0.055817399757994692,
+    -0.10122584733772397,
+    0.31665472430452679,
+    0.31665472430452679,
+    -0.10122584733772397,
+    0.055817399757994692,
+    -0.035057791064865292,
+    0.022881655727240446,
+    -0.014935625615431904,
+    0.0095314079754320758,
+    -0.0058408892523820347,
+    0.0033731130894814397,
+    -0.0017905303270299995,
+    0.00083854004488146685,
+    -0.00031919473602139891,
+  };
+  if (stage_ratio == 2 && precision_ == 12 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<24, ISET> > (coeffs2_12, 24, 2.0);
+  if (stage_ratio == 2 && precision_ == 12 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<24, ISET> > (coeffs2_12, 24, 1.0);
+  static constexpr double coeffs4_12[8] =
+  {
+    -0.0025910542040449157,
+    0.017312836258421893,
+    -0.068161446853832547,
+    0.30340841235941457,
+    0.30340841235941457,
+    -0.068161446853832547,
+    0.017312836258421893,
+    -0.0025910542040449157,
+  };
+  if (stage_ratio == 4 && precision_ == 12 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<8, ISET> > (coeffs4_12, 8, 2.0);
+  if (stage_ratio == 4 && precision_ == 12 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<8, ISET> > (coeffs4_12, 8, 1.0);
+  static constexpr double coeffs8_12[6] =
+  {
+    0.005872148420194066,
+    -0.049275035331134497,
+    0.29336813890765762,
+    0.29336813890765762,
+    -0.049275035331134497,
+    0.005872148420194066,
+  };
+  if (stage_ratio == 8 && precision_ == 12 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<6, ISET> > (coeffs8_12, 6, 2.0);
+  if (stage_ratio == 8 && precision_ == 12 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<6, ISET> > (coeffs8_12, 6, 1.0);
+  static constexpr double coeffs2_8[16] =
+  {
+    -0.0026367453410967019,
+    0.0056954995988467462,
+    -0.010750637983096105,
+    0.018689598049002096,
+    -0.031243628674597745,
+    0.052760932803671098,
+    -0.099248122111822379,
+    0.31597034387100925,
+    0.31597034387100925,
+    -0.099248122111822379,
+    0.052760932803671098,
+    -0.031243628674597745,
+    0.018689598049002096,
+    -0.010750637983096105,
+    0.0056954995988467462,
+    -0.0026367453410967019,
+  };
+  if (stage_ratio == 2 && precision_ == 8 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<16, ISET> > (coeffs2_8, 16, 2.0);
+  if (stage_ratio == 2 && precision_ == 8 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<16, ISET> > (coeffs2_8, 16, 1.0);
+  static constexpr double coeffs4_8[6] =
+  {
+    0.013331613494158878,
+    -0.063984766541747701,
+    0.30161384865948221,
+    0.30161384865948221,
+    -0.063984766541747701,
+    0.013331613494158878,
+  };
+  if (stage_ratio == 4 && precision_ == 8 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<6, ISET> > (coeffs4_8, 6, 2.0);
+  if (stage_ratio == 4 && precision_ == 8 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<6, ISET> > (coeffs4_8, 6, 1.0);
+  static constexpr double coeffs8_8[4] =
+  {
+    -0.037276258261764332,
+    0.28635090020526976,
+    0.28635090020526976,
+    -0.037276258261764332,
+  };
+  if (stage_ratio == 8 && precision_ == 8 && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<4, ISET> > (coeffs8_8, 4, 2.0);
+  if (stage_ratio == 8 && precision_ == 8 && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<4, ISET> > (coeffs8_8, 4, 1.0);
+  // END generated code
+
+  /* linear interpolation coefficients; barely useful for actual audio use,
+   * but useful for testing
+   */
+  static constexpr double coeffs_linear[2] = {
+    0.25,
+    /* here, a 0.5 coefficient will be used */
+    0.25,
+  };
+
+  if (precision_ == PREC_LINEAR && mode_ == UP)
+    return create_impl_with_coeffs <Upsampler2<2, ISET> > (coeffs_linear, 2, 2.0);
+  if (precision_ == PREC_LINEAR && mode_ == DOWN)
+    return create_impl_with_coeffs <Downsampler2<2, ISET> > (coeffs_linear, 2, 1.0);
+  return 0;
+}
+
+template<uint ORDER>
+class Resampler2::IIRDownsampler2 final : public Resampler2::Impl {
+  hiir::Downsampler2xFpu<ORDER> downs;
+  std::array<double, ORDER> coeffs_;
+  double delay_;
+public:
+  IIRDownsampler2 (const double *coeffs, double group_delay) :
+    delay_ ((group_delay - 1) / 2)
+  {
+    downs.set_coefs (coeffs);
+    std::copy (coeffs, coeffs + ORDER, coeffs_.begin());
+  }
+  void
+  process_block (const float *input, uint n_input_samples, float *output) override
+  {
+    const uint n_output_samples = n_input_samples / 2;
+
+    downs.process_block (output, input, n_output_samples);
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    downs.clear_buffers();
+  }
+  ResamplerBankStage *
+  create_bank_stage (uint n_groups, bool avx) const override
+  {
+    return create_bank_iir_downsampler2<ORDER> (coeffs_.data(), n_groups, avx);
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    return new DoubleIIRDownsampler2<hiir::Downsampler2xFpuTpl<ORDER, double>> (coeffs_.data());
+  }
+  bool
+  sse_enabled() const override
+  {
+    return false;
+  }
+};
+
+template<uint ORDER>
+class Resampler2::IIRUpsampler2 final : public Resampler2::Impl {
+  hiir::Upsampler2xFpu<ORDER> ups;
+  std::array<double, ORDER> coeffs_;
+  double delay_;
+public:
+  IIRUpsampler2 (const double *coeffs, double group_delay) :
+    delay_ (group_delay)
+  {
+    ups.set_coefs (coeffs);
+    std::copy (coeffs, coeffs + ORDER, coeffs_.begin());
+  }
+  void
+  process_block (const float *input, uint n_input_samples, float *output) override
+  {
+    ups.process_block (output, input, n_input_samples);
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    ups.clear_buffers();
+  }
+  ResamplerBankStage *
+  create_bank_stage (uint n_groups, bool avx) const override
+  {
+    return create_bank_iir_upsampler2<ORDER> (coeffs_.data(), n_groups, avx);
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    return new DoubleIIRUpsampler2<hiir::Upsampler2xFpuTpl<ORDER, double>> (coeffs_.data());
+  }
+  bool
+  sse_enabled() const override
+  {
+    return false;
+  }
+};
+
+#ifdef PANDA_RESAMPLER_SIMD
+/* hiir filters for the double precision stages of the vectorized IIR resamplers */
+#ifdef PANDA_RESAMPLER_SSE2
+template<uint NC> using IIRUpsampler2F64   = hiir::Upsampler2xF64Sse2<NC>;
+template<uint NC> using IIRDownsampler2F64 = hiir::Downsampler2xF64Sse2<NC>;
+#else
+template<uint NC> using IIRUpsampler2F64   = hiir::Upsampler2xFpuTpl<NC, double>;
+template<uint NC> using IIRDownsampler2F64 = hiir::Downsampler2xFpuTpl<NC, double>;
+#endif
+
+template<uint ORDER>
+class Resampler2::IIRDownsampler2SSE final : public Resampler2::Impl {
+  hiir::Downsampler2xSse<ORDER> downs;
+  std::array<double, ORDER> coeffs_;
+  double delay_;
+public:
+  IIRDownsampler2SSE (const double *coeffs, double group_delay) :
+    delay_ ((group_delay - 1) / 2)
+  {
+    downs.set_coefs (coeffs);
+    std::copy (coeffs, coeffs + ORDER, coeffs_.begin());
+  }
+  const double *
+  coeffs() const
+  {
+    return coeffs_.data();
+  }
+  void
+  process_block (const float *input, uint n_input_samples, float *output) override
+  {
+    const uint n_output_samples = n_input_samples / 2;
+
+    downs.process_block (output, input, n_output_samples);
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    downs.clear_buffers();
+  }
+  ResamplerBankStage *
+  create_bank_stage (uint n_groups, bool avx) const override
+  {
+    return create_bank_iir_downsampler2<ORDER> (coeffs_.data(), n_groups, avx);
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    return new DoubleIIRDownsampler2<IIRDownsampler2F64<ORDER>> (coeffs_.data());
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+
+template<uint ORDER>
+class Resampler2::IIRUpsampler2SSE final : public Resampler2::Impl {
+  hiir::Upsampler2xSse<ORDER> ups;
+  std::array<double, ORDER> coeffs_;
+  double delay_;
+public:
+  IIRUpsampler2SSE (const double *coeffs, double group_delay) :
+    delay_ (group_delay)
+  {
+    ups.set_coefs (coeffs);
+    std::copy (coeffs, coeffs + ORDER, coeffs_.begin());
+  }
+  const double *
+  coeffs() const
+  {
+    return coeffs_.data();
+  }
+  void
+  process_block (const float *input, uint n_input_samples, float *output) override
+  {
+    ups.process_block (output, input, n_input_samples);
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    ups.clear_buffers();
+  }
+  ResamplerBankStage *
+  create_bank_stage (uint n_groups, bool avx) const override
+  {
+    return create_bank_iir_upsampler2<ORDER> (coeffs_.data(), n_groups, avx);
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    return new DoubleIIRUpsampler2<IIRUpsampler2F64<ORDER>> (coeffs_.data());
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+
+/*
+ * IIR downsampler for 2 channels, which are processed in parallel (both
+ * channels and both polyphase paths in one SSE vector)
+ */
+template<uint ORDER>
+class Resampler2::IIRDownsampler2x2SSE final : public Resampler2::Impl {
+  hiir::Downsampler2x2Sse<ORDER> downs;
+  double delay_;
+public:
+  IIRDownsampler2x2SSE (const double *coeffs, double group_delay) :
+    delay_ ((group_delay - 1) / 2)
+  {
+    downs.set_coefs (coeffs);
+  }
+  void
+  process_block (const float *, uint, float *) override
+  {
+    PANDA_RESAMPLER_CHECK (false); // only planar multi-channel processing is supported
+  }
+  void
+  process_block_planar (const float * const *input, uint n_input_samples, float * const *output) override
+  {
+    const float *in_l = input[0];
+    const float *in_r = input[1];
+
+    for (uint i = 0; i < n_input_samples / 2; i++)
+      {
+        const __m128 x = downs.process_sample (_mm_setr_ps (in_l[i * 2], in_r[i * 2], in_l[i * 2 + 1], in_r[i * 2 + 1]));
+        output[0][i] = _mm_cvtss_f32 (x);
+        output[1][i] = _mm_cvtss_f32 (_mm_shuffle_ps (x, x, 1));
+      }
+  }
+  void
+  process_block_interleaved (const float *input, uint n_input_frames, float *output) override
+  {
+    if (n_input_frames >= 2)
+      downs.process_block (output, input, n_input_frames / 2);
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    downs.clear_buffers();
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+
+/*
+ * IIR upsampler for 2 channels, which are processed in parallel (both
+ * channels and both polyphase paths in one SSE vector)
+ */
+template<uint ORDER>
+class Resampler2::IIRUpsampler2x2SSE final : public Resampler2::Impl {
+  hiir::Upsampler2x2Sse<ORDER> ups;
+  double delay_;
+public:
+  IIRUpsampler2x2SSE (const double *coeffs, double group_delay) :
+    delay_ (group_delay)
+  {
+    ups.set_coefs (coeffs);
+  }
+  void
+  process_block (const float *, uint, float *) override
+  {
+    PANDA_RESAMPLER_CHECK (false); // only planar multi-channel processing is supported
+  }
+  void
+  process_block_planar (const float * const *input, uint n_input_samples, float * const *output) override
+  {
+    const float *in_l = input[0];
+    const float *in_r = input[1];
+
+    for (uint i = 0; i < n_input_samples; i++)
+      {
+        __m128 x = ups.process_sample (in_l[i], in_r[i]);
+
+        /* L0 R0 L1 R1 -> L0 L1 R0 R1 */
+        x = _mm_shuffle_ps (x, x, _MM_SHUFFLE (3, 1, 2, 0));
+        _mm_storel_pi (reinterpret_cast<__m64 *> (&output[0][i * 2]), x);
+        _mm_storel_pi (reinterpret_cast<__m64 *> (&output[1][i * 2]), _mm_movehl_ps (x, x));
+      }
+  }
+  void
+  process_block_interleaved (const float *input, uint n_input_frames, float *output) override
+  {
+    if (n_input_frames)
+      ups.process_block (output, input, n_input_frames);
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    ups.clear_buffers();
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+
+/*
+ * Coefficients and filter memory of one factor 2 IIR stage, using the same
+ * layout as hiir::Upsampler2xSse and hiir::Downsampler2xSse (two coefficients
+ * per allpass stage, lanes 2 and 3 are unused). Unlike hiir, the filter memory
+ * is passed to process(), so that it can be copied into a local variable for
+ * processing a block of samples; this way the compiler can keep it in
+ * registers instead of loading and storing it for each sample.
+ */
+template<uint NC>
+struct IIRStageSSE
+{
+  static constexpr uint n_stages = (NC + 1) / 2;
+
+  struct Mem
+  {
+    __m128 v[n_stages + 1];
+  };
+  __m128 coef[n_stages + 1];
+  Mem    mem;
+
+  IIRStageSSE()
+  {
+    for (uint s = 0; s <= n_stages; s++)
+      coef[s] = _mm_setzero_ps();
+    clear_buffers();
+  }
+  void
+  set_coefs (const double *coeffs)
+  {
+    F4Vector c[n_stages + 1] = {};
+    if (NC < n_stages * 2)
+      c[n_stages].f[0] = 1;
+
+    for (uint i = 0; i < NC; i++)
+      c[i / 2 + 1].f[(i ^ 1) & 1] = coeffs[i];
+
+    for (uint s = 0; s <= n_stages; s++)
+      coef[s] = c[s].v;
+  }
+  void
+  clear_buffers()
+  {
+    for (uint s = 0; s <= n_stages; s++)
+      mem.v[s] = _mm_setzero_ps();
+  }
+  /* computes the two polyphase outputs for input x (see hiir::StageProcSseV2) */
+  PANDA_RESAMPLER_FN_ALWAYS_INLINE __m128
+  process (Mem& m, __m128 x) const
+  {
+    for (uint s = 1; s <= n_stages; s++)
+      {
+        const __m128 tmp = m.v[s - 1];
+        m.v[s - 1] = x;
+
+        x = _mm_sub_ps (x, m.v[s]);
+        x = _mm_mul_ps (x, coef[s]);
+        x = _mm_add_ps (x, tmp);
+      }
+    m.v[n_stages] = x;
+    return x;
+  }
+  /* upsampling: returns out_0 in lane 0 and out_1 in lane 1 */
+  PANDA_RESAMPLER_FN_ALWAYS_INLINE __m128
+  process_up (Mem& m, __m128 in) const
+  {
+    const __m128 x = process (m, in);
+    return _mm_shuffle_ps (x, x, _MM_SHUFFLE (0, 0, 0, 1));
+  }
+  /* downsampling: input samples in lane 0 and 1, returns output in lane 0 */
+  PANDA_RESAMPLER_FN_ALWAYS_INLINE __m128
+  process_down (Mem& m, __m128 in) const
+  {
+    __m128 x = process (m, in);
+    x = _mm_add_ss (x, _mm_shuffle_ps (x, x, 1));
+    return _mm_mul_ss (x, _mm_set_ss (0.5f));
+  }
+};
+
+/*
+ * IIR upsampler for ratio 4 and 8 which runs the complete cascade of factor 2
+ * stages for each input sample; the state of all stages is kept in registers
+ * for the whole block, and only the final output is written to memory
+ */
+template<uint N2, uint N4, uint N8>
+class Resampler2::IIRUpsamplerCascadeSSE final : public Resampler2::Impl {
+  IIRStageSSE<N2> stage2;
+  IIRStageSSE<N4> stage4;
+  IIRStageSSE<N8> stage8;
+  uint            ratio_;
+  double          delay_;
+
+  template<uint RATIO>
+  void
+  process_block_cascade (const float *input, uint n_input_samples, float *output)
+  {
+    /* local copies: allows the compiler to keep the filter memory in registers */
+    auto m2 = stage2.mem;
+    auto m4 = stage4.mem;
+    auto m8 = stage8.mem;
+
+    /* software pipelining: in each step, the x2 stage processes input sample i,
+     * the x4 stage the output of the previous step and the x8 stage the output
+     * of the step before that; so the dependency chains of the stages are
+     * independent and can be executed in parallel by the CPU
+     */
+    __m128 x2 = _mm_setzero_ps();
+    __m128 x4_0 = _mm_setzero_ps();
+    __m128 x4_1 = _mm_setzero_ps();
+
+    const uint n_steps = n_input_samples + (RATIO == 8 ? 2 : 1);
+    for (uint i = 0; i < n_steps; i++)
+      {
+        if (RATIO == 8 && i >= 2)
+          {
+            const __m128 x8_0 = stage8.process_up (m8, _mm_shuffle_ps (x4_0, x4_0, _MM_SHUFFLE (0, 0, 0, 0)));
+            const __m128 x8_1 = stage8.process_up (m8, _mm_shuffle_ps (x4_0, x4_0, _MM_SHUFFLE (1, 1, 1, 1)));
+            const __m128 x8_2 = stage8.process_up (m8, _mm_shuffle_ps (x4_1, x4_1, _MM_SHUFFLE (0, 0, 0, 0)));
+            const __m128 x8_3 = stage8.process_up (m8, _mm_shuffle_ps (x4_1, x4_1, _MM_SHUFFLE (1, 1, 1, 1)));
+
+            _mm_storeu_ps (output, _mm_movelh_ps (x8_0, x8_1));
+            _mm_storeu_ps (output + 4, _mm_movelh_ps (x8_2, x8_3));
+            output += 8;
+          }
+        if (i >= 1 && i <= n_input_samples)
+          {
+            x4_0 = stage4.process_up (m4, _mm_shuffle_ps (x2, x2, _MM_SHUFFLE (0, 0, 0, 0)));
+            x4_1 = stage4.process_up (m4, _mm_shuffle_ps (x2, x2, _MM_SHUFFLE (1, 1, 1, 1)));
+            if (RATIO == 4)
+              {
+                _mm_storeu_ps (output, _mm_movelh_ps (x4_0, x4_1));
+                output += 4;
+              }
+          }
+        if (i < n_input_samples)
+          x2 = stage2.process_up (m2, _mm_set1_ps (input[i]));
+      }
+    stage2.mem = m2;
+    stage4.mem = m4;
+    stage8.mem = m8;
+  }
+public:
+  IIRUpsamplerCascadeSSE (uint ratio, const double *coeffs2, const double *coeffs4, const double *coeffs8, double delay) :
+    ratio_ (ratio),
+    delay_ (delay)
+  {
+    stage2.set_coefs (coeffs2);
+    stage4.set_coefs (coeffs4);
+    if (ratio_ == 8)
+      stage8.set_coefs (coeffs8);
+  }
+  void
+  process_block (const float *input, uint n_input_samples, float *output) override
+  {
+    if (ratio_ == 8)
+      process_block_cascade<8> (input, n_input_samples, output);
+    else
+      process_block_cascade<4> (input, n_input_samples, output);
+  }
+  uint
+  order() const override
+  {
+    return N2;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    stage2.clear_buffers();
+    stage4.clear_buffers();
+    stage8.clear_buffers();
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+
+/*
+ * IIR downsampler for ratio 4 and 8 which runs the complete cascade of factor
+ * 2 stages for each output sample; like IIRUpsamplerCascadeSSE, the state of
+ * all stages is kept in registers for the whole block
+ */
+template<uint N2, uint N4, uint N8>
+class Resampler2::IIRDownsamplerCascadeSSE final : public Resampler2::Impl {
+  IIRStageSSE<N2> stage2;
+  IIRStageSSE<N4> stage4;
+  IIRStageSSE<N8> stage8;
+  uint            ratio_;
+  double          delay_;
+
+  template<uint RATIO>
+  void
+  process_block_cascade (const float *input, uint n_output_samples, float *output)
+  {
+    /* local copies: allows the compiler to keep the filter memory in registers */
+    auto m2 = stage2.mem;
+    auto m4 = stage4.mem;
+    auto m8 = stage8.mem;
+
+    /* software pipelining (see IIRUpsamplerCascadeSSE): in each step, the x2
+     * stage processes the output of the x4 stage from the previous step, and
+     * for ratio 8, the x4 stage the output of the x8 stage from the previous
+     * step
+     */
+    __m128 x2 = _mm_setzero_ps();
+    __m128 x4_0 = _mm_setzero_ps();
+    __m128 x4_1 = _mm_setzero_ps();
+
+    const uint n_steps = n_output_samples + (RATIO == 8 ? 2 : 1);
+    for (uint i = 0; i < n_steps; i++)
+      {
+        const uint x2_delay = RATIO == 8 ? 2 : 1;
+        if (i >= x2_delay)
+          *output++ = _mm_cvtss_f32 (stage2.process_down (m2, x2));
+
+        if (RATIO == 4)
+          {
+            if (i < n_output_samples)
+              {
+                const __m128 in = _mm_loadu_ps (input);
+                input += 4;
+
+                const __m128 x2_0 = stage4.process_down (m4, in);
+                const __m128 x2_1 = stage4.process_down (m4, _mm_movehl_ps (in, in));
+                x2 = _mm_unpacklo_ps (x2_0, x2_1);
+              }
+          }
+        else /* RATIO == 8 */
+          {
+            if (i >= 1 && i <= n_output_samples)
+              {
+                const __m128 x2_0 = stage4.process_down (m4, x4_0);
+                const __m128 x2_1 = stage4.process_down (m4, x4_1);
+                x2 = _mm_unpacklo_ps (x2_0, x2_1);
+              }
+            if (i < n_output_samples)
+              {
+                const __m128 in_0 = _mm_loadu_ps (input);
+                const __m128 in_1 = _mm_loadu_ps (input + 4);
+                input += 8;
+
+                const __m128 x8_0 = stage8.process_down (m8, in_0);
+                const __m128 x8_1 = stage8.process_down (m8, _mm_movehl_ps (in_0, in_0));
+                const __m128 x8_2 = stage8.process_down (m8, in_1);
+                const __m128 x8_3 = stage8.process_down (m8, _mm_movehl_ps (in_1, in_1));
+                x4_0 = _mm_unpacklo_ps (x8_0, x8_1);
+                x4_1 = _mm_unpacklo_ps (x8_2, x8_3);
+              }
+          }
+      }
+    stage2.mem = m2;
+    stage4.mem = m4;
+    stage8.mem = m8;
+  }
+public:
+  IIRDownsamplerCascadeSSE (uint ratio, const double *coeffs2, const double *coeffs4, const double *coeffs8, double delay) :
+    ratio_ (ratio),
+    delay_ (delay)
+  {
+    stage2.set_coefs (coeffs2);
+    stage4.set_coefs (coeffs4);
+    if (ratio_ == 8)
+      stage8.set_coefs (coeffs8);
+  }
+  void
+  process_block (const float *input, uint n_input_samples, float *output) override
+  {
+    if (ratio_ == 8)
+      process_block_cascade<8> (input, n_input_samples / 8, output);
+    else
+      process_block_cascade<4> (input, n_input_samples / 4, output);
+  }
+  uint
+  order() const override
+  {
+    return N2;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    stage2.clear_buffers();
+    stage4.clear_buffers();
+    stage8.clear_buffers();
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+#endif /* PANDA_RESAMPLER_SIMD */
+
+/*
+ * Time-parallel evaluation of one branch of a polyphase IIR halfband filter,
+ * which is a chain of first order allpass sections.
+ *
+ * Each section computes
+ *
+ *   y[n] = c * (x[n] - y[n-1]) + x[n-1] = a * y[n-1] + b[n]
+ *
+ * with a = -c and b[n] = c * x[n] + x[n-1]. Since b[n] only depends on the
+ * input, it can be computed for a whole vector of samples at once. The
+ * remaining linear recurrence is solved with a parallel prefix (scan) over
+ * the vector, so from one vector to the next, only y[n-1] needs to be passed
+ * on. This way a single channel can use the full SIMD width, whereas the
+ * sequential evaluation (hiir) is limited by the latency of the recursion.
+ * The results differ from sequential evaluation by rounding errors only.
+ */
+template<uint NS>
+struct IIRParallelBranch
+{
+  std::array<float, NS>     c;
+  std::array<float, NS + 1> state; /* state[0]: last input, state[s + 1]: last output of section s */
+
+  IIRParallelBranch()
+  {
+    c.fill (0);
+    reset();
+  }
+  /* uses every second coefficient, starting with coeffs[0] */
+  void
+  set_coefs (const double *coeffs)
+  {
+    for (uint s = 0; s < NS; s++)
+      c[s] = coeffs[s * 2];
+  }
+  void
+  reset()
+  {
+    state.fill (0);
+  }
+  float
+  process_sample (float x)
+  {
+    for (uint s = 0; s < NS; s++)
+      {
+        const float x_prev = state[s];
+        state[s] = x;
+        x = (x - state[s + 1]) * c[s] + x_prev;
+      }
+    state[NS] = x;
+    return x;
+  }
+#ifdef PANDA_RESAMPLER_SIMD
+  struct CoeffsSSE
+  {
+    __m128 c;
+    __m128 a;     /* a */
+    __m128 a2;    /* a^2 */
+    __m128 a_pow; /* a, a^2, a^3, a^4 */
+  };
+  void
+  coeffs_sse (CoeffsSSE *cv) const
+  {
+    for (uint s = 0; s < NS; s++)
+      {
+        const float a = -c[s];
+        cv[s].c     = _mm_set1_ps (c[s]);
+        cv[s].a     = _mm_set1_ps (a);
+        cv[s].a2    = _mm_set1_ps (a * a);
+        cv[s].a_pow = _mm_setr_ps (a, a * a, a * a * a, a * a * a * a);
+      }
+  }
+  /* state_v contains the state as broadcast vectors */
+  static PANDA_RESAMPLER_FN_ALWAYS_INLINE __m128
+  process_4samples_sse (__m128 x, __m128 *state_v, const CoeffsSSE *cv)
+  {
+    const __m128 zero = _mm_setzero_ps();
+    for (uint s = 0; s < NS; s++)
+      {
+        /* x_prev = (x[-1], x[0], x[1], x[2]) */
+        const __m128 x_prev = _mm_shuffle_ps (_mm_movelh_ps (state_v[s], x), x, _MM_SHUFFLE (2, 1, 2, 0));
+        state_v[s] = _mm_shuffle_ps (x, x, _MM_SHUFFLE (3, 3, 3, 3));
+
+        /* scan: v[i] = b[i] + a * b[i-1] + a^2 * b[i-2] + ... */
+        __m128 v = _mm_add_ps (_mm_mul_ps (cv[s].c, x), x_prev);
+        v = _mm_add_ps (v, _mm_mul_ps (cv[s].a, _mm_shuffle_ps (_mm_movelh_ps (zero, v), v, _MM_SHUFFLE (2, 1, 2, 0))));
+        v = _mm_add_ps (v, _mm_mul_ps (cv[s].a2, _mm_movelh_ps (zero, v)));
+
+        x = _mm_add_ps (v, _mm_mul_ps (cv[s].a_pow, state_v[s + 1]));
+      }
+    state_v[NS] = _mm_shuffle_ps (x, x, _MM_SHUFFLE (3, 3, 3, 3));
+    return x;
+  }
+#endif
+#ifdef PANDA_RESAMPLER_AVX2
+  struct CoeffsAVX
+  {
+    __m256 c;
+    __m256 a;     /* a */
+    __m256 a2;    /* a^2 */
+    __m256 a4;    /* a^4 */
+    __m256 a_pow; /* a, a^2, ..., a^8 */
+  };
+  PANDA_RESAMPLER_TARGET_AVX2
+  void
+  coeffs_avx (CoeffsAVX *cv) const
+  {
+    for (uint s = 0; s < NS; s++)
+      {
+        float a_pow[8];
+        a_pow[0] = -c[s];
+        for (uint i = 1; i < 8; i++)
+          a_pow[i] = a_pow[i - 1] * a_pow[0];
+
+        cv[s].c     = _mm256_set1_ps (c[s]);
+        cv[s].a     = _mm256_set1_ps (a_pow[0]);
+        cv[s].a2    = _mm256_set1_ps (a_pow[1]);
+        cv[s].a4    = _mm256_set1_ps (a_pow[3]);
+        cv[s].a_pow = _mm256_loadu_ps (a_pow);
+      }
+  }
+  static PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE __m256
+  process_8samples_avx (__m256 x, __m256 *state_v, const CoeffsAVX *cv)
+  {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i shift1_idx = _mm256_setr_epi32 (0, 0, 1, 2, 3, 4, 5, 6);
+    const __m256i shift2_idx = _mm256_setr_epi32 (0, 0, 0, 1, 2, 3, 4, 5);
+    const __m256i last_idx = _mm256_set1_epi32 (7);
+    for (uint s = 0; s < NS; s++)
+      {
+        /* x_prev = (x[-1], x[0], ..., x[6]) */
+        const __m256 x_prev = _mm256_blend_ps (_mm256_permutevar8x32_ps (x, shift1_idx), state_v[s], 0x01);
+        state_v[s] = _mm256_permutevar8x32_ps (x, last_idx);
+
+        /* scan: v[i] = b[i] + a * b[i-1] + a^2 * b[i-2] + ... */
+        __m256 v = _mm256_fmadd_ps (cv[s].c, x, x_prev);
+        v = _mm256_fmadd_ps (cv[s].a, _mm256_blend_ps (_mm256_permutevar8x32_ps (v, shift1_idx), zero, 0x01), v);
+        v = _mm256_fmadd_ps (cv[s].a2, _mm256_blend_ps (_mm256_permutevar8x32_ps (v, shift2_idx), zero, 0x03), v);
+        v = _mm256_fmadd_ps (cv[s].a4, _mm256_permute2f128_ps (v, v, 0x08), v);
+
+        x = _mm256_fmadd_ps (cv[s].a_pow, state_v[s + 1], v);
+      }
+    state_v[NS] = _mm256_permutevar8x32_ps (x, last_idx);
+    return x;
+  }
+#endif
+};
+
+#ifdef PANDA_RESAMPLER_AVX2
+/*
+ * IIR upsampler using time-parallel evaluation (see IIRParallelBranch); this
+ * is only used with AVX2, since for SSE, the time-parallel evaluation needs
+ * as many instructions per sample as the sequential hiir code, which processes
+ * both branches in one vector
+ */
+template<uint ORDER>
+class Resampler2::IIRUpsampler2Parallel final : public Resampler2::Impl {
+  IIRParallelBranch<(ORDER + 1) / 2> even; /* coefficients 0, 2, 4, ... -> output[2 * i] */
+  IIRParallelBranch<ORDER / 2>       odd;  /* coefficients 1, 3, 5, ... -> output[2 * i + 1] */
+  std::array<double, ORDER> coeffs_;
+  double delay_;
+
+  /* returns the number of input samples processed */
+  PANDA_RESAMPLER_TARGET_AVX2
+  uint
+  process_block_avx (const float *input, uint n_input_samples, float *output)
+  {
+    typename decltype (even)::CoeffsAVX even_c[(ORDER + 1) / 2];
+    typename decltype (odd)::CoeffsAVX  odd_c[ORDER / 2 + 1];
+    even.coeffs_avx (even_c);
+    odd.coeffs_avx (odd_c);
+
+    __m256 even_s[(ORDER + 1) / 2 + 1], odd_s[ORDER / 2 + 1];
+    for (uint s = 0; s < even.state.size(); s++)
+      even_s[s] = _mm256_set1_ps (even.state[s]);
+    for (uint s = 0; s < odd.state.size(); s++)
+      odd_s[s] = _mm256_set1_ps (odd.state[s]);
+
+    uint i = 0;
+    while (i + 8 <= n_input_samples)
+      {
+        const __m256 x = _mm256_loadu_ps (&input[i]);
+        const __m256 y_even = even.process_8samples_avx (x, even_s, even_c);
+        const __m256 y_odd  = odd.process_8samples_avx (x, odd_s, odd_c);
+
+        const __m256 lo = _mm256_unpacklo_ps (y_even, y_odd);
+        const __m256 hi = _mm256_unpackhi_ps (y_even, y_odd);
+        _mm256_storeu_ps (&output[i * 2], _mm256_permute2f128_ps (lo, hi, 0x20));
+        _mm256_storeu_ps (&output[i * 2 + 8], _mm256_permute2f128_ps (lo, hi, 0x31));
+        i += 8;
+      }
+    for (uint s = 0; s < even.state.size(); s++)
+      even.state[s] = _mm256_cvtss_f32 (even_s[s]);
+    for (uint s = 0; s < odd.state.size(); s++)
+      odd.state[s] = _mm256_cvtss_f32 (odd_s[s]);
+    return i;
+  }
+  /* used for the remaining samples after process_block_avx */
+  uint
+  process_block_sse (const float *input, uint n_input_samples, float *output)
+  {
+    typename decltype (even)::CoeffsSSE even_c[(ORDER + 1) / 2];
+    typename decltype (odd)::CoeffsSSE  odd_c[ORDER / 2 + 1];
+    even.coeffs_sse (even_c);
+    odd.coeffs_sse (odd_c);
+
+    __m128 even_s[(ORDER + 1) / 2 + 1], odd_s[ORDER / 2 + 1];
+    for (uint s = 0; s < even.state.size(); s++)
+      even_s[s] = _mm_set1_ps (even.state[s]);
+    for (uint s = 0; s < odd.state.size(); s++)
+      odd_s[s] = _mm_set1_ps (odd.state[s]);
+
+    uint i = 0;
+    while (i + 4 <= n_input_samples)
+      {
+        const __m128 x = _mm_loadu_ps (&input[i]);
+        const __m128 y_even = even.process_4samples_sse (x, even_s, even_c);
+        const __m128 y_odd  = odd.process_4samples_sse (x, odd_s, odd_c);
+
+        _mm_storeu_ps (&output[i * 2], _mm_unpacklo_ps (y_even, y_odd));
+        _mm_storeu_ps (&output[i * 2 + 4], _mm_unpackhi_ps (y_even, y_odd));
+        i += 4;
+      }
+    for (uint s = 0; s < even.state.size(); s++)
+      even.state[s] = _mm_cvtss_f32 (even_s[s]);
+    for (uint s = 0; s < odd.state.size(); s++)
+      odd.state[s] = _mm_cvtss_f32 (odd_s[s]);
+    return i;
+  }
+public:
+  IIRUpsampler2Parallel (const double *coeffs, double group_delay) :
+    delay_ (group_delay)
+  {
+    even.set_coefs (coeffs);
+    odd.set_coefs (coeffs + 1);
+    std::copy (coeffs, coeffs + ORDER, coeffs_.begin());
+  }
+  void
+  process_block (const float *input, uint n_input_samples, float *output) override
+  {
+    uint i = process_block_avx (input, n_input_samples, output);
+    i += process_block_sse (&input[i], n_input_samples - i, &output[i * 2]);
+    while (i < n_input_samples)
+      {
+        output[i * 2]     = even.process_sample (input[i]);
+        output[i * 2 + 1] = odd.process_sample (input[i]);
+        i++;
+      }
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    even.reset();
+    odd.reset();
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    /* double precision samples are processed sequentially */
+    return new DoubleIIRUpsampler2<IIRUpsampler2F64<ORDER>> (coeffs_.data());
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+
+/*
+ * IIR downsampler using time-parallel evaluation (see IIRParallelBranch)
+ */
+template<uint ORDER>
+class Resampler2::IIRDownsampler2Parallel final : public Resampler2::Impl {
+  IIRParallelBranch<(ORDER + 1) / 2> even; /* coefficients 0, 2, 4, ... <- input[2 * i + 1] */
+  IIRParallelBranch<ORDER / 2>       odd;  /* coefficients 1, 3, 5, ... <- input[2 * i] */
+  std::array<double, ORDER> coeffs_;
+  double delay_;
+
+  /* returns the number of output samples computed */
+  PANDA_RESAMPLER_TARGET_AVX2
+  uint
+  process_block_avx (const float *input, uint n_output_samples, float *output)
+  {
+    typename decltype (even)::CoeffsAVX even_c[(ORDER + 1) / 2];
+    typename decltype (odd)::CoeffsAVX  odd_c[ORDER / 2 + 1];
+    even.coeffs_avx (even_c);
+    odd.coeffs_avx (odd_c);
+
+    __m256 even_s[(ORDER + 1) / 2 + 1], odd_s[ORDER / 2 + 1];
+    for (uint s = 0; s < even.state.size(); s++)
+      even_s[s] = _mm256_set1_ps (even.state[s]);
+    for (uint s = 0; s < odd.state.size(); s++)
+      odd_s[s] = _mm256_set1_ps (odd.state[s]);
+
+    const __m256 half = _mm256_set1_ps (0.5f);
+
+    uint i = 0;
+    while (i + 8 <= n_output_samples)
+      {
+        /* deinterleave 16 input samples into even and odd input samples */
+        const __m256 in_0 = _mm256_loadu_ps (&input[i * 2]);
+        const __m256 in_1 = _mm256_loadu_ps (&input[i * 2 + 8]);
+        const __m256 x_0 = _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (_mm256_shuffle_ps (in_0, in_1, _MM_SHUFFLE (2, 0, 2, 0))), 0xd8));
+        const __m256 x_1 = _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (_mm256_shuffle_ps (in_0, in_1, _MM_SHUFFLE (3, 1, 3, 1))), 0xd8));
+
+        const __m256 y_odd  = odd.process_8samples_avx (x_0, odd_s, odd_c);
+        const __m256 y_even = even.process_8samples_avx (x_1, even_s, even_c);
+        _mm256_storeu_ps (&output[i], _mm256_mul_ps (_mm256_add_ps (y_odd, y_even), half));
+        i += 8;
+      }
+    for (uint s = 0; s < even.state.size(); s++)
+      even.state[s] = _mm256_cvtss_f32 (even_s[s]);
+    for (uint s = 0; s < odd.state.size(); s++)
+      odd.state[s] = _mm256_cvtss_f32 (odd_s[s]);
+    return i;
+  }
+  /* used for the remaining samples after process_block_avx */
+  uint
+  process_block_sse (const float *input, uint n_output_samples, float *output)
+  {
+    typename decltype (even)::CoeffsSSE even_c[(ORDER + 1) / 2];
+    typename decltype (odd)::CoeffsSSE  odd_c[ORDER / 2 + 1];
+    even.coeffs_sse (even_c);
+    odd.coeffs_sse (odd_c);
+
+    __m128 even_s[(ORDER + 1) / 2 + 1], odd_s[ORDER / 2 + 1];
+    for (uint s = 0; s < even.state.size(); s++)
+      even_s[s] = _mm_set1_ps (even.state[s]);
+    for (uint s = 0; s < odd.state.size(); s++)
+      odd_s[s] = _mm_set1_ps (odd.state[s]);
+
+    const __m128 half = _mm_set1_ps (0.5f);
+
+    uint i = 0;
+    while (i + 4 <= n_output_samples)
+      {
+        /* deinterleave 8 input samples into even and odd input samples */
+        const __m128 in_0 = _mm_loadu_ps (&input[i * 2]);
+        const __m128 in_1 = _mm_loadu_ps (&input[i * 2 + 4]);
+        const __m128 x_0 = _mm_shuffle_ps (in_0, in_1, _MM_SHUFFLE (2, 0, 2, 0));
+        const __m128 x_1 = _mm_shuffle_ps (in_0, in_1, _MM_SHUFFLE (3, 1, 3, 1));
+
+        const __m128 y_odd  = odd.process_4samples_sse (x_0, odd_s, odd_c);
+        const __m128 y_even = even.process_4samples_sse (x_1, even_s, even_c);
+        _mm_storeu_ps (&output[i], _mm_mul_ps (_mm_add_ps (y_odd, y_even), half));
+        i += 4;
+      }
+    for (uint s = 0; s < even.state.size(); s++)
+      even.state[s] = _mm_cvtss_f32 (even_s[s]);
+    for (uint s = 0; s < odd.state.size(); s++)
+      odd.state[s] = _mm_cvtss_f32 (odd_s[s]);
+    return i;
+  }
+public:
+  IIRDownsampler2Parallel (const double *coeffs, double group_delay) :
+    delay_ ((group_delay - 1) / 2)
+  {
+    even.set_coefs (coeffs);
+    odd.set_coefs (coeffs + 1);
+    std::copy (coeffs, coeffs + ORDER, coeffs_.begin());
+  }
+  void
+  process_block (const float *input, uint n_input_samples, float *output) override
+  {
+    const uint n_output_samples = n_input_samples / 2;
+
+    uint i = process_block_avx (input, n_output_samples, output);
+    i += process_block_sse (&input[i * 2], n_output_samples - i, &output[i]);
+    while (i < n_output_samples)
+      {
+        const float y_odd  = odd.process_sample (input[i * 2]);
+        const float y_even = even.process_sample (input[i * 2 + 1]);
+        output[i] = (y_odd + y_even) * 0.5f;
+        i++;
+      }
+  }
   uint
   order() const override
   {
@@ -669,424 +5031,1016 @@ public:
   double
   delay() const override
   {
-    return order() / 2 - 0.5;
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    even.reset();
+    odd.reset();
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    /* double precision samples are processed sequentially */
+    return new DoubleIIRDownsampler2<IIRDownsampler2F64<ORDER>> (coeffs_.data());
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+#endif /* PANDA_RESAMPLER_AVX2 */
+
+#ifdef PANDA_RESAMPLER_AVX2
+/*
+ * IIR downsampler for 8 channels, which are processed in parallel (one
+ * channel per AVX vector lane)
+ */
+template<uint ORDER>
+class Resampler2::IIRDownsampler2x8AVX final : public Resampler2::Impl {
+  AlignedArray<hiir::Downsampler2x8Avx<ORDER>> downs; /* needs 32-byte alignment */
+  double delay_;
+
+  PANDA_RESAMPLER_TARGET_AVX2
+  void
+  process_block_avx (const float * const *input, uint n_output_samples, float * const *output)
+  {
+    hiir::Downsampler2x8Avx<ORDER>& d = downs[0];
+
+    uint i = 0;
+    while (i + 8 <= n_output_samples)
+      {
+        /* transpose planar input, so that in_v[k] contains input sample 2 * i + k of each channel */
+        __m256 in_v[16];
+        for (uint c = 0; c < 8; c++)
+          {
+            in_v[c]     = _mm256_loadu_ps (&input[c][i * 2]);
+            in_v[c + 8] = _mm256_loadu_ps (&input[c][i * 2 + 8]);
+          }
+        transpose_8x8_avx (&in_v[0]);
+        transpose_8x8_avx (&in_v[8]);
+
+        __m256 out_v[8];
+        for (uint k = 0; k < 8; k++)
+          out_v[k] = d.process_sample (in_v[k * 2], in_v[k * 2 + 1]);
+
+        transpose_8x8_avx (out_v);
+        for (uint c = 0; c < 8; c++)
+          _mm256_storeu_ps (&output[c][i], out_v[c]);
+        i += 8;
+      }
+    while (i < n_output_samples)
+      {
+        alignas (32) float in[16];
+        alignas (32) float out[8];
+        for (uint c = 0; c < 8; c++)
+          {
+            in[c]     = input[c][i * 2];
+            in[c + 8] = input[c][i * 2 + 1];
+          }
+        _mm256_store_ps (out, d.process_sample (in));
+        for (uint c = 0; c < 8; c++)
+          output[c][i] = out[c];
+        i++;
+      }
+  }
+  PANDA_RESAMPLER_TARGET_AVX2
+  void
+  process_block_interleaved_avx (const float *input, uint n_output_frames, float *output)
+  {
+    hiir::Downsampler2x8Avx<ORDER>& d = downs[0];
+
+    /* interleaved frames are the native data layout of the filter, no transposing necessary */
+    for (uint i = 0; i < n_output_frames; i++)
+      _mm256_storeu_ps (&output[i * 8], d.process_sample (_mm256_loadu_ps (&input[i * 16]), _mm256_loadu_ps (&input[i * 16 + 8])));
+  }
+public:
+  IIRDownsampler2x8AVX (const double *coeffs, double group_delay) :
+    downs (1),
+    delay_ ((group_delay - 1) / 2)
+  {
+    downs[0].set_coefs (coeffs);
+  }
+  void
+  process_block (const float *, uint, float *) override
+  {
+    PANDA_RESAMPLER_CHECK (false); // only planar multi-channel processing is supported
+  }
+  void
+  process_block_planar (const float * const *input, uint n_input_samples, float * const *output) override
+  {
+    process_block_avx (input, n_input_samples / 2, output);
+  }
+  void
+  process_block_interleaved (const float *input, uint n_input_frames, float *output) override
+  {
+    process_block_interleaved_avx (input, n_input_frames / 2, output);
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
+  }
+  void
+  reset() override
+  {
+    downs[0].clear_buffers();
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+
+/*
+ * IIR upsampler for 8 channels, which are processed in parallel (one
+ * channel per AVX vector lane)
+ */
+template<uint ORDER>
+class Resampler2::IIRUpsampler2x8AVX final : public Resampler2::Impl {
+  AlignedArray<hiir::Upsampler2x8Avx<ORDER>> ups; /* needs 32-byte alignment */
+  double delay_;
+
+  PANDA_RESAMPLER_TARGET_AVX2
+  void
+  process_block_avx (const float * const *input, uint n_input_samples, float * const *output)
+  {
+    hiir::Upsampler2x8Avx<ORDER>& u = ups[0];
+
+    uint i = 0;
+    while (i + 8 <= n_input_samples)
+      {
+        /* transpose planar input, so that in_v[k] contains input sample i + k of each channel */
+        __m256 in_v[8];
+        for (uint c = 0; c < 8; c++)
+          in_v[c] = _mm256_loadu_ps (&input[c][i]);
+        transpose_8x8_avx (in_v);
+
+        __m256 out_v[16];
+        for (uint k = 0; k < 8; k++)
+          u.process_sample (out_v[k * 2], out_v[k * 2 + 1], in_v[k]);
+
+        transpose_8x8_avx (&out_v[0]);
+        transpose_8x8_avx (&out_v[8]);
+        for (uint c = 0; c < 8; c++)
+          {
+            _mm256_storeu_ps (&output[c][i * 2], out_v[c]);
+            _mm256_storeu_ps (&output[c][i * 2 + 8], out_v[c + 8]);
+          }
+        i += 8;
+      }
+    while (i < n_input_samples)
+      {
+        alignas (32) float in[8];
+        alignas (32) float out[16];
+        for (uint c = 0; c < 8; c++)
+          in[c] = input[c][i];
+
+        __m256 out_0, out_1;
+        u.process_sample (out_0, out_1, _mm256_load_ps (in));
+        _mm256_store_ps (&out[0], out_0);
+        _mm256_store_ps (&out[8], out_1);
+        for (uint c = 0; c < 8; c++)
+          {
+            output[c][i * 2]     = out[c];
+            output[c][i * 2 + 1] = out[c + 8];
+          }
+        i++;
+      }
+  }
+  PANDA_RESAMPLER_TARGET_AVX2
+  void
+  process_block_interleaved_avx (const float *input, uint n_input_frames, float *output)
+  {
+    hiir::Upsampler2x8Avx<ORDER>& u = ups[0];
+
+    /* interleaved frames are the native data layout of the filter, no transposing necessary */
+    for (uint i = 0; i < n_input_frames; i++)
+      {
+        __m256 out_0, out_1;
+        u.process_sample (out_0, out_1, _mm256_loadu_ps (&input[i * 8]));
+        _mm256_storeu_ps (&output[i * 16], out_0);
+        _mm256_storeu_ps (&output[i * 16 + 8], out_1);
+      }
+  }
+public:
+  IIRUpsampler2x8AVX (const double *coeffs, double group_delay) :
+    ups (1),
+    delay_ (group_delay)
+  {
+    ups[0].set_coefs (coeffs);
+  }
+  void
+  process_block (const float *, uint, float *) override
+  {
+    PANDA_RESAMPLER_CHECK (false); // only planar multi-channel processing is supported
+  }
+  void
+  process_block_planar (const float * const *input, uint n_input_samples, float * const *output) override
+  {
+    process_block_avx (input, n_input_samples, output);
+  }
+  void
+  process_block_interleaved (const float *input, uint n_input_frames, float *output) override
+  {
+    process_block_interleaved_avx (input, n_input_frames, output);
+  }
+  uint
+  order() const override
+  {
+    return ORDER;
+  }
+  double
+  delay() const override
+  {
+    return delay_;
   }
   void
   reset() override
   {
-    std::fill (history_even.begin(), history_even.end(), 0.0);
-    std::fill (history_odd.begin(), history_odd.end(), 0.0);
+    ups[0].clear_buffers();
+  }
+  bool
+  sse_enabled() const override
+  {
+    return true;
+  }
+};
+#endif /* PANDA_RESAMPLER_AVX2 */
+
+Resampler2::Impl*
+Resampler2::create_impl_iir (uint stage_ratio)
+{
+  // START generated code
+  constexpr std::array<double,3> coeffs2_8 = {
+    0.13533476491166646,
+    0.44459059808236606,
+    0.80006724816152464,
+  };
+  if (stage_ratio == 2 && precision_ == PREC_48DB)
+    return create_impl_iir_with_coeffs (coeffs2_8, 1.749694);
+
+  constexpr std::array<double,2> coeffs4_8 = {
+    0.12564829488677751,
+    0.56413565549879052,
+  };
+  if (stage_ratio == 4 && precision_ == PREC_48DB)
+    return create_impl_iir_with_coeffs (coeffs4_8, 1.554290);
+
+  constexpr std::array<double,1> coeffs8_8 = {
+    0.34210403268814876,
+  };
+  if (stage_ratio == 8 && precision_ == PREC_48DB)
+    return create_impl_iir_with_coeffs (coeffs8_8, 0.980631);
+
+  constexpr std::array<double,5> coeffs2_12 = {
+    0.057369561854075074,
+    0.2095436081316879,
+    0.41352768544651608,
+    0.6351349011042412,
+    0.86943780167618079,
+  };
+  if (stage_ratio == 2 && precision_ == PREC_72DB)
+    return create_impl_iir_with_coeffs (coeffs2_12, 2.758511);
+
+  constexpr std::array<double,3> coeffs4_12 = {
+    0.063242386110162196,
+    0.26520245698601469,
+    0.66713594063634607,
+  };
+  if (stage_ratio == 4 && precision_ == PREC_72DB)
+    return create_impl_iir_with_coeffs (coeffs4_12, 2.162389);
+
+  constexpr std::array<double,2> coeffs8_12 = {
+    0.11010398332301433,
+    0.53640535169046299,
+  };
+  if (stage_ratio == 8 && precision_ == PREC_72DB)
+    return create_impl_iir_with_coeffs (coeffs8_12, 1.603448);
+
+  constexpr std::array<double,6> coeffs2_16 = {
+    0.041451595119442179,
+    0.15510356876083609,
+    0.31565680487417447,
+    0.49770230748789734,
+    0.68754139898746236,
+    0.88864894857989574,
+  };
+  if (stage_ratio == 2 && precision_ == PREC_96DB)
+    return create_impl_iir_with_coeffs (coeffs2_16, 3.258518);
+
+  constexpr std::array<double,3> coeffs4_16 = {
+    0.063242386110162196,
+    0.26520245698601469,
+    0.66713594063634607,
+  };
+  if (stage_ratio == 4 && precision_ == PREC_96DB)
+    return create_impl_iir_with_coeffs (coeffs4_16, 2.162389);
+
+  constexpr std::array<double,2> coeffs8_16 = {
+    0.11010398332301433,
+    0.53640535169046299,
+  };
+  if (stage_ratio == 8 && precision_ == PREC_96DB)
+    return create_impl_iir_with_coeffs (coeffs8_16, 1.603448);
+
+  constexpr std::array<double,8> coeffs2_20 = {
+    0.024474822059978408,
+    0.094054346501929856,
+    0.19872162695194262,
+    0.32597599445882591,
+    0.46482603848881743,
+    0.60862663328164524,
+    0.75647898374965283,
+    0.91392075106875681,
+  };
+  if (stage_ratio == 2 && precision_ == PREC_120DB)
+    return create_impl_iir_with_coeffs (coeffs2_20, 4.258575);
+
+  constexpr std::array<double,4> coeffs4_20 = {
+    0.03806054747623356,
+    0.15621232623983866,
+    0.37118048037198415,
+    0.73087698794653666,
+  };
+  if (stage_ratio == 4 && precision_ == PREC_120DB)
+    return create_impl_iir_with_coeffs (coeffs4_20, 2.771786);
+
+  constexpr std::array<double,3> coeffs8_20 = {
+    0.054591151801747943,
+    0.23954799102035762,
+    0.64335720472138391,
+  };
+  if (stage_ratio == 8 && precision_ == PREC_120DB)
+    return create_impl_iir_with_coeffs (coeffs8_20, 2.227224);
+
+  constexpr std::array<double,9> coeffs2_24 = {
+    0.01964694276744065,
+    0.076088803821783499,
+    0.16263241326637887,
+    0.2704225137521028,
+    0.39083229614395837,
+    0.51740920918216626,
+    0.6470358330763375,
+    0.7804624622392915,
+    0.92268241849452293,
+  };
+  if (stage_ratio == 2 && precision_ == PREC_144DB)
+    return create_impl_iir_with_coeffs (coeffs2_24, 4.758752);
+
+  constexpr std::array<double,5> coeffs4_24 = {
+    0.025414320818611134,
+    0.10332655701804375,
+    0.24011358015046655,
+    0.45161232259950512,
+    0.77416388521132473,
+  };
+  if (stage_ratio == 4 && precision_ == PREC_144DB)
+    return create_impl_iir_with_coeffs (coeffs4_24, 3.382479);
+
+  constexpr std::array<double,3> coeffs8_24 = {
+    0.054591151801747943,
+    0.23954799102035762,
+    0.64335720472138391,
+  };
+  if (stage_ratio == 8 && precision_ == PREC_144DB)
+    return create_impl_iir_with_coeffs (coeffs8_24, 2.227224);
+  // END generated code
+  return 0;
+}
+
+PANDA_RESAMPLER_FN
+Resampler2::Impl*
+Resampler2::create_impl_iir_cascade()
+{
+  /* orders of the x2, x4 and x8 stages, see create_impl_iir() */
+  switch (precision_)
+    {
+      case PREC_48DB:   return create_impl_iir_cascade<3, 2, 1>();
+      case PREC_72DB:   return create_impl_iir_cascade<5, 3, 2>();
+      case PREC_96DB:   return create_impl_iir_cascade<6, 3, 2>();
+      case PREC_120DB:  return create_impl_iir_cascade<8, 4, 3>();
+      case PREC_144DB:  return create_impl_iir_cascade<9, 5, 3>();
+      default:          return nullptr;
+    }
+}
+
+template<uint N2, uint N4, uint N8>
+inline Resampler2::Impl*
+Resampler2::create_impl_iir_cascade()
+{
+#ifdef PANDA_RESAMPLER_SIMD
+  PANDA_RESAMPLER_CHECK (impl_x2->order() == N2 && impl_x4->order() == N4);
+  PANDA_RESAMPLER_CHECK (ratio_ == 4 || impl_x8->order() == N8);
+
+  /* the cascade uses the same coefficients as the individual stages */
+  if (mode_ == UP)
+    {
+      return new IIRUpsamplerCascadeSSE<N2, N4, N8> (ratio_,
+        static_cast<IIRUpsampler2SSE<N2> *> (impl_x2.get())->coeffs(),
+        static_cast<IIRUpsampler2SSE<N4> *> (impl_x4.get())->coeffs(),
+        ratio_ == 8 ? static_cast<IIRUpsampler2SSE<N8> *> (impl_x8.get())->coeffs() : nullptr,
+        delay());
+    }
+  else
+    {
+      return new IIRDownsamplerCascadeSSE<N2, N4, N8> (ratio_,
+        static_cast<IIRDownsampler2SSE<N2> *> (impl_x2.get())->coeffs(),
+        static_cast<IIRDownsampler2SSE<N4> *> (impl_x4.get())->coeffs(),
+        ratio_ == 8 ? static_cast<IIRDownsampler2SSE<N8> *> (impl_x8.get())->coeffs() : nullptr,
+        delay());
+    }
+#else
+  return nullptr;
+#endif
+}
+
+template<class CArray>
+inline Resampler2::Impl*
+Resampler2::create_impl_iir_with_coeffs (const CArray& carray, double group_delay)
+{
+  constexpr uint n_coeffs = std::tuple_size<CArray>::value;
+
+#ifdef PANDA_RESAMPLER_AVX2
+  if (filter_ == FILTER_IIR_PARALLEL && iset_ == ISET_AVX2)
+    {
+      if (mode_ == UP)
+        return new IIRUpsampler2Parallel<n_coeffs> (carray.data(), group_delay);
+      else
+        return new IIRDownsampler2Parallel<n_coeffs> (carray.data(), group_delay);
+    }
+  if (filter_ == FILTER_IIR && iset_ == ISET_AVX2 && channels_ == 8)
+    {
+      if (mode_ == UP)
+        return new IIRUpsampler2x8AVX<n_coeffs> (carray.data(), group_delay);
+      else
+        return new IIRDownsampler2x8AVX<n_coeffs> (carray.data(), group_delay);
+    }
+#endif
+#ifdef PANDA_RESAMPLER_SIMD
+  if (multi_channel_iir_sse())
+    {
+      if (mode_ == UP)
+        return new IIRUpsampler2x2SSE<n_coeffs> (carray.data(), group_delay);
+      else
+        return new IIRDownsampler2x2SSE<n_coeffs> (carray.data(), group_delay);
+    }
+  if (iset_ != ISET_FPU)
+    {
+      if (mode_ == UP)
+        return new IIRUpsampler2SSE<n_coeffs> (carray.data(), group_delay);
+      else
+        return new IIRDownsampler2SSE<n_coeffs> (carray.data(), group_delay);
+    }
+  else
+#endif
+    {
+      if (mode_ == UP)
+        return new IIRUpsampler2<n_coeffs> (carray.data(), group_delay);
+      else
+        return new IIRDownsampler2<n_coeffs> (carray.data(), group_delay);
+    }
+}
+
+PANDA_RESAMPLER_FN
+bool
+Resampler2::test_filter_impl (bool verbose)
+{
+  if (sse_available())
+    {
+      bool ok = fir_test_filter_sse (verbose);
+#ifdef PANDA_RESAMPLER_AVX2
+      if (instruction_set_available() == ISET_AVX2)
+        ok = fir_test_filter_avx (verbose) && ok;
+#endif
+      return ok;
+    }
+  else
+    {
+      if (verbose)
+        printf ("SSE filter implementation not tested: no SSE support available\n");
+      return true;
+    }
+}
+
+/* --- double precision --- */
+
+/* loads four consecutive samples, p doesn't need to be aligned
+ *
+ * (vectors are returned by reference, since returning 32-byte vectors by value
+ * depends on whether AVX is enabled)
+ */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+double_lanes_load (DoubleLanes& v, const double *p)
+{
+  memcpy (&v, p, sizeof (v));
+}
+
+/* v = p[0..3] + q[0..3] (for symmetric filters) */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+double_lanes_load_sum (DoubleLanes& v, const double *p, const double *q)
+{
+  DoubleLanes w;
+  double_lanes_load (v, p);
+  double_lanes_load (w, q);
+  v += w;
+}
+
+/* multiply-add for the generic kernels: acc += a * b */
+struct DoubleMath {
+  static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+  madd (DoubleLanes& acc, const DoubleLanes& a, const DoubleLanes& b)
+  {
+    acc += a * b;
   }
-  bool
-  sse_enabled() const override
+};
+
+#ifdef PANDA_RESAMPLER_AVX2
+/* multiply-add for the AVX2 kernels */
+struct DoubleMathFMA {
+  static PANDA_RESAMPLER_TARGET_AVX2 inline void
+  madd (DoubleLanes& acc, const DoubleLanes& a, const DoubleLanes& b)
   {
-    return USE_SSE;
+    acc = _mm256_fmadd_pd (a, b, acc);
   }
 };
+#endif
 
-template<bool USE_SSE> Resampler2::Impl*
-Resampler2::create_impl (uint stage_ratio)
-{
-  // START generated code
-  static constexpr double coeffs2_24[52] =
-  {
-    -1.896649020687189e-07,
-    8.9375397078734594e-07,
-    -2.9108958281584469e-06,
-    7.7609698680954118e-06,
-    -1.8119956302920787e-05,
-    3.8375105842230682e-05,
-    -7.5309071659470099e-05,
-    0.00013889694095199994,
-    -0.00024318689587188649,
-    0.00040722732084584021,
-    -0.00065600665137277646,
-    0.001021395018417595,
-    -0.0015431295374089733,
-    0.0022699842719303941,
-    -0.0032614400850958444,
-    0.0045904754831414861,
-    -0.0063486601639801904,
-    0.0086558345711950594,
-    -0.011679015470590512,
-    0.015670714074410223,
-    -0.021051408534455165,
-    0.028604536062639324,
-    -0.040008178410666853,
-    0.059644444619411124,
-    -0.10364569487012831,
-    0.31748269557078473,
-    0.31748269557078473,
-    -0.10364569487012831,
-    0.059644444619411124,
-    -0.040008178410666853,
-    0.028604536062639324,
-    -0.021051408534455165,
-    0.015670714074410223,
-    -0.011679015470590512,
-    0.0086558345711950594,
-    -0.0063486601639801904,
-    0.0045904754831414861,
-    -0.0032614400850958444,
-    0.0022699842719303941,
-    -0.0015431295374089733,
-    0.001021395018417595,
-    -0.00065600665137277646,
-    0.00040722732084584021,
-    -0.00024318689587188649,
-    0.00013889694095199994,
-    -7.5309071659470099e-05,
-    3.8375105842230682e-05,
-    -1.8119956302920787e-05,
-    7.7609698680954118e-06,
-    -2.9108958281584469e-06,
-    8.9375397078734594e-07,
-    -1.896649020687189e-07,
-  };
-  if (stage_ratio == 2 && precision_ == 24 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<52, USE_SSE> > (coeffs2_24, 52, 2.0);
-  if (stage_ratio == 2 && precision_ == 24 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<52, USE_SSE> > (coeffs2_24, 52, 1.0);
-  static constexpr double coeffs4_24[16] =
-  {
-    -7.8113862062895476e-06,
-    0.00011777177340253331,
-    -0.00080979027642968178,
-    0.0035914299596685019,
-    -0.011907675232141868,
-    0.032618531462663004,
-    -0.083680449562963555,
-    0.31007801153486508,
-    0.31007801153486508,
-    -0.083680449562963555,
-    0.032618531462663004,
-    -0.011907675232141868,
-    0.0035914299596685019,
-    -0.00080979027642968178,
-    0.00011777177340253331,
-    -7.8113862062895476e-06,
-  };
-  if (stage_ratio == 4 && precision_ == 24 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<16, USE_SSE> > (coeffs4_24, 16, 2.0);
-  if (stage_ratio == 4 && precision_ == 24 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<16, USE_SSE> > (coeffs4_24, 16, 1.0);
-  static constexpr double coeffs8_24[12] =
-  {
-    -3.0345557546583312e-05,
-    0.00057384655742621254,
-    -0.0043830674681261195,
-    0.020226878808907018,
-    -0.070915964811982507,
-    0.30452864347609143,
-    0.30452864347609143,
-    -0.070915964811982507,
-    0.020226878808907018,
-    -0.0043830674681261195,
-    0.00057384655742621254,
-    -3.0345557546583312e-05,
-  };
-  if (stage_ratio == 8 && precision_ == 24 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<12, USE_SSE> > (coeffs8_24, 12, 2.0);
-  if (stage_ratio == 8 && precision_ == 24 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<12, USE_SSE> > (coeffs8_24, 12, 1.0);
-  static constexpr double coeffs2_20[42] =
-  {
-    2.4629216796772203e-06,
-    -9.7990456966301657e-06,
-    2.8137964376908064e-05,
-    -6.7464881821884139e-05,
-    0.00014336862073315604,
-    -0.000278702763263149,
-    0.00050528391212770792,
-    -0.00086555167177917124,
-    0.001414202687011217,
-    -0.0022199926486379607,
-    0.003368236285452741,
-    -0.0049651473206043309,
-    0.0071463283371987034,
-    -0.010094148846828722,
-    0.014074361299068285,
-    -0.019516906264665349,
-    0.0272094990821482,
-    -0.038828382182376338,
-    0.058747406804456566,
-    -0.10308466896169781,
-    0.31729177522077334,
-    0.31729177522077334,
-    -0.10308466896169781,
-    0.058747406804456566,
-    -0.038828382182376338,
-    0.0272094990821482,
-    -0.019516906264665349,
-    0.014074361299068285,
-    -0.010094148846828722,
-    0.0071463283371987034,
-    -0.0049651473206043309,
-    0.003368236285452741,
-    -0.0022199926486379607,
-    0.001414202687011217,
-    -0.00086555167177917124,
-    0.00050528391212770792,
-    -0.000278702763263149,
-    0.00014336862073315604,
-    -6.7464881821884139e-05,
-    2.8137964376908064e-05,
-    -9.7990456966301657e-06,
-    2.4629216796772203e-06,
-  };
-  if (stage_ratio == 2 && precision_ == 20 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<42, USE_SSE> > (coeffs2_20, 42, 2.0);
-  if (stage_ratio == 2 && precision_ == 20 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<42, USE_SSE> > (coeffs2_20, 42, 1.0);
-  static constexpr double coeffs4_20[14] =
+/*
+ * Double precision FIR upsampling stage, computes the same output as
+ * Upsampler2 (for symmetric taps); the vectorized kernel computes four
+ * consecutive output samples per vector
+ */
+template<uint ORDER>
+class Resampler2::DoubleFIRUpsampler2 final : public Resampler2::DoubleImpl {
+  static constexpr uint H = ORDER / 2; /* half the filter length */
+  static constexpr uint BLOCK_SIZE = 256;
+
+  const std::shared_ptr<const DoubleFIRTaps> taps_; /* uses the first half of the lanes */
+  const InstructionSet                 iset_;
+  double                               history_[ORDER - 1];
+
+  /* x[0]..x[ORDER - 2] is the history, output[2 * i] uses x[i]..x[i + ORDER - 1] */
+  static void
+  process_samples_fpu (const double *x, uint n_samples, const DoubleLanes *taps, double *output)
   {
-    4.3979674631863943e-05,
-    -0.00050306469192140939,
-    0.0027962504087410051,
-    -0.010470114594085408,
-    0.030755143193163859,
-    -0.082041866707154076,
-    0.30941949170527272,
-    0.30941949170527272,
-    -0.082041866707154076,
-    0.030755143193163859,
-    -0.010470114594085408,
-    0.0027962504087410051,
-    -0.00050306469192140939,
-    4.3979674631863943e-05,
-  };
-  if (stage_ratio == 4 && precision_ == 20 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<14, USE_SSE> > (coeffs4_20, 14, 2.0);
-  if (stage_ratio == 4 && precision_ == 20 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<14, USE_SSE> > (coeffs4_20, 14, 1.0);
-  static constexpr double coeffs8_20[10] =
+    for (uint i = 0; i < n_samples; i++)
+      {
+        double acc = (x[i] + x[i + ORDER - 1]) * taps[0][0];
+        for (uint k = 1; k < H; k++)
+          acc += (x[i + k] + x[i + ORDER - 1 - k]) * taps[k][0];
+        output[2 * i] = acc;
+        output[2 * i + 1] = x[i + H];
+      }
+  }
+  template<class Math> static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+  process_samples (const double *x, uint n_samples, const DoubleLanes *taps, double *output)
   {
-    0.00017230594713343064,
-    -0.002551731819446271,
-    0.015994679393099207,
-    -0.06565066677090392,
-    0.30203532650661641,
-    0.30203532650661641,
-    -0.06565066677090392,
-    0.015994679393099207,
-    -0.002551731819446271,
-    0.00017230594713343064,
-  };
-  if (stage_ratio == 8 && precision_ == 20 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<10, USE_SSE> > (coeffs8_20, 10, 2.0);
-  if (stage_ratio == 8 && precision_ == 20 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<10, USE_SSE> > (coeffs8_20, 10, 1.0);
-  static constexpr double coeffs2_16[32] =
+    uint i = 0;
+
+    /* eight samples at once (two independent accumulators) */
+    for (; i + 8 <= n_samples; i += 8)
+      {
+        DoubleLanes acc0, acc1, sum0, sum1;
+        double_lanes_load_sum (sum0, &x[i], &x[i + ORDER - 1]);
+        double_lanes_load_sum (sum1, &x[i + 4], &x[i + 4 + ORDER - 1]);
+        acc0 = sum0 * taps[0];
+        acc1 = sum1 * taps[0];
+        for (uint k = 1; k < H; k++)
+          {
+            double_lanes_load_sum (sum0, &x[i + k], &x[i + ORDER - 1 - k]);
+            double_lanes_load_sum (sum1, &x[i + 4 + k], &x[i + 4 + ORDER - 1 - k]);
+            Math::madd (acc0, sum0, taps[k]);
+            Math::madd (acc1, sum1, taps[k]);
+          }
+        for (uint j = 0; j < 4; j++)
+          {
+            output[2 * (i + j)]         = acc0[j];
+            output[2 * (i + j) + 1]     = x[i + j + H];
+            output[2 * (i + j + 4)]     = acc1[j];
+            output[2 * (i + j + 4) + 1] = x[i + j + 4 + H];
+          }
+      }
+    process_samples_fpu (&x[i], n_samples - i, taps, &output[2 * i]);
+  }
+#ifdef PANDA_RESAMPLER_AVX2
+  static PANDA_RESAMPLER_TARGET_AVX2 void
+  process_samples_avx (const double *x, uint n_samples, const DoubleLanes *taps, double *output)
   {
-    -3.5142734993474452e-05,
-    0.00011358789579768951,
-    -0.00028037958674221312,
-    0.00059293788160310029,
-    -0.0011294540908177168,
-    0.0019917372726928405,
-    -0.0033089217809884803,
-    0.0052441962508097874,
-    -0.0080093910223938553,
-    0.011898075091115748,
-    -0.017362581771322445,
-    0.025204120984314127,
-    -0.037100932061169559,
-    0.057416112765805175,
-    -0.10224463341225128,
-    0.31700464719515836,
-    0.31700464719515836,
-    -0.10224463341225128,
-    0.057416112765805175,
-    -0.037100932061169559,
-    0.025204120984314127,
-    -0.017362581771322445,
-    0.011898075091115748,
-    -0.0080093910223938553,
-    0.0052441962508097874,
-    -0.0033089217809884803,
-    0.0019917372726928405,
-    -0.0011294540908177168,
-    0.00059293788160310029,
-    -0.00028037958674221312,
-    0.00011358789579768951,
-    -3.5142734993474452e-05,
-  };
-  if (stage_ratio == 2 && precision_ == 16 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<32, USE_SSE> > (coeffs2_16, 32, 2.0);
-  if (stage_ratio == 2 && precision_ == 16 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<32, USE_SSE> > (coeffs2_16, 32, 1.0);
-  static constexpr double coeffs4_16[10] =
+    process_samples<DoubleMathFMA> (x, n_samples, taps, output);
+  }
+#endif
+public:
+  DoubleFIRUpsampler2 (const vector<double>& coeffs, InstructionSet iset) :
+    taps_ (fir_shared_layout<DoubleFIRTaps> (coeffs)),
+    iset_ (iset)
   {
-    0.00055713256761683592,
-    -0.0048543666906354314,
-    0.021809335002826412,
-    -0.073141515220609826,
-    0.30562814686107148,
-    0.30562814686107148,
-    -0.073141515220609826,
-    0.021809335002826412,
-    -0.0048543666906354314,
-    0.00055713256761683592,
-  };
-  if (stage_ratio == 4 && precision_ == 16 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<10, USE_SSE> > (coeffs4_16, 10, 2.0);
-  if (stage_ratio == 4 && precision_ == 16 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<10, USE_SSE> > (coeffs4_16, 10, 1.0);
-  static constexpr double coeffs8_16[8] =
+    reset();
+  }
+  void
+  process_block (const double *input, uint n_input_samples, double *output) override
   {
-    -0.0010885239331601664,
-    0.011649378449320126,
-    -0.059557473859641011,
-    0.29900137394294291,
-    0.29900137394294291,
-    -0.059557473859641011,
-    0.011649378449320126,
-    -0.0010885239331601664,
-  };
-  if (stage_ratio == 8 && precision_ == 16 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<8, USE_SSE> > (coeffs8_16, 8, 2.0);
-  if (stage_ratio == 8 && precision_ == 16 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<8, USE_SSE> > (coeffs8_16, 8, 1.0);
-  static constexpr double coeffs2_12[24] =
+    /* scratch memory: history followed by one block of input */
+    double x[ORDER - 1 + BLOCK_SIZE];
+
+    copy (history_, history_ + ORDER - 1, x);
+    while (n_input_samples)
+      {
+        const uint n_todo_samples = min (uint (BLOCK_SIZE), n_input_samples);
+
+        copy (input, input + n_todo_samples, &x[ORDER - 1]);
+#ifdef PANDA_RESAMPLER_AVX2
+        if (iset_ == ISET_AVX2)
+          process_samples_avx (x, n_todo_samples, &taps_->lanes[0], output);
+        else
+#endif
+        if (iset_ != ISET_FPU)
+          process_samples<DoubleMath> (x, n_todo_samples, &taps_->lanes[0], output);
+        else
+          process_samples_fpu (x, n_todo_samples, &taps_->lanes[0], output);
+
+        copy (&x[n_todo_samples], &x[n_todo_samples + ORDER - 1], x);
+        input += n_todo_samples;
+        output += n_todo_samples * 2;
+        n_input_samples -= n_todo_samples;
+      }
+    copy (x, x + ORDER - 1, history_);
+  }
+  void
+  reset() override
   {
-    -0.00031919473602139891,
-    0.00083854004488146685,
-    -0.0017905303270299995,
-    0.0033731130894814397,
-    -0.0058408892523820347,
-    0.0095314079754320758,
-    -0.014935625615431904,
-    0.022881655727240446,
-    -0.035057791064865292,
-    0.055817399757994692,
-    -0.10122584733772397,
-    0.31665472430452679,
-    0.31665472430452679,
-    -0.10122584733772397,
-    0.055817399757994692,
-    -0.035057791064865292,
-    0.022881655727240446,
-    -0.014935625615431904,
-    0.0095314079754320758,
-    -0.0058408892523820347,
-    0.0033731130894814397,
-    -0.0017905303270299995,
-    0.00083854004488146685,
-    -0.00031919473602139891,
-  };
-  if (stage_ratio == 2 && precision_ == 12 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<24, USE_SSE> > (coeffs2_12, 24, 2.0);
-  if (stage_ratio == 2 && precision_ == 12 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<24, USE_SSE> > (coeffs2_12, 24, 1.0);
-  static constexpr double coeffs4_12[8] =
+    std::fill (history_, history_ + ORDER - 1, 0.0);
+  }
+};
+
+/*
+ * Double precision FIR downsampling stage, computes the same output as
+ * Downsampler2 (for symmetric taps); the input is split into even and odd
+ * samples, so that the kernel can load four consecutive even samples at once
+ */
+template<uint ORDER>
+class Resampler2::DoubleFIRDownsampler2 final : public Resampler2::DoubleImpl {
+  static constexpr uint H = ORDER / 2 - 1; /* half the filter length */
+  static constexpr uint BLOCK_SIZE = 256;  /* output samples */
+
+  const std::shared_ptr<const DoubleFIRTaps> taps_;
+  const InstructionSet                 iset_;
+  double                               history_even_[ORDER - 1];
+  double                               history_odd_[ORDER - 1];
+
+  /* even[0]..even[ORDER - 2] and odd[0]..odd[ORDER - 2] is the history,
+   * output[i] uses even[i]..even[i + ORDER - 1] and odd[i + H]
+   */
+  static void
+  process_samples_fpu (const double *even, const double *odd, uint n_output_samples, const DoubleLanes *taps, double *output)
   {
-    -0.0025910542040449157,
-    0.017312836258421893,
-    -0.068161446853832547,
-    0.30340841235941457,
-    0.30340841235941457,
-    -0.068161446853832547,
-    0.017312836258421893,
-    -0.0025910542040449157,
-  };
-  if (stage_ratio == 4 && precision_ == 12 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<8, USE_SSE> > (coeffs4_12, 8, 2.0);
-  if (stage_ratio == 4 && precision_ == 12 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<8, USE_SSE> > (coeffs4_12, 8, 1.0);
-  static constexpr double coeffs8_12[6] =
+    for (uint i = 0; i < n_output_samples; i++)
+      {
+        double acc = (even[i] + even[i + ORDER - 1]) * taps[0][0];
+        for (uint k = 1; k < ORDER / 2; k++)
+          acc += (even[i + k] + even[i + ORDER - 1 - k]) * taps[k][0];
+        output[i] = acc + odd[i + H] * taps[ORDER / 2][0];
+      }
+  }
+  template<class Math> static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+  process_samples (const double *even, const double *odd, uint n_output_samples, const DoubleLanes *taps, double *output)
   {
-    0.005872148420194066,
-    -0.049275035331134497,
-    0.29336813890765762,
-    0.29336813890765762,
-    -0.049275035331134497,
-    0.005872148420194066,
-  };
-  if (stage_ratio == 8 && precision_ == 12 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<6, USE_SSE> > (coeffs8_12, 6, 2.0);
-  if (stage_ratio == 8 && precision_ == 12 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<6, USE_SSE> > (coeffs8_12, 6, 1.0);
-  static constexpr double coeffs2_8[16] =
+    uint i = 0;
+
+    /* eight samples at once (two independent accumulators) */
+    for (; i + 8 <= n_output_samples; i += 8)
+      {
+        DoubleLanes acc0, acc1, sum0, sum1;
+        double_lanes_load_sum (sum0, &even[i], &even[i + ORDER - 1]);
+        double_lanes_load_sum (sum1, &even[i + 4], &even[i + 4 + ORDER - 1]);
+        acc0 = sum0 * taps[0];
+        acc1 = sum1 * taps[0];
+        for (uint k = 1; k < ORDER / 2; k++)
+          {
+            double_lanes_load_sum (sum0, &even[i + k], &even[i + ORDER - 1 - k]);
+            double_lanes_load_sum (sum1, &even[i + 4 + k], &even[i + 4 + ORDER - 1 - k]);
+            Math::madd (acc0, sum0, taps[k]);
+            Math::madd (acc1, sum1, taps[k]);
+          }
+        double_lanes_load (sum0, &odd[i + H]);
+        double_lanes_load (sum1, &odd[i + 4 + H]);
+        Math::madd (acc0, sum0, taps[ORDER / 2]);
+        Math::madd (acc1, sum1, taps[ORDER / 2]);
+        memcpy (&output[i], &acc0, sizeof (acc0));
+        memcpy (&output[i + 4], &acc1, sizeof (acc1));
+      }
+    process_samples_fpu (&even[i], &odd[i], n_output_samples - i, taps, &output[i]);
+  }
+#ifdef PANDA_RESAMPLER_AVX2
+  static PANDA_RESAMPLER_TARGET_AVX2 void
+  process_samples_avx (const double *even, const double *odd, uint n_output_samples, const DoubleLanes *taps, double *output)
   {
-    -0.0026367453410967019,
-    0.0056954995988467462,
-    -0.010750637983096105,
-    0.018689598049002096,
-    -0.031243628674597745,
-    0.052760932803671098,
-    -0.099248122111822379,
-    0.31597034387100925,
-    0.31597034387100925,
-    -0.099248122111822379,
-    0.052760932803671098,
-    -0.031243628674597745,
-    0.018689598049002096,
-    -0.010750637983096105,
-    0.0056954995988467462,
-    -0.0026367453410967019,
-  };
-  if (stage_ratio == 2 && precision_ == 8 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<16, USE_SSE> > (coeffs2_8, 16, 2.0);
-  if (stage_ratio == 2 && precision_ == 8 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<16, USE_SSE> > (coeffs2_8, 16, 1.0);
-  static constexpr double coeffs4_8[6] =
+    process_samples<DoubleMathFMA> (even, odd, n_output_samples, taps, output);
+  }
+#endif
+public:
+  DoubleFIRDownsampler2 (const vector<double>& coeffs, InstructionSet iset) :
+    taps_ (fir_shared_layout<DoubleFIRTaps> (coeffs)),
+    iset_ (iset)
   {
-    0.013331613494158878,
-    -0.063984766541747701,
-    0.30161384865948221,
-    0.30161384865948221,
-    -0.063984766541747701,
-    0.013331613494158878,
-  };
-  if (stage_ratio == 4 && precision_ == 8 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<6, USE_SSE> > (coeffs4_8, 6, 2.0);
-  if (stage_ratio == 4 && precision_ == 8 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<6, USE_SSE> > (coeffs4_8, 6, 1.0);
-  static constexpr double coeffs8_8[4] =
+    reset();
+  }
+  void
+  process_block (const double *input, uint n_input_samples, double *output) override
+  {
+    /* scratch memory: history followed by one block of (deinterleaved) input */
+    double even[ORDER - 1 + BLOCK_SIZE];
+    double odd[ORDER - 1 + BLOCK_SIZE];
+
+    copy (history_even_, history_even_ + ORDER - 1, even);
+    copy (history_odd_, history_odd_ + ORDER - 1, odd);
+
+    uint n_output_samples = n_input_samples / 2;
+    while (n_output_samples)
+      {
+        const uint n_todo_samples = min (uint (BLOCK_SIZE), n_output_samples);
+
+        for (uint i = 0; i < n_todo_samples; i++)
+          {
+            even[ORDER - 1 + i] = input[2 * i];
+            odd[ORDER - 1 + i]  = input[2 * i + 1];
+          }
+#ifdef PANDA_RESAMPLER_AVX2
+        if (iset_ == ISET_AVX2)
+          process_samples_avx (even, odd, n_todo_samples, &taps_->lanes[0], output);
+        else
+#endif
+        if (iset_ != ISET_FPU)
+          process_samples<DoubleMath> (even, odd, n_todo_samples, &taps_->lanes[0], output);
+        else
+          process_samples_fpu (even, odd, n_todo_samples, &taps_->lanes[0], output);
+
+        copy (&even[n_todo_samples], &even[n_todo_samples + ORDER - 1], even);
+        copy (&odd[n_todo_samples], &odd[n_todo_samples + ORDER - 1], odd);
+        input += n_todo_samples * 2;
+        output += n_todo_samples;
+        n_output_samples -= n_todo_samples;
+      }
+    copy (even, even + ORDER - 1, history_even_);
+    copy (odd, odd + ORDER - 1, history_odd_);
+  }
+  void
+  reset() override
+  {
+    std::fill (history_even_, history_even_ + ORDER - 1, 0.0);
+    std::fill (history_odd_, history_odd_ + ORDER - 1, 0.0);
+  }
+};
+
+/*
+ * Double precision IIR stages: Upsampler is either hiir::Upsampler2xF64Sse2
+ * (both polyphase paths in one SSE2 vector) or hiir::Upsampler2xFpuTpl
+ */
+template<class Upsampler>
+class Resampler2::DoubleIIRUpsampler2 final : public Resampler2::DoubleImpl {
+  Upsampler ups;
+public:
+  DoubleIIRUpsampler2 (const double *coeffs)
+  {
+    ups.set_coefs (coeffs);
+  }
+  void
+  process_block (const double *input, uint n_input_samples, double *output) override
+  {
+    ups.process_block (output, input, n_input_samples);
+  }
+  void
+  reset() override
+  {
+    ups.clear_buffers();
+  }
+};
+
+template<class Downsampler>
+class Resampler2::DoubleIIRDownsampler2 final : public Resampler2::DoubleImpl {
+  Downsampler downs;
+public:
+  DoubleIIRDownsampler2 (const double *coeffs)
+  {
+    downs.set_coefs (coeffs);
+  }
+  void
+  process_block (const double *input, uint n_input_samples, double *output) override
   {
-    -0.037276258261764332,
-    0.28635090020526976,
-    0.28635090020526976,
-    -0.037276258261764332,
-  };
-  if (stage_ratio == 8 && precision_ == 8 && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<4, USE_SSE> > (coeffs8_8, 4, 2.0);
-  if (stage_ratio == 8 && precision_ == 8 && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<4, USE_SSE> > (coeffs8_8, 4, 1.0);
-  // END generated code
+    downs.process_block (output, input, n_input_samples / 2);
+  }
+  void
+  reset() override
+  {
+    downs.clear_buffers();
+  }
+};
 
-  /* linear interpolation coefficients; barely useful for actual audio use,
-   * but useful for testing
-   */
-  static constexpr double coeffs_linear[2] = {
-    0.25,
-    /* here, a 0.5 coefficient will be used */
-    0.25,
+#ifdef PANDA_RESAMPLER_SSE2
+/* --- 16 bit fixed-point FIR --- */
+
+/*
+ * The fixed-point FIR stages store the filter history as int16 (with one bit
+ * of headroom, so the signal can be in [-2:2]) and use _mm_madd_epi16, which
+ * computes eight 16 bit products per instruction, twice as many as the float
+ * kernels. This is accurate enough for PREC_48DB and PREC_72DB.
+ *
+ * The quantized coefficients (FixedTaps) are shared, see fir_shared_layout().
+ */
+/* converts n float samples to int16 (rounded and saturated) */
+static inline void
+fixed_quantize (const float *input, uint n, int16_t *output)
+{
+  const __m128 vscale = _mm_set1_ps (FIXED_SAMPLE_SCALE);
+  const __m128 vmax = _mm_set1_ps (32767);
+  const __m128 vmin = _mm_set1_ps (-32768);
+  uint i = 0;
+
+  /* clamp in float: _mm_cvtps_epi32 doesn't saturate */
+  auto convert = [&] (const float *p) {
+    return _mm_cvtps_epi32 (_mm_min_ps (_mm_max_ps (_mm_mul_ps (_mm_loadu_ps (p), vscale), vmin), vmax));
   };
+  for (; i + 8 <= n; i += 8)
+    _mm_storeu_si128 (reinterpret_cast<__m128i *> (output + i), _mm_packs_epi32 (convert (input + i), convert (input + i + 4)));
+  for (; i < n; i++)
+    output[i] = lrintf (min (max (input[i] * FIXED_SAMPLE_SCALE, -32768.f), 32767.f));
+}
 
-  if (precision_ == PREC_LINEAR && mode_ == UP)
-    return create_impl_with_coeffs <Upsampler2<2, USE_SSE> > (coeffs_linear, 2, 2.0);
-  if (precision_ == PREC_LINEAR && mode_ == DOWN)
-    return create_impl_with_coeffs <Downsampler2<2, USE_SSE> > (coeffs_linear, 2, 1.0);
-  return 0;
+/*
+ * computes eight consecutive FIR output values, output[j] uses x[j]..x[j + ORDER - 1]
+ *
+ * Loading x[2 * m] gives the sample pairs for the outputs 0, 2, 4, 6 and
+ * loading x[2 * m + 1] gives the sample pairs for the outputs 1, 3, 5, 7, so
+ * each tap pair needs two _mm_madd_epi16 for eight output values.
+ */
+template<uint ORDER> static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+fir_fixed_process_8samples (const int16_t *x, const FixedTaps& taps, float *output)
+{
+  const int32_t *pairs = &taps.pairs[0];
+  __m128 out_lo = _mm_setzero_ps();
+  __m128 out_hi = _mm_setzero_ps();
+
+  /* the two partial sums are converted to float before adding them, so they can't overflow */
+  for (uint part = 0; part < 2; part++)
+    {
+      __m128i acc_even = _mm_setzero_si128();
+      __m128i acc_odd = _mm_setzero_si128();
+      for (uint m = part ? taps.split : 0; m < (part ? ORDER / 2 : taps.split); m++)
+        {
+          const __m128i t = _mm_load_si128 (reinterpret_cast<const __m128i *> (pairs + m * 8));
+          const __m128i x_even = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (x + 2 * m));
+          const __m128i x_odd = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (x + 2 * m + 1));
+          acc_even = _mm_add_epi32 (acc_even, _mm_madd_epi16 (x_even, t));
+          acc_odd = _mm_add_epi32 (acc_odd, _mm_madd_epi16 (x_odd, t));
+        }
+      out_lo = _mm_add_ps (out_lo, _mm_cvtepi32_ps (_mm_unpacklo_epi32 (acc_even, acc_odd)));
+      out_hi = _mm_add_ps (out_hi, _mm_cvtepi32_ps (_mm_unpackhi_epi32 (acc_even, acc_odd)));
+    }
+
+  const __m128 vscale = _mm_set1_ps (taps.scale);
+  _mm_storeu_ps (output, _mm_mul_ps (out_lo, vscale));
+  _mm_storeu_ps (output + 4, _mm_mul_ps (out_hi, vscale));
+}
+
+#ifdef PANDA_RESAMPLER_AVX2
+/* same as fir_fixed_process_8samples, for 16 output values */
+template<uint ORDER> static PANDA_RESAMPLER_TARGET_AVX2 PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+fir_fixed_process_16samples_avx (const int16_t *x, const FixedTaps& taps, float *output)
+{
+  const int32_t *pairs = &taps.pairs[0];
+  __m256 out_a = _mm256_setzero_ps(); /* outputs 0, 1, 2, 3 | 8, 9, 10, 11 */
+  __m256 out_b = _mm256_setzero_ps(); /* outputs 4, 5, 6, 7 | 12, 13, 14, 15 */
+
+  for (uint part = 0; part < 2; part++)
+    {
+      __m256i acc_even = _mm256_setzero_si256();
+      __m256i acc_odd = _mm256_setzero_si256();
+      for (uint m = part ? taps.split : 0; m < (part ? ORDER / 2 : taps.split); m++)
+        {
+          const __m256i t = _mm256_load_si256 (reinterpret_cast<const __m256i *> (pairs + m * 8));
+          const __m256i x_even = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (x + 2 * m));
+          const __m256i x_odd = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (x + 2 * m + 1));
+          acc_even = _mm256_add_epi32 (acc_even, _mm256_madd_epi16 (x_even, t));
+          acc_odd = _mm256_add_epi32 (acc_odd, _mm256_madd_epi16 (x_odd, t));
+        }
+      out_a = _mm256_add_ps (out_a, _mm256_cvtepi32_ps (_mm256_unpacklo_epi32 (acc_even, acc_odd)));
+      out_b = _mm256_add_ps (out_b, _mm256_cvtepi32_ps (_mm256_unpackhi_epi32 (acc_even, acc_odd)));
+    }
+
+  const __m256 vscale = _mm256_set1_ps (taps.scale);
+  out_a = _mm256_mul_ps (out_a, vscale);
+  out_b = _mm256_mul_ps (out_b, vscale);
+  _mm256_storeu_ps (output, _mm256_permute2f128_ps (out_a, out_b, 0x20));
+  _mm256_storeu_ps (output + 8, _mm256_permute2f128_ps (out_a, out_b, 0x31));
+}
+
+template<uint ORDER> static PANDA_RESAMPLER_TARGET_AVX2 void
+fir_fixed_process_block_avx (const int16_t *x, uint n_samples, const FixedTaps& taps, float *output)
+{
+  for (uint i = 0; i < n_samples; i += 16)
+    fir_fixed_process_16samples_avx<ORDER> (x + i, taps, output + i);
+}
+#endif
+
+/* computes n_samples FIR output values (rounded up to a multiple of 16, x must be padded accordingly) */
+template<uint ORDER> static inline void
+fir_fixed_process_block (const int16_t *x, uint n_samples, const FixedTaps& taps, Resampler2::InstructionSet iset, float *output)
+{
+#ifdef PANDA_RESAMPLER_AVX2
+  if (iset == Resampler2::ISET_AVX2)
+    {
+      fir_fixed_process_block_avx<ORDER> (x, n_samples, taps, output);
+      return;
+    }
+#endif
+  for (uint i = 0; i < n_samples; i += 8)
+    fir_fixed_process_8samples<ORDER> (x + i, taps, output + i);
 }
 
+/*
+ * Fixed-point FIR upsampling stage: same filter as Upsampler2, the FIR part
+ * is computed from the int16 history, the unfiltered samples are copied
+ * from the float input
+ */
 template<uint ORDER>
-class Resampler2::IIRDownsampler2 final : public Resampler2::Impl {
-  hiir::Downsampler2xFpu<ORDER> downs;
-  double delay_;
+class Resampler2::FixedFIRUpsampler2 final : public Resampler2::Impl {
+  static constexpr uint H = ORDER / 2; /* half the filter length */
+  static constexpr uint BLOCK_SIZE = 256;
+  static constexpr uint PADDING = 16;  /* fir_fixed_process_block computes up to 16 samples at once */
+
+  const std::shared_ptr<const FixedTaps> taps_;
+  const InstructionSet                   iset_;
+  int16_t                              history_[ORDER - 1];
+  float                                history_float_[ORDER - 1];
+
+  template<bool ADD>
+  void
+  process_block_fixed (const float *input, uint n_input_samples, float *output, float gain)
+  {
+    /* scratch memory: history followed by one block of input */
+    int16_t x[ORDER - 1 + BLOCK_SIZE + PADDING];
+    float   xf[ORDER - 1 + BLOCK_SIZE];
+    float   fir[BLOCK_SIZE + PADDING];
+
+    copy (history_, history_ + ORDER - 1, x);
+    copy (history_float_, history_float_ + ORDER - 1, xf);
+    while (n_input_samples)
+      {
+        const uint n_todo_samples = min (uint (BLOCK_SIZE), n_input_samples);
+
+        copy (input, input + n_todo_samples, &xf[ORDER - 1]);
+        fixed_quantize (input, n_todo_samples, &x[ORDER - 1]);
+        std::fill_n (&x[ORDER - 1 + n_todo_samples], PADDING, 0);
+        fir_fixed_process_block<ORDER> (x, n_todo_samples, *taps_, iset_, fir);
+
+        /* interleave: output[2 * i] = fir[i], output[2 * i + 1] = xf[i + H] */
+        uint i = 0;
+        for (; i + 4 <= n_todo_samples; i += 4)
+          {
+            const __m128 fir_v = _mm_loadu_ps (&fir[i]);
+            const __m128 mid_v = _mm_loadu_ps (&xf[i + H]);
+            fir_store_4samples<ADD> (&output[2 * i], _mm_unpacklo_ps (fir_v, mid_v), gain);
+            fir_store_4samples<ADD> (&output[2 * i + 4], _mm_unpackhi_ps (fir_v, mid_v), gain);
+          }
+        for (; i < n_todo_samples; i++)
+          {
+            fir_store_sample<ADD> (&output[2 * i], fir[i], gain);
+            fir_store_sample<ADD> (&output[2 * i + 1], xf[i + H], gain);
+          }
+        copy (&x[n_todo_samples], &x[n_todo_samples + ORDER - 1], x);
+        copy (&xf[n_todo_samples], &xf[n_todo_samples + ORDER - 1], xf);
+        input += n_todo_samples;
+        output += n_todo_samples * 2;
+        n_input_samples -= n_todo_samples;
+      }
+    copy (x, x + ORDER - 1, history_);
+    copy (xf, xf + ORDER - 1, history_float_);
+  }
 public:
-  IIRDownsampler2 (const double *coeffs, double group_delay) :
-    delay_ ((group_delay - 1) / 2)
+  FixedFIRUpsampler2 (const vector<double>& coeffs, InstructionSet iset) :
+    taps_ (fir_shared_layout<FixedTaps> (coeffs)),
+    iset_ (iset)
   {
-    downs.set_coefs (coeffs);
+    reset();
   }
   void
   process_block (const float *input, uint n_input_samples, float *output) override
   {
-    const uint n_output_samples = n_input_samples / 2;
-
-    downs.process_block (output, input, n_output_samples);
+    process_block_fixed<false> (input, n_input_samples, output, 1);
+  }
+  bool
+  process_block_add (const float *input, uint n_input_samples, float *output, float gain) override
+  {
+    process_block_fixed<true> (input, n_input_samples, output, gain);
+    return true;
   }
   uint
   order() const override
@@ -1096,34 +6050,110 @@ public:
   double
   delay() const override
   {
-    return delay_;
+    return order() - 1;
   }
   void
   reset() override
   {
-    downs.clear_buffers();
+    std::fill (history_, history_ + ORDER - 1, 0);
+    std::fill (history_float_, history_float_ + ORDER - 1, 0.0f);
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    /* double precision samples are processed with the float filter design */
+    return fir_taps_symmetric (taps_->coeffs, 2) ? new DoubleFIRUpsampler2<ORDER> (taps_->coeffs, iset_) : nullptr;
   }
   bool
   sse_enabled() const override
   {
-    return false;
+    return true;
   }
 };
 
+/*
+ * Fixed-point FIR downsampling stage: same filter as Downsampler2, the FIR
+ * part is computed from the int16 history of the even samples, the odd
+ * samples are added as float
+ */
 template<uint ORDER>
-class Resampler2::IIRUpsampler2 final : public Resampler2::Impl {
-  hiir::Upsampler2xFpu<ORDER> ups;
-  double delay_;
+class Resampler2::FixedFIRDownsampler2 final : public Resampler2::Impl {
+  static constexpr uint H = ORDER / 2 - 1; /* half the filter length */
+  static constexpr uint BLOCK_SIZE = 256;  /* output samples */
+  static constexpr uint PADDING = 16;      /* fir_fixed_process_block computes up to 16 samples at once */
+
+  const std::shared_ptr<const FixedTaps> taps_;
+  const InstructionSet                   iset_;
+  int16_t                              history_even_[ORDER - 1];
+  float                                history_odd_[ORDER - 1];
+
+  template<bool ADD>
+  void
+  process_block_fixed (const float *input, uint n_input_samples, float *output, float gain)
+  {
+    /* scratch memory: history followed by one block of (deinterleaved) input */
+    int16_t even[ORDER - 1 + BLOCK_SIZE + PADDING];
+    float   odd[ORDER - 1 + BLOCK_SIZE];
+    float   even_float[BLOCK_SIZE];
+    float   fir[BLOCK_SIZE + PADDING];
+
+    copy (history_even_, history_even_ + ORDER - 1, even);
+    copy (history_odd_, history_odd_ + ORDER - 1, odd);
+
+    uint n_output_samples = n_input_samples / 2;
+    while (n_output_samples)
+      {
+        const uint n_todo_samples = min (uint (BLOCK_SIZE), n_output_samples);
+
+        uint i = 0;
+        for (; i + 4 <= n_todo_samples; i += 4)
+          {
+            const __m128 a = _mm_loadu_ps (&input[2 * i]);
+            const __m128 b = _mm_loadu_ps (&input[2 * i + 4]);
+            _mm_storeu_ps (&even_float[i], _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0)));
+            _mm_storeu_ps (&odd[ORDER - 1 + i], _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1)));
+          }
+        for (; i < n_todo_samples; i++)
+          {
+            even_float[i]      = input[2 * i];
+            odd[ORDER - 1 + i] = input[2 * i + 1];
+          }
+        fixed_quantize (even_float, n_todo_samples, &even[ORDER - 1]);
+        std::fill_n (&even[ORDER - 1 + n_todo_samples], PADDING, 0);
+        fir_fixed_process_block<ORDER> (even, n_todo_samples, *taps_, iset_, fir);
+
+        const __m128 half = _mm_set1_ps (0.5f);
+        for (i = 0; i + 4 <= n_todo_samples; i += 4)
+          fir_store_4samples<ADD> (&output[i], _mm_add_ps (_mm_loadu_ps (&fir[i]), _mm_mul_ps (_mm_loadu_ps (&odd[i + H]), half)), gain);
+        for (; i < n_todo_samples; i++)
+          fir_store_sample<ADD> (&output[i], fir[i] + 0.5f * odd[i + H], gain);
+
+        copy (&even[n_todo_samples], &even[n_todo_samples + ORDER - 1], even);
+        copy (&odd[n_todo_samples], &odd[n_todo_samples + ORDER - 1], odd);
+        input += n_todo_samples * 2;
+        output += n_todo_samples;
+        n_output_samples -= n_todo_samples;
+      }
+    copy (even, even + ORDER - 1, history_even_);
+    copy (odd, odd + ORDER - 1, history_odd_);
+  }
 public:
-  IIRUpsampler2 (const double *coeffs, double group_delay) :
-    delay_ (group_delay)
+  FixedFIRDownsampler2 (const vector<double>& coeffs, InstructionSet iset) :
+    taps_ (fir_shared_layout<FixedTaps> (coeffs)),
+    iset_ (iset)
   {
-    ups.set_coefs (coeffs);
+    reset();
   }
   void
   process_block (const float *input, uint n_input_samples, float *output) override
   {
-    ups.process_block (output, input, n_input_samples);
+    process_block_fixed<false> (input, n_input_samples, output, 1);
+  }
+  bool
+  process_block_add (const float *input, uint n_input_samples, float *output, float gain) override
+  {
+    process_block_fixed<true> (input, n_input_samples, output, gain);
+    return true;
   }
   uint
   order() const override
@@ -1133,277 +6163,699 @@ public:
   double
   delay() const override
   {
-    return delay_;
+    return order() / 2 - 0.5;
   }
   void
   reset() override
   {
-    ups.clear_buffers();
+    std::fill (history_even_, history_even_ + ORDER - 1, 0);
+    std::fill (history_odd_, history_odd_ + ORDER - 1, 0.0f);
+  }
+  DoubleImpl *
+  create_double_stage() const override
+  {
+    /* double precision samples are processed with the float filter design */
+    return fir_taps_symmetric (taps_->coeffs, 2) ? new DoubleFIRDownsampler2<ORDER> (taps_->coeffs, iset_) : nullptr;
   }
   bool
   sse_enabled() const override
   {
-    return false;
+    return true;
   }
 };
+#endif /* PANDA_RESAMPLER_SSE2 */
 
-#ifdef __SSE__
-template<uint ORDER>
-class Resampler2::IIRDownsampler2SSE final : public Resampler2::Impl {
-  hiir::Downsampler2xSse<ORDER> downs;
-  double delay_;
+/* --- ResamplerBank --- */
+
+/*
+ * multiply-add for the generic kernels: acc += a * b
+ *
+ * (vectors are passed by reference, since passing 32-byte vectors by value
+ * depends on whether AVX is enabled)
+ */
+struct BankMath {
+  static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+  madd (BankLanes& acc, const BankLanes& a, const BankLanes& b)
+  {
+    acc += a * b;
+  }
+};
+
+#ifdef PANDA_RESAMPLER_AVX2
+/* multiply-add for the AVX2 kernels (the compiler doesn't contract a * b + c in ISO C++ mode) */
+struct BankMathFMA {
+  static PANDA_RESAMPLER_TARGET_AVX2 inline void
+  madd (BankLanes& acc, const BankLanes& a, const BankLanes& b)
+  {
+    acc = _mm256_fmadd_ps (a, b, acc);
+  }
+};
+#endif
+
+/* transposes a tile of LANES x LANES samples, the compiler translates this to shuffle instructions */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+bank_transpose (const BankLanes *rows, BankLanes *columns)
+{
+  static_assert (ResamplerBank::LANES == 8, "bank_transpose needs 8 lanes");
+  for (uint j = 0; j < ResamplerBank::LANES; j++)
+    columns[j] = BankLanes { rows[0][j], rows[1][j], rows[2][j], rows[3][j],
+                             rows[4][j], rows[5][j], rows[6][j], rows[7][j] };
+}
+
+/*
+ * Filter stage of a ResamplerBank: a stage processes one group of streams at
+ * a time, and stores the filter state of all groups (structure of arrays)
+ *
+ * Stages are compiled twice, with and without AVX2 (if available), since the
+ * same code benefits from the wider registers.
+ */
+class ResamplerBankStage {
+protected:
+  const uint              state_frames_; /* per group */
+  AlignedArray<BankLanes> state_;
+  const bool              avx_;
+
+  BankLanes *
+  group_state (uint group)
+  {
+    return &state_[group * state_frames_];
+  }
 public:
-  IIRDownsampler2SSE (const double *coeffs, double group_delay) :
-    delay_ ((group_delay - 1) / 2)
+  ResamplerBankStage (uint n_groups, uint state_frames, bool avx) :
+    state_frames_ (state_frames),
+    state_ (n_groups * state_frames),
+    avx_ (avx)
+  {
+  }
+  virtual
+  ~ResamplerBankStage()
   {
-    downs.set_coefs (coeffs);
   }
+  /* number of frames in front of the input that the stage uses to store its history */
+  virtual uint history_frames() const = 0;
+  /* input is scratch memory with history_frames() frames available in front of it */
+  virtual void process (uint group, BankLanes *input, uint n_input_frames, BankLanes *output) = 0;
   void
-  process_block (const float *input, uint n_input_samples, float *output) override
+  reset_lane (uint group, uint lane)
   {
-    const uint n_output_samples = n_input_samples / 2;
+    BankLanes *state = group_state (group);
+    for (uint f = 0; f < state_frames_; f++)
+      state[f][lane] = 0;
+  }
+  void
+  reset()
+  {
+    std::fill (state_.begin(), state_.end(), BankLanes());
+  }
+};
 
-    downs.process_block (output, input, n_output_samples);
+/* FIR upsampling stage, computes the same output as Upsampler2 (for symmetric taps) */
+template<uint ORDER>
+class BankFIRUpsampler2 final : public ResamplerBankStage {
+  const std::shared_ptr<const BankFIRTaps> taps_; /* uses the first half of the lanes */
+
+  template<class Math> static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+  process_frames (const BankLanes *x, uint n_frames, const BankLanes *taps, BankLanes *output)
+  {
+    /* x[0]..x[ORDER - 2] is the history, output[2 * i] uses x[i]..x[i + ORDER - 1] */
+    const uint H = ORDER / 2; /* half the filter length */
+    uint i = 0;
+
+    /* four frames at once (independent accumulators), the input frames are kept in
+     * registers (lo/hi) which slide by one frame per tap, so only two new frames are
+     * loaded per tap; the loops are unrolled by the compiler
+     */
+    for (; i + 4 <= n_frames; i += 4)
+      {
+        BankLanes acc[4], lo[4], hi[4];
+        for (uint j = 0; j < 4; j++)
+          {
+            lo[j] = x[i + j];
+            hi[j] = x[i + j + ORDER - 1];
+            acc[j] = (lo[j] + hi[j]) * taps[0];
+          }
+        for (uint k = 1; k < H; k++)
+          {
+            for (uint j = 0; j < 3; j++)
+              lo[j] = lo[j + 1];
+            lo[3] = x[i + 3 + k];
+            for (uint j = 3; j > 0; j--)
+              hi[j] = hi[j - 1];
+            hi[0] = x[i + ORDER - 1 - k];
+            for (uint j = 0; j < 4; j++)
+              Math::madd (acc[j], lo[j] + hi[j], taps[k]);
+          }
+        for (uint j = 0; j < 4; j++)
+          {
+            output[2 * (i + j)] = acc[j];
+            output[2 * (i + j) + 1] = x[i + j + H];
+          }
+      }
+    for (; i < n_frames; i++)
+      {
+        BankLanes acc = (x[i] + x[i + ORDER - 1]) * taps[0];
+        for (uint k = 1; k < H; k++)
+          Math::madd (acc, x[i + k] + x[i + ORDER - 1 - k], taps[k]);
+        output[2 * i] = acc;
+        output[2 * i + 1] = x[i + H];
+      }
   }
-  uint
-  order() const override
+#ifdef PANDA_RESAMPLER_AVX2
+  static PANDA_RESAMPLER_TARGET_AVX2 void
+  process_frames_avx (const BankLanes *x, uint n_frames, const BankLanes *taps, BankLanes *output)
   {
-    return ORDER;
+    process_frames<BankMathFMA> (x, n_frames, taps, output);
   }
-  double
-  delay() const override
+#endif
+public:
+  BankFIRUpsampler2 (const vector<double>& coeffs, uint n_groups, bool avx) :
+    ResamplerBankStage (n_groups, ORDER - 1, avx),
+    taps_ (fir_shared_layout<BankFIRTaps> (coeffs))
   {
-    return delay_;
   }
-  void
-  reset() override
+  uint
+  history_frames() const override
   {
-    downs.clear_buffers();
+    return ORDER - 1;
   }
-  bool
-  sse_enabled() const override
+  void
+  process (uint group, BankLanes *input, uint n_input_frames, BankLanes *output) override
   {
-    return true;
+    BankLanes *history = group_state (group);
+    BankLanes *x = input - (ORDER - 1);
+
+    copy (history, history + ORDER - 1, x);
+#ifdef PANDA_RESAMPLER_AVX2
+    if (avx_)
+      process_frames_avx (x, n_input_frames, &taps_->lanes[0], output);
+    else
+#endif
+      process_frames<BankMath> (x, n_input_frames, &taps_->lanes[0], output);
+    copy (x + n_input_frames, x + n_input_frames + ORDER - 1, history);
   }
 };
 
+/* FIR downsampling stage, computes the same output as Downsampler2 (for symmetric taps) */
 template<uint ORDER>
-class Resampler2::IIRUpsampler2SSE final : public Resampler2::Impl {
-  hiir::Upsampler2xSse<ORDER> ups;
-  double delay_;
+class BankFIRDownsampler2 final : public ResamplerBankStage {
+  const std::shared_ptr<const BankFIRTaps> taps_;
+
+  template<class Math> static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+  process_frames (const BankLanes *x, uint n_output_frames, const BankLanes *taps, BankLanes *output)
+  {
+    /* x[0]..x[2 * ORDER - 3] is the history, output[i] uses the even frames
+     * x[2 * i]..x[2 * (i + ORDER - 1)] and the odd frame x[2 * (i + H) + 1]
+     */
+    const uint H = ORDER / 2 - 1; /* half the filter length */
+    const BankLanes& half = taps[ORDER / 2];
+    uint i = 0;
+
+    /* four frames at once, sliding lo/hi registers like in BankFIRUpsampler2 */
+    for (; i + 4 <= n_output_frames; i += 4)
+      {
+        BankLanes acc[4], lo[4], hi[4];
+        for (uint j = 0; j < 4; j++)
+          {
+            lo[j] = x[2 * (i + j)];
+            hi[j] = x[2 * (i + j + ORDER - 1)];
+            acc[j] = (lo[j] + hi[j]) * taps[0];
+          }
+        for (uint k = 1; k < ORDER / 2; k++)
+          {
+            for (uint j = 0; j < 3; j++)
+              lo[j] = lo[j + 1];
+            lo[3] = x[2 * (i + 3 + k)];
+            for (uint j = 3; j > 0; j--)
+              hi[j] = hi[j - 1];
+            hi[0] = x[2 * (i + ORDER - 1 - k)];
+            for (uint j = 0; j < 4; j++)
+              Math::madd (acc[j], lo[j] + hi[j], taps[k]);
+          }
+        for (uint j = 0; j < 4; j++)
+          {
+            Math::madd (acc[j], x[2 * (i + j + H) + 1], half);
+            output[i + j] = acc[j];
+          }
+      }
+    for (; i < n_output_frames; i++)
+      {
+        BankLanes acc = (x[2 * i] + x[2 * (i + ORDER - 1)]) * taps[0];
+        for (uint k = 1; k < ORDER / 2; k++)
+          Math::madd (acc, x[2 * (i + k)] + x[2 * (i + ORDER - 1 - k)], taps[k]);
+        Math::madd (acc, x[2 * (i + H) + 1], half);
+        output[i] = acc;
+      }
+  }
+#ifdef PANDA_RESAMPLER_AVX2
+  static PANDA_RESAMPLER_TARGET_AVX2 void
+  process_frames_avx (const BankLanes *x, uint n_output_frames, const BankLanes *taps, BankLanes *output)
+  {
+    process_frames<BankMathFMA> (x, n_output_frames, taps, output);
+  }
+#endif
 public:
-  IIRUpsampler2SSE (const double *coeffs, double group_delay) :
-    delay_ (group_delay)
+  BankFIRDownsampler2 (const vector<double>& coeffs, uint n_groups, bool avx) :
+    ResamplerBankStage (n_groups, 2 * (ORDER - 1), avx),
+    taps_ (fir_shared_layout<BankFIRTaps> (coeffs))
+  {
+  }
+  uint
+  history_frames() const override
+  {
+    return 2 * (ORDER - 1);
+  }
+  void
+  process (uint group, BankLanes *input, uint n_input_frames, BankLanes *output) override
+  {
+    BankLanes *history = group_state (group);
+    BankLanes *x = input - 2 * (ORDER - 1);
+
+    copy (history, history + 2 * (ORDER - 1), x);
+#ifdef PANDA_RESAMPLER_AVX2
+    if (avx_)
+      process_frames_avx (x, n_input_frames / 2, &taps_->lanes[0], output);
+    else
+#endif
+      process_frames<BankMath> (x, n_input_frames / 2, &taps_->lanes[0], output);
+    copy (x + n_input_frames, x + n_input_frames + 2 * (ORDER - 1), history);
+  }
+};
+
+/*
+ * Polyphase IIR allpass chains for one frame, this is the same computation as
+ * hiir::StageProcFpu::process_sample_pos; the state m has NC + 2 entries
+ */
+template<uint NC, class Math> static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+bank_iir_process_frame (BankLanes *m, const BankLanes *coefs, BankLanes& spl_0, BankLanes& spl_1)
+{
+  for (uint j = 0; j < NC; j++)
+    {
+      BankLanes& spl = (j & 1) ? spl_1 : spl_0;
+      BankLanes tmp = m[j];
+      Math::madd (tmp, spl - m[j + 2], coefs[j]);
+      m[j] = spl;
+      spl = tmp;
+    }
+  m[NC] = (NC & 1) ? spl_1 : spl_0;
+  m[NC + 1] = (NC & 1) ? spl_0 : spl_1;
+}
+
+/* IIR upsampling stage, computes the same output as IIRUpsampler2 */
+template<uint NC>
+class BankIIRUpsampler2 final : public ResamplerBankStage {
+  AlignedArray<BankLanes> coefs_;
+
+  template<class Math> static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+  process_frames (BankLanes *state, const BankLanes *coefs, const BankLanes *input, uint n_frames, BankLanes *output)
+  {
+    /* keep the state in registers while processing the block */
+    BankLanes m[NC + 2];
+    copy (state, state + NC + 2, m);
+    for (uint i = 0; i < n_frames; i++)
+      {
+        BankLanes spl_0 = input[i];
+        BankLanes spl_1 = input[i];
+        bank_iir_process_frame<NC, Math> (m, coefs, spl_0, spl_1);
+        output[2 * i] = spl_0;
+        output[2 * i + 1] = spl_1;
+      }
+    copy (m, m + NC + 2, state);
+  }
+#ifdef PANDA_RESAMPLER_AVX2
+  static PANDA_RESAMPLER_TARGET_AVX2 void
+  process_frames_avx (BankLanes *state, const BankLanes *coefs, const BankLanes *input, uint n_frames, BankLanes *output)
+  {
+    process_frames<BankMathFMA> (state, coefs, input, n_frames, output);
+  }
+#endif
+public:
+  BankIIRUpsampler2 (const double *coeffs, uint n_groups, bool avx) :
+    ResamplerBankStage (n_groups, NC + 2, avx),
+    coefs_ (NC)
+  {
+    for (uint j = 0; j < NC; j++)
+      bank_lanes_set (coefs_[j], coeffs[j]);
+  }
+  uint
+  history_frames() const override
+  {
+    return 0;
+  }
+  void
+  process (uint group, BankLanes *input, uint n_input_frames, BankLanes *output) override
+  {
+#ifdef PANDA_RESAMPLER_AVX2
+    if (avx_)
+      process_frames_avx (group_state (group), &coefs_[0], input, n_input_frames, output);
+    else
+#endif
+      process_frames<BankMath> (group_state (group), &coefs_[0], input, n_input_frames, output);
+  }
+};
+
+/* IIR downsampling stage, computes the same output as IIRDownsampler2 */
+template<uint NC>
+class BankIIRDownsampler2 final : public ResamplerBankStage {
+  AlignedArray<BankLanes> coefs_; /* NC coefficients, followed by 0.5 */
+
+  template<class Math> static PANDA_RESAMPLER_FN_ALWAYS_INLINE void
+  process_frames (BankLanes *state, const BankLanes *coefs, const BankLanes *input, uint n_output_frames, BankLanes *output)
   {
-    ups.set_coefs (coeffs);
+    BankLanes m[NC + 2];
+    copy (state, state + NC + 2, m);
+    for (uint i = 0; i < n_output_frames; i++)
+      {
+        BankLanes spl_0 = input[2 * i + 1];
+        BankLanes spl_1 = input[2 * i];
+        bank_iir_process_frame<NC, Math> (m, coefs, spl_0, spl_1);
+        output[i] = coefs[NC] * (spl_0 + spl_1);
+      }
+    copy (m, m + NC + 2, state);
   }
-  void
-  process_block (const float *input, uint n_input_samples, float *output) override
+#ifdef PANDA_RESAMPLER_AVX2
+  static PANDA_RESAMPLER_TARGET_AVX2 void
+  process_frames_avx (BankLanes *state, const BankLanes *coefs, const BankLanes *input, uint n_output_frames, BankLanes *output)
   {
-    ups.process_block (output, input, n_input_samples);
+    process_frames<BankMathFMA> (state, coefs, input, n_output_frames, output);
   }
-  uint
-  order() const override
+#endif
+public:
+  BankIIRDownsampler2 (const double *coeffs, uint n_groups, bool avx) :
+    ResamplerBankStage (n_groups, NC + 2, avx),
+    coefs_ (NC + 1)
   {
-    return ORDER;
+    for (uint j = 0; j < NC; j++)
+      bank_lanes_set (coefs_[j], coeffs[j]);
+    bank_lanes_set (coefs_[NC], 0.5);
   }
-  double
-  delay() const override
+  uint
+  history_frames() const override
   {
-    return delay_;
+    return 0;
   }
   void
-  reset() override
+  process (uint group, BankLanes *input, uint n_input_frames, BankLanes *output) override
   {
-    ups.clear_buffers();
-  }
-  bool
-  sse_enabled() const override
-  {
-    return true;
+#ifdef PANDA_RESAMPLER_AVX2
+    if (avx_)
+      process_frames_avx (group_state (group), &coefs_[0], input, n_input_frames / 2, output);
+    else
+#endif
+      process_frames<BankMath> (group_state (group), &coefs_[0], input, n_input_frames / 2, output);
   }
 };
-#endif /* __SSE__ */
 
-template<bool USE_SSE> Resampler2::Impl*
-Resampler2::create_impl_iir (uint stage_ratio)
+template<uint ORDER> static ResamplerBankStage *
+create_bank_fir_upsampler2 (const vector<double>& coeffs, uint n_groups, bool avx)
 {
-  // START generated code
-  constexpr std::array<double,3> coeffs2_8 = {
-    0.13533476491166646,
-    0.44459059808236606,
-    0.80006724816152464,
-  };
-  if (stage_ratio == 2 && precision_ == PREC_48DB)
-    return create_impl_iir_with_coeffs (coeffs2_8, 1.749694);
-
-  constexpr std::array<double,2> coeffs4_8 = {
-    0.12564829488677751,
-    0.56413565549879052,
-  };
-  if (stage_ratio == 4 && precision_ == PREC_48DB)
-    return create_impl_iir_with_coeffs (coeffs4_8, 1.554290);
-
-  constexpr std::array<double,1> coeffs8_8 = {
-    0.34210403268814876,
-  };
-  if (stage_ratio == 8 && precision_ == PREC_48DB)
-    return create_impl_iir_with_coeffs (coeffs8_8, 0.980631);
+  return new BankFIRUpsampler2<ORDER> (coeffs, n_groups, avx);
+}
 
-  constexpr std::array<double,5> coeffs2_12 = {
-    0.057369561854075074,
-    0.2095436081316879,
-    0.41352768544651608,
-    0.6351349011042412,
-    0.86943780167618079,
-  };
-  if (stage_ratio == 2 && precision_ == PREC_72DB)
-    return create_impl_iir_with_coeffs (coeffs2_12, 2.758511);
+template<uint ORDER> static ResamplerBankStage *
+create_bank_fir_downsampler2 (const vector<double>& coeffs, uint n_groups, bool avx)
+{
+  return new BankFIRDownsampler2<ORDER> (coeffs, n_groups, avx);
+}
 
-  constexpr std::array<double,3> coeffs4_12 = {
-    0.063242386110162196,
-    0.26520245698601469,
-    0.66713594063634607,
-  };
-  if (stage_ratio == 4 && precision_ == PREC_72DB)
-    return create_impl_iir_with_coeffs (coeffs4_12, 2.162389);
+template<uint NC> static ResamplerBankStage *
+create_bank_iir_upsampler2 (const double *coeffs, uint n_groups, bool avx)
+{
+  return new BankIIRUpsampler2<NC> (coeffs, n_groups, avx);
+}
 
-  constexpr std::array<double,2> coeffs8_12 = {
-    0.11010398332301433,
-    0.53640535169046299,
-  };
-  if (stage_ratio == 8 && precision_ == PREC_72DB)
-    return create_impl_iir_with_coeffs (coeffs8_12, 1.603448);
+template<uint NC> static ResamplerBankStage *
+create_bank_iir_downsampler2 (const double *coeffs, uint n_groups, bool avx)
+{
+  return new BankIIRDownsampler2<NC> (coeffs, n_groups, avx);
+}
 
-  constexpr std::array<double,6> coeffs2_16 = {
-    0.041451595119442179,
-    0.15510356876083609,
-    0.31565680487417447,
-    0.49770230748789734,
-    0.68754139898746236,
-    0.88864894857989574,
-  };
-  if (stage_ratio == 2 && precision_ == PREC_96DB)
-    return create_impl_iir_with_coeffs (coeffs2_16, 3.258518);
+PANDA_RESAMPLER_FN
+ResamplerBank::ResamplerBank (Resampler2::Mode      mode,
+                              uint                  ratio,
+                              Resampler2::Precision precision,
+                              uint                  n_streams,
+                              Resampler2::Filter    filter) :
+  active_ (n_streams, true),
+  scratch_a_ ((HISTORY_FRAMES + BLOCK_FRAMES) * LANES),
+  scratch_b_ ((HISTORY_FRAMES + BLOCK_FRAMES) * LANES),
+  silence_ (BLOCK_FRAMES),
+  discard_ (BLOCK_FRAMES),
+  mode_ (mode),
+  ratio_ (ratio),
+  n_streams_ (n_streams),
+  n_groups_ ((n_streams + LANES - 1) / LANES)
+{
+  if (filter == Resampler2::FILTER_IIR_PARALLEL)
+    filter = Resampler2::FILTER_IIR;
+  if (filter == Resampler2::FILTER_FIR_FIXED)
+    filter = Resampler2::FILTER_FIR;
 
-  constexpr std::array<double,3> coeffs4_16 = {
-    0.063242386110162196,
-    0.26520245698601469,
-    0.66713594063634607,
-  };
-  if (stage_ratio == 4 && precision_ == PREC_96DB)
-    return create_impl_iir_with_coeffs (coeffs4_16, 2.162389);
+  /* the stages use the filters of a mono resampler with the same configuration */
+  Resampler2 mono (mode, ratio, precision, false, filter);
+  delay_ = mono.delay();
+  iset_ = Resampler2::instruction_set_available();
 
-  constexpr std::array<double,2> coeffs8_16 = {
-    0.11010398332301433,
-    0.53640535169046299,
-  };
-  if (stage_ratio == 8 && precision_ == PREC_96DB)
-    return create_impl_iir_with_coeffs (coeffs8_16, 1.603448);
+  vector<Resampler2::Impl *> impls;
+  if (ratio >= 2)
+    impls.push_back (mono.impl_x2.get());
+  if (ratio >= 4)
+    impls.push_back (mono.impl_x4.get());
+  if (ratio >= 8)
+    impls.push_back (mono.impl_x8.get());
+  if (mode == Resampler2::DOWN)
+    std::reverse (impls.begin(), impls.end());
 
-  constexpr std::array<double,8> coeffs2_20 = {
-    0.024474822059978408,
-    0.094054346501929856,
-    0.19872162695194262,
-    0.32597599445882591,
-    0.46482603848881743,
-    0.60862663328164524,
-    0.75647898374965283,
-    0.91392075106875681,
-  };
-  if (stage_ratio == 2 && precision_ == PREC_120DB)
-    return create_impl_iir_with_coeffs (coeffs2_20, 4.258575);
+  for (auto impl : impls)
+    {
+      stages_.emplace_back (impl->create_bank_stage (n_groups_, iset_ == Resampler2::ISET_AVX2));
+      PANDA_RESAMPLER_CHECK (stages_.back() && stages_.back()->history_frames() <= HISTORY_FRAMES);
+    }
+}
 
-  constexpr std::array<double,4> coeffs4_20 = {
-    0.03806054747623356,
-    0.15621232623983866,
-    0.37118048037198415,
-    0.73087698794653666,
-  };
-  if (stage_ratio == 4 && precision_ == PREC_120DB)
-    return create_impl_iir_with_coeffs (coeffs4_20, 2.771786);
+PANDA_RESAMPLER_FN
+ResamplerBank::~ResamplerBank()
+{
+}
 
-  constexpr std::array<double,3> coeffs8_20 = {
-    0.054591151801747943,
-    0.23954799102035762,
-    0.64335720472138391,
-  };
-  if (stage_ratio == 8 && precision_ == PREC_120DB)
-    return create_impl_iir_with_coeffs (coeffs8_20, 2.227224);
+/*
+ * planar/interleaved -> structure of arrays: reads n frames, the samples of
+ * lane l are in[l][0], in[l][stride[l]], in[l][2 * stride[l]], ...
+ */
+static inline void
+bank_read_frames (const float * const *in, const uint *stride, uint n, BankLanes *frames)
+{
+  const uint LANES = ResamplerBank::LANES;
 
-  constexpr std::array<double,9> coeffs2_24 = {
-    0.01964694276744065,
-    0.076088803821783499,
-    0.16263241326637887,
-    0.2704225137521028,
-    0.39083229614395837,
-    0.51740920918216626,
-    0.6470358330763375,
-    0.7804624622392915,
-    0.92268241849452293,
-  };
-  if (stage_ratio == 2 && precision_ == PREC_144DB)
-    return create_impl_iir_with_coeffs (coeffs2_24, 4.758752);
+  bool planar = true, interleaved = true;
+  for (uint l = 0; l < LANES; l++)
+    {
+      planar = planar && stride[l] == 1;
+      interleaved = interleaved && stride[l] == LANES && in[l] == in[0] + l;
+    }
+  if (interleaved) /* same layout */
+    {
+      memcpy (frames, in[0], n * sizeof (BankLanes));
+      return;
+    }
+  uint i = 0;
+  if (planar) /* LANES frames at a time */
+    {
+      for (; i + LANES <= n; i += LANES)
+        {
+          BankLanes rows[LANES];
+          for (uint l = 0; l < LANES; l++)
+            memcpy (&rows[l], in[l] + i, sizeof (BankLanes));
+          bank_transpose (rows, frames + i);
+        }
+    }
+  for (; i < n; i++)
+    {
+      BankLanes frame;
+      for (uint l = 0; l < LANES; l++)
+        frame[l] = in[l][i * stride[l]];
+      frames[i] = frame;
+    }
+}
 
-  constexpr std::array<double,5> coeffs4_24 = {
-    0.025414320818611134,
-    0.10332655701804375,
-    0.24011358015046655,
-    0.45161232259950512,
-    0.77416388521132473,
-  };
-  if (stage_ratio == 4 && precision_ == PREC_144DB)
-    return create_impl_iir_with_coeffs (coeffs4_24, 3.382479);
+/* structure of arrays -> planar/interleaved, the inverse of bank_read_frames */
+static inline void
+bank_write_frames (const BankLanes *frames, uint n, float * const *out, const uint *stride)
+{
+  const uint LANES = ResamplerBank::LANES;
 
-  constexpr std::array<double,3> coeffs8_24 = {
-    0.054591151801747943,
-    0.23954799102035762,
-    0.64335720472138391,
-  };
-  if (stage_ratio == 8 && precision_ == PREC_144DB)
-    return create_impl_iir_with_coeffs (coeffs8_24, 2.227224);
-  // END generated code
-  return 0;
+  bool planar = true, interleaved = true;
+  for (uint l = 0; l < LANES; l++)
+    {
+      planar = planar && stride[l] == 1;
+      interleaved = interleaved && stride[l] == LANES && out[l] == out[0] + l;
+    }
+  if (interleaved)
+    {
+      memcpy (out[0], frames, n * sizeof (BankLanes));
+      return;
+    }
+  uint i = 0;
+  if (planar)
+    {
+      for (; i + LANES <= n; i += LANES)
+        {
+          BankLanes columns[LANES];
+          bank_transpose (frames + i, columns);
+          for (uint l = 0; l < LANES; l++)
+            memcpy (out[l] + i, &columns[l], sizeof (BankLanes));
+        }
+    }
+  for (; i < n; i++)
+    {
+      const BankLanes frame = frames[i];
+      for (uint l = 0; l < LANES; l++)
+        out[l][i * stride[l]] = frame[l];
+    }
 }
 
-template<class CArray>
-inline Resampler2::Impl*
-Resampler2::create_impl_iir_with_coeffs (const CArray& carray, double group_delay)
+PANDA_RESAMPLER_FN
+void
+ResamplerBank::process_group (uint                 group,
+                              const float * const *input,
+                              uint                 input_stride,
+                              uint                 n_input_samples,
+                              float * const       *output,
+                              uint                 output_stride)
 {
-  constexpr uint n_coeffs = std::tuple_size<CArray>::value;
+  /* input[l] / output[l] are nullptr for inactive lanes and the unused lanes of the last group */
+  bool group_active = false;
+  for (uint l = 0; l < LANES; l++)
+    group_active = group_active || input[l];
+  if (!group_active)
+    return;
 
-#ifdef __SSE__
-  if (use_sse_if_available_)
+  const uint n_output_samples = mode_ == Resampler2::UP ? n_input_samples * ratio_ : n_input_samples / ratio_;
+  if (stages_.empty()) /* ratio 1 */
     {
-      if (mode_ == UP)
-        return new IIRUpsampler2SSE<n_coeffs> (carray.data(), group_delay);
-      else
-        return new IIRDownsampler2SSE<n_coeffs> (carray.data(), group_delay);
+      for (uint l = 0; l < LANES; l++)
+        if (input[l])
+          for (uint i = 0; i < n_output_samples; i++)
+            output[l][i * output_stride] = input[l][i * input_stride];
+      return;
     }
-  else
-#endif
+
+  BankLanes *buffer_a = reinterpret_cast<BankLanes *> (&scratch_a_[HISTORY_FRAMES * LANES]);
+  BankLanes *buffer_b = reinterpret_cast<BankLanes *> (&scratch_b_[HISTORY_FRAMES * LANES]);
+
+  /* inactive lanes read silence, their output is discarded; the stride of these
+   * lanes is 1 for planar data (so that reading/writing stays vectorized) and 0 otherwise
+   */
+  const uint unused_stride = input_stride == 1 && output_stride == 1 ? 1 : 0;
+  uint in_stride[LANES], out_stride[LANES];
+  for (uint l = 0; l < LANES; l++)
     {
-      if (mode_ == UP)
-        return new IIRUpsampler2<n_coeffs> (carray.data(), group_delay);
-      else
-        return new IIRDownsampler2<n_coeffs> (carray.data(), group_delay);
+      in_stride[l] = input[l] ? input_stride : unused_stride;
+      out_stride[l] = input[l] ? output_stride : unused_stride;
+    }
+
+  /* process all blocks of one group, so its state stays in cache */
+  const uint block_size = mode_ == Resampler2::UP ? BLOCK_FRAMES / ratio_ : BLOCK_FRAMES;
+  uint pos = 0;
+  while (pos < n_input_samples)
+    {
+      const uint n_todo = min (n_input_samples - pos, block_size);
+
+      const float *in[LANES];
+      for (uint l = 0; l < LANES; l++)
+        in[l] = input[l] ? input[l] + pos * input_stride : &silence_[0];
+      bank_read_frames (in, in_stride, n_todo, buffer_a);
+
+      BankLanes *stage_in = buffer_a;
+      BankLanes *stage_out = buffer_b;
+      uint n_frames = n_todo;
+      for (auto& stage : stages_)
+        {
+          stage->process (group, stage_in, n_frames, stage_out);
+          n_frames = mode_ == Resampler2::UP ? n_frames * 2 : n_frames / 2;
+          std::swap (stage_in, stage_out);
+        }
+
+      /* n_frames <= BLOCK_FRAMES, so the discard buffer is large enough */
+      const uint out_pos = mode_ == Resampler2::UP ? pos * ratio_ : pos / ratio_;
+      float *out[LANES];
+      for (uint l = 0; l < LANES; l++)
+        out[l] = input[l] ? output[l] + out_pos * output_stride : &discard_[0];
+      bank_write_frames (stage_in, n_frames, out, out_stride);
+
+      pos += n_todo;
     }
 }
 
 PANDA_RESAMPLER_FN
-bool
-Resampler2::test_filter_impl (bool verbose)
+void
+ResamplerBank::process_block (const float * const *input,
+                              uint                 n_input_samples,
+                              float * const       *output)
 {
-  if (sse_available())
+  if (mode_ == Resampler2::DOWN && !PANDA_RESAMPLER_CHECK (n_input_samples % ratio_ == 0))
+    return;
+
+  for (uint group = 0; group < n_groups_; group++)
     {
-      return fir_test_filter_sse (verbose);
+      const float *in[LANES];
+      float *out[LANES];
+      for (uint l = 0; l < LANES; l++)
+        {
+          const uint s = group * LANES + l;
+          const bool lane_active = s < n_streams_ && active_[s];
+          in[l] = lane_active ? input[s] : nullptr;
+          out[l] = lane_active ? output[s] : nullptr;
+        }
+      process_group (group, in, 1, n_input_samples, out, 1);
     }
-  else
+}
+
+PANDA_RESAMPLER_FN
+void
+ResamplerBank::process_block_interleaved (const float *input,
+                                          uint         n_input_frames,
+                                          float       *output)
+{
+  if (mode_ == Resampler2::DOWN && !PANDA_RESAMPLER_CHECK (n_input_frames % ratio_ == 0))
+    return;
+
+  for (uint group = 0; group < n_groups_; group++)
     {
-      if (verbose)
-        printf ("SSE filter implementation not tested: no SSE support available\n");
-      return true;
+      const float *in[LANES];
+      float *out[LANES];
+      for (uint l = 0; l < LANES; l++)
+        {
+          const uint s = group * LANES + l;
+          const bool lane_active = s < n_streams_ && active_[s];
+          in[l] = lane_active ? input + s : nullptr;
+          out[l] = lane_active ? output + s : nullptr;
+        }
+      process_group (group, in, n_streams_, n_input_frames, out, n_streams_);
+    }
+}
+
+PANDA_RESAMPLER_FN
+void
+ResamplerBank::set_active (uint stream, bool active)
+{
+  if (!PANDA_RESAMPLER_CHECK (stream < n_streams_))
+    return;
+
+  /* a stream that gets activated starts with a clean state */
+  if (active && !active_[stream])
+    {
+      for (auto& stage : stages_)
+        stage->reset_lane (stream / LANES, stream % LANES);
     }
+  active_[stream] = active;
+}
+
+PANDA_RESAMPLER_FN
+void
+ResamplerBank::reset()
+{
+  for (auto& stage : stages_)
+    stage->reset();
 }
 
 } // namespace PandaResampler
@@ -0,0 +1,196 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#ifndef __PANDA_RESAMPLER_SIMD_HH__
+#define __PANDA_RESAMPLER_SIMD_HH__
+
+/*
+ * The vectorized FIR kernels and the hiir SSE stage processors are written
+ * using SSE intrinsics. On x86 these are the real intrinsics, on all other
+ * architectures (and on x86 if PANDA_RESAMPLER_FORCE_VECTOR is defined) the
+ * subset of SSE intrinsics we need is implemented using GCC/Clang vector
+ * extensions, which the compiler translates to NEON, AltiVec, ... instructions.
+ */
+#if defined (__SSE__) && !defined (PANDA_RESAMPLER_FORCE_VECTOR)
+#  include <xmmintrin.h>
+#  define PANDA_RESAMPLER_SSE
+#elif defined (__GNUC__)
+#  define PANDA_RESAMPLER_VECTOR
+#endif
+
+#if defined (PANDA_RESAMPLER_SSE) || defined (PANDA_RESAMPLER_VECTOR)
+#  define PANDA_RESAMPLER_SIMD
+#endif
+
+/* double precision IIR filters use SSE2 intrinsics (there is no vector extension fallback) */
+#if defined (PANDA_RESAMPLER_SSE) && defined (__SSE2__)
+#  include <emmintrin.h>
+#  define PANDA_RESAMPLER_SSE2
+#endif
+
+#define PANDA_RESAMPLER_FN_ALWAYS_INLINE inline __attribute__((always_inline))
+#define PANDA_RESAMPLER_FN_NOINLINE __attribute__((noinline))
+
+#ifdef PANDA_RESAMPLER_VECTOR
+
+#ifndef _MM_SHUFFLE
+#define _MM_SHUFFLE(fp3, fp2, fp1, fp0) (((fp3) << 6) | ((fp2) << 4) | ((fp1) << 2) | (fp0))
+#endif
+
+namespace PandaResampler
+{
+
+typedef float __m128   __attribute__((vector_size (16), __may_alias__));
+typedef float __m128_u __attribute__((vector_size (16), __may_alias__, __aligned__ (1)));
+typedef float __m64    __attribute__((vector_size (8), __may_alias__));
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_add_ps (__m128 a, __m128 b)
+{
+  return a + b;
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_sub_ps (__m128 a, __m128 b)
+{
+  return a - b;
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_mul_ps (__m128 a, __m128 b)
+{
+  return a * b;
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_add_ss (__m128 a, __m128 b)
+{
+  a[0] += b[0];
+  return a;
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_sub_ss (__m128 a, __m128 b)
+{
+  a[0] -= b[0];
+  return a;
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_mul_ss (__m128 a, __m128 b)
+{
+  a[0] *= b[0];
+  return a;
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_setr_ps (float f0, float f1, float f2, float f3)
+{
+  __m128 r = { f0, f1, f2, f3 };
+  return r;
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_set1_ps (float f)
+{
+  return _mm_setr_ps (f, f, f, f);
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_set_ss (float f)
+{
+  return _mm_setr_ps (f, 0, 0, 0);
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_setzero_ps()
+{
+  return _mm_set1_ps (0);
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+float _mm_cvtss_f32 (__m128 a)
+{
+  return a[0];
+}
+
+/* p must be 16-byte aligned */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_load_ps (const float *p)
+{
+  return *reinterpret_cast<const __m128 *> (p);
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_loadu_ps (const float *p)
+{
+  return *reinterpret_cast<const __m128_u *> (p);
+}
+
+/* p must be 16-byte aligned */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void _mm_store_ps (float *p, __m128 a)
+{
+  *reinterpret_cast<__m128 *> (p) = a;
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void _mm_storeu_ps (float *p, __m128 a)
+{
+  *reinterpret_cast<__m128_u *> (p) = a;
+}
+
+/* loads two values into the lower half of a, p doesn't need to be aligned */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_loadl_pi (__m128 a, const __m64 *p)
+{
+  const float *f = reinterpret_cast<const float *> (p);
+  a[0] = f[0];
+  a[1] = f[1];
+  return a;
+}
+
+/* stores the lower two values, p doesn't need to be aligned */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+void _mm_storel_pi (__m64 *p, __m128 a)
+{
+  float *f = reinterpret_cast<float *> (p);
+  f[0] = a[0];
+  f[1] = a[1];
+}
+
+/* the compiler translates the element-wise constructions to shuffle instructions */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_unpacklo_ps (__m128 a, __m128 b)
+{
+  return _mm_setr_ps (a[0], b[0], a[1], b[1]);
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_unpackhi_ps (__m128 a, __m128 b)
+{
+  return _mm_setr_ps (a[2], b[2], a[3], b[3]);
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_movelh_ps (__m128 a, __m128 b)
+{
+  return _mm_setr_ps (a[0], a[1], b[0], b[1]);
+}
+
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_movehl_ps (__m128 a, __m128 b)
+{
+  return _mm_setr_ps (b[2], b[3], a[2], a[3]);
+}
+
+/* imm must be a compile time constant (usually created with _MM_SHUFFLE) */
+static PANDA_RESAMPLER_FN_ALWAYS_INLINE
+__m128 _mm_shuffle_ps (__m128 a, __m128 b, int imm)
+{
+  return _mm_setr_ps (a[imm & 3], a[(imm >> 2) & 3], b[(imm >> 4) & 3], b[(imm >> 6) & 3]);
+}
+
+}
+
+#endif /* PANDA_RESAMPLER_VECTOR */
+
+#endif /* __PANDA_RESAMPLER_SIMD_HH__ */
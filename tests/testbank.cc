@@ -0,0 +1,229 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <sys/time.h>
+
+using PandaResampler::Resampler2;
+using PandaResampler::ResamplerBank;
+
+using std::vector;
+using std::max;
+
+static double
+gettime()
+{
+  timeval tv;
+  gettimeofday (&tv, 0);
+
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* compares the streams of a resampler bank with one mono resampler per stream */
+static double
+test_bank (Resampler2::Mode mode, uint ratio, Resampler2::Precision prec, Resampler2::Filter filter)
+{
+  const uint n_streams = 13;
+  const uint n_input = 1200;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+  const float unused = 42; // inactive streams must not be written
+
+  ResamplerBank bank (mode, ratio, prec, n_streams, filter);
+  vector<Resampler2> mono;
+  for (uint s = 0; s < n_streams; s++)
+    mono.emplace_back (mode, ratio, prec, true, filter);
+
+  vector<vector<float>> in (n_streams, vector<float> (n_input));
+  vector<vector<float>> out_bank (n_streams, vector<float> (n_output, unused));
+  vector<vector<float>> out_mono (n_streams, vector<float> (n_output, unused));
+
+  for (uint s = 0; s < n_streams; s++)
+    for (uint i = 0; i < n_input; i++)
+      in[s][i] = sin (i * (s + 1) * 0.011) * 0.9 + (rand() / double (RAND_MAX) - 0.5) * 0.1;
+
+  /* process with odd block sizes, activate and deactivate some streams in between */
+  uint pos = 0;
+  uint block_size = 1;
+  uint block = 0;
+  while (pos < n_input)
+    {
+      uint n = std::min (block_size * ratio, n_input - pos);
+      n -= n % ratio; // downsampler needs a multiple of ratio
+      if (n == 0)
+        n = n_input - pos;
+
+      const uint out_pos = mode == Resampler2::UP ? pos * ratio : pos / ratio;
+
+      /* stream 3 is inactive for some blocks, the second group (streams 8..12) for one block */
+      bank.set_active (3, block < 5 || block > 9);
+      for (uint s = 8; s < n_streams; s++)
+        bank.set_active (s, block != 7);
+
+      const float *in_p[n_streams];
+      float *out_p[n_streams];
+      for (uint s = 0; s < n_streams; s++)
+        {
+          in_p[s] = bank.active (s) ? in[s].data() + pos : nullptr;
+          out_p[s] = bank.active (s) ? out_bank[s].data() + out_pos : nullptr;
+
+          if (bank.active (s))
+            mono[s].process_block (in_p[s], n, out_mono[s].data() + out_pos);
+          else
+            mono[s].reset(); // reactivated streams start with a clean state
+        }
+      bank.process_block (in_p, n, out_p);
+
+      pos += n;
+      block_size = block_size * 3 % 37 + 1;
+      block++;
+    }
+
+  double error = 0;
+  for (uint s = 0; s < n_streams; s++)
+    for (uint i = 0; i < n_output; i++)
+      error = max (error, fabs (double (out_bank[s][i]) - out_mono[s][i]));
+
+  if (bank.delay() != mono[0].delay())
+    error = 1;
+
+  return error;
+}
+
+/* compares interleaved and planar processing of a resampler bank */
+static double
+test_bank_interleaved (Resampler2::Mode mode, uint ratio, Resampler2::Precision prec, Resampler2::Filter filter, uint n_streams)
+{
+  const uint n_input = 1000;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+
+  ResamplerBank planar (mode, ratio, prec, n_streams, filter);
+  ResamplerBank interleaved (mode, ratio, prec, n_streams, filter);
+
+  /* for partial groups, test an inactive stream, too */
+  if (n_streams % ResamplerBank::LANES)
+    {
+      planar.set_active (n_streams - 1, false);
+      interleaved.set_active (n_streams - 1, false);
+    }
+
+  vector<vector<float>> in (n_streams, vector<float> (n_input));
+  vector<vector<float>> out (n_streams, vector<float> (n_output));
+  vector<float> in_interleaved (n_input * n_streams);
+  vector<float> out_interleaved (n_output * n_streams);
+  vector<const float *> in_p (n_streams);
+  vector<float *> out_p (n_streams);
+  for (uint s = 0; s < n_streams; s++)
+    {
+      for (uint i = 0; i < n_input; i++)
+        {
+          in[s][i] = sin (i * (s + 1) * 0.017) * 0.9 + (rand() / double (RAND_MAX) - 0.5) * 0.1;
+          in_interleaved[i * n_streams + s] = in[s][i];
+        }
+      in_p[s] = in[s].data();
+      out_p[s] = out[s].data();
+    }
+  planar.process_block (in_p.data(), n_input, out_p.data());
+  interleaved.process_block_interleaved (in_interleaved.data(), n_input, out_interleaved.data());
+
+  double error = 0;
+  for (uint s = 0; s < n_streams; s++)
+    for (uint i = 0; i < n_output; i++)
+      error = max (error, fabs (double (out_interleaved[i * n_streams + s]) - out[s][i]));
+  return error;
+}
+
+static void
+perf (Resampler2::Mode mode, uint ratio, Resampler2::Precision prec, Resampler2::Filter filter, uint n_streams)
+{
+  const uint n_input = 128;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+  const uint n_blocks = 4000000 / (n_streams * n_input);
+
+  vector<vector<float>> in (n_streams, vector<float> (n_input));
+  vector<vector<float>> out (n_streams, vector<float> (n_output));
+  vector<const float *> in_p (n_streams);
+  vector<float *> out_p (n_streams);
+  for (uint s = 0; s < n_streams; s++)
+    {
+      in_p[s] = in[s].data();
+      out_p[s] = out[s].data();
+    }
+
+  ResamplerBank bank (mode, ratio, prec, n_streams, filter);
+  vector<Resampler2> mono;
+  for (uint s = 0; s < n_streams; s++)
+    mono.emplace_back (mode, ratio, prec, true, filter);
+
+  /* alternate between bank and mono resamplers, use the best of several runs */
+  double t_bank = 1e30, t_mono = 1e30;
+  for (uint run = 0; run < 10; run++)
+    {
+      double t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        bank.process_block (in_p.data(), n_input, out_p.data());
+      t_bank = std::min (t_bank, gettime() - t);
+
+      t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        for (uint s = 0; s < n_streams; s++)
+          mono[s].process_block (in_p[s], n_input, out_p[s]);
+      t_mono = std::min (t_mono, gettime() - t);
+    }
+
+  const double samples = double (n_blocks) * n_input * n_streams;
+  printf ("bank: %f ns / sample, mono: %f ns / sample\n", t_bank / samples * 1e9, t_mono / samples * 1e9);
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc == 6 && !strcmp (argv[1], "perf"))
+    {
+      perf (strcmp (argv[2], "down") ? Resampler2::UP : Resampler2::DOWN,
+            atoi (argv[3]),
+            Resampler2::find_precision_for_bits (atoi (argv[4])),
+            strcmp (argv[5], "iir") ? Resampler2::FILTER_FIR : Resampler2::FILTER_IIR,
+            1024);
+      return 0;
+    }
+
+  bool ok = true;
+
+  for (auto filter : { Resampler2::FILTER_FIR, Resampler2::FILTER_IIR })
+    for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+      for (uint ratio : { 1, 2, 4, 8 })
+        for (auto prec : { Resampler2::PREC_LINEAR, Resampler2::PREC_48DB, Resampler2::PREC_96DB, Resampler2::PREC_144DB })
+          {
+            if (prec == Resampler2::PREC_LINEAR && filter != Resampler2::FILTER_FIR)
+              continue; // linear interpolation is only available as FIR filter
+
+            double error = test_bank (mode, ratio, prec, filter);
+            /* FIR kernels sum up the products in a different order than the mono resampler */
+            const double bound = 1e-5;
+            printf ("%s %s ratio=%d bits=%d error=%g\n",
+                    filter == Resampler2::FILTER_FIR ? "fir" : "iir",
+                    mode == Resampler2::UP ? "up" : "down",
+                    ratio, prec, error);
+            if (error > bound)
+              {
+                printf ("  ERROR: bank output mismatch (bound %g)\n", bound);
+                ok = false;
+              }
+
+            /* 8 streams: interleaved frames have the same layout as the vectors used for filtering */
+            for (uint n_streams : { 8, 11 })
+              {
+                if (test_bank_interleaved (mode, ratio, prec, filter, n_streams) != 0)
+                  {
+                    printf ("  ERROR: interleaved output mismatch (%d streams)\n", n_streams);
+                    ok = false;
+                  }
+              }
+          }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <sys/time.h>
+
+using PandaResampler::Resampler2;
+
+using std::vector;
+using std::max;
+using std::min;
+
+static double
+gettime()
+{
+  timeval tv;
+  gettimeofday (&tv, 0);
+
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static const char *
+filter_name (Resampler2::Filter filter)
+{
+  switch (filter)
+    {
+      case Resampler2::FILTER_FIR:        return "fir";
+      case Resampler2::FILTER_FIR_FIXED:  return "fir-fixed";
+      case Resampler2::FILTER_IIR:        return "iir";
+      default:                            return "other";
+    }
+}
+
+/* returns the maximum difference between process_block_add() and process_block() + adding the scaled output */
+static double
+test_add (Resampler2::Mode mode, uint ratio, Resampler2::Precision precision, Resampler2::Filter filter, bool sse)
+{
+  const uint n_samples = 3000;
+  const uint n_out_samples = mode == Resampler2::UP ? n_samples * ratio : n_samples / ratio;
+  const float gain = 0.7;
+
+  Resampler2 res (mode, ratio, precision, sse, filter);
+  Resampler2 res_add (mode, ratio, precision, sse, filter);
+
+  vector<float> in (n_samples);
+  for (uint i = 0; i < n_samples; i++)
+    in[i] = sin (i * 0.013) * 0.9 + (rand() / double (RAND_MAX) - 0.5) * 0.1;
+
+  /* some existing data on the bus */
+  vector<float> bus (n_out_samples);
+  for (auto& b : bus)
+    b = rand() / double (RAND_MAX) - 0.5;
+
+  vector<float> out (n_out_samples);
+  res.process_block (in.data(), n_samples, out.data());
+
+  /* process with odd block sizes */
+  vector<float> out_add = bus;
+  uint pos = 0;
+  uint block_size = 1;
+  while (pos < n_samples)
+    {
+      uint n = min<uint> (block_size * ratio, n_samples - pos);
+      n -= n % ratio; // downsampler needs a multiple of ratio
+      if (n == 0)
+        n = n_samples - pos;
+
+      const uint out_pos = mode == Resampler2::UP ? pos * ratio : pos / ratio;
+      res_add.process_block_add (&in[pos], n, &out_add[out_pos], gain);
+      pos += n;
+      block_size = block_size * 7 % 1201 + 1;
+    }
+
+  double error = 0;
+  for (uint i = 0; i < n_out_samples; i++)
+    error = max (error, fabs (double (out_add[i]) - (bus[i] + out[i] * gain)));
+  return error;
+}
+
+static void
+perf (Resampler2::Mode mode, uint ratio, Resampler2::Filter filter)
+{
+  const uint n_input = 1024;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+  const uint n_blocks = 10000;
+  const float gain = 0.5;
+
+  vector<float> in (n_input), tmp (n_output), bus (n_output);
+
+  Resampler2 res (mode, ratio, Resampler2::PREC_96DB, true, filter);
+
+  /* process_block() + separate mix loop vs. process_block_add(), use the best of several runs */
+  double t_mix = 1e30, t_add = 1e30;
+  for (uint run = 0; run < 5; run++)
+    {
+      double t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        {
+          res.process_block (in.data(), n_input, tmp.data());
+          for (uint i = 0; i < n_output; i++)
+            bus[i] += tmp[i] * gain;
+        }
+      t_mix = min (t_mix, gettime() - t);
+
+      t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        res.process_block_add (in.data(), n_input, bus.data(), gain);
+      t_add = min (t_add, gettime() - t);
+    }
+
+  const double samples = double (n_blocks) * n_input;
+  printf ("process_block + mix: %f ns / sample, process_block_add: %f ns / sample\n", t_mix / samples * 1e9, t_add / samples * 1e9);
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc == 5 && !strcmp (argv[1], "perf"))
+    {
+      Resampler2::Filter filter = Resampler2::FILTER_FIR;
+      if (!strcmp (argv[4], "iir"))
+        filter = Resampler2::FILTER_IIR;
+      else if (!strcmp (argv[4], "fir-fixed"))
+        filter = Resampler2::FILTER_FIR_FIXED;
+
+      perf (strcmp (argv[2], "down") ? Resampler2::UP : Resampler2::DOWN, atoi (argv[3]), filter);
+      return 0;
+    }
+
+  bool ok = true;
+
+  for (auto filter : { Resampler2::FILTER_FIR, Resampler2::FILTER_FIR_FIXED, Resampler2::FILTER_IIR })
+    for (auto precision : { Resampler2::PREC_48DB, Resampler2::PREC_72DB, Resampler2::PREC_144DB })
+      for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+        for (uint ratio : { 1, 2, 4, 8 })
+          for (bool sse : { false, true })
+            {
+              double error = test_add (mode, ratio, precision, filter, sse);
+              printf ("%s %s %s ratio=%d %s error=%g\n",
+                      filter_name (filter),
+                      Resampler2::precision_name (precision),
+                      mode == Resampler2::UP ? "up" : "down",
+                      ratio, sse ? "sse" : "fpu", error);
+
+              /* the accumulated output may differ by float rounding errors (fma) */
+              if (error > 1e-5)
+                {
+                  printf ("  ERROR: process_block_add() output doesn't match process_block() output\n");
+                  ok = false;
+                }
+            }
+
+  return ok ? 0 : 1;
+}
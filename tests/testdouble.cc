@@ -0,0 +1,164 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <sys/time.h>
+
+using PandaResampler::Resampler2;
+
+using std::vector;
+using std::max;
+
+static double
+gettime()
+{
+  timeval tv;
+  gettimeofday (&tv, 0);
+
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+struct Errors
+{
+  double float_error = 0; /* double precision vs. float resampler */
+  double fpu_error = 0;   /* vectorized vs. FPU double precision resampler */
+};
+
+/* processes a signal with odd block sizes using the double precision API */
+static void
+process_double (Resampler2& resampler, Resampler2::Mode mode, uint ratio, const vector<double>& in, vector<double>& out)
+{
+  uint pos = 0;
+  uint block_size = 1;
+  while (pos < in.size())
+    {
+      uint n = std::min<uint> (block_size * ratio, in.size() - pos);
+      n -= n % ratio; // downsampler needs a multiple of ratio
+      if (n == 0)
+        n = in.size() - pos;
+
+      const uint out_pos = mode == Resampler2::UP ? pos * ratio : pos / ratio;
+      resampler.process_block (&in[pos], n, &out[out_pos]);
+
+      pos += n;
+      block_size = block_size * 3 % 37 + 1;
+    }
+}
+
+static Errors
+test_double (Resampler2::Mode mode, uint ratio, Resampler2::Precision prec, Resampler2::Filter filter)
+{
+  const uint n_input = 1200;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+
+  Resampler2 res_float (mode, ratio, prec, true, filter);
+  Resampler2 res_double (mode, ratio, prec, true, filter);
+  Resampler2 res_fpu (mode, ratio, prec, false, filter);
+  res_double.enable_double(); // res_fpu creates its double stages on the first call
+
+  vector<double> in (n_input);
+  vector<float> in_float (n_input);
+  for (uint i = 0; i < n_input; i++)
+    {
+      in[i] = sin (i * 0.013) * 0.9 + (rand() / double (RAND_MAX) - 0.5) * 0.1;
+      in_float[i] = in[i];
+    }
+
+  vector<float> out_float (n_output);
+  res_float.process_block (in_float.data(), n_input, out_float.data());
+
+  vector<double> out_double (n_output);
+  process_double (res_double, mode, ratio, in, out_double);
+  vector<double> out_fpu (n_output);
+  res_fpu.process_block (in.data(), n_input, out_fpu.data());
+
+  Errors errors;
+  for (uint i = 0; i < n_output; i++)
+    {
+      errors.float_error = max (errors.float_error, fabs (out_double[i] - out_float[i]));
+      errors.fpu_error = max (errors.fpu_error, fabs (out_double[i] - out_fpu[i]));
+    }
+  return errors;
+}
+
+static void
+perf (Resampler2::Mode mode, uint ratio, Resampler2::Precision prec, Resampler2::Filter filter)
+{
+  const uint n_input = 1024;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+  const uint n_blocks = 10000;
+
+  vector<float> in_float (n_input), out_float (n_output);
+  vector<double> in (n_input), out (n_output);
+
+  Resampler2 res (mode, ratio, prec, true, filter);
+  res.enable_double();
+
+  /* alternate between float and double processing, use the best of several runs */
+  double t_float = 1e30, t_double = 1e30;
+  for (uint run = 0; run < 5; run++)
+    {
+      double t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        res.process_block (in_float.data(), n_input, out_float.data());
+      t_float = std::min (t_float, gettime() - t);
+
+      t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        res.process_block (in.data(), n_input, out.data());
+      t_double = std::min (t_double, gettime() - t);
+    }
+
+  const double samples = double (n_blocks) * n_input;
+  printf ("float: %f ns / sample, double: %f ns / sample\n", t_float / samples * 1e9, t_double / samples * 1e9);
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc == 6 && !strcmp (argv[1], "perf"))
+    {
+      perf (strcmp (argv[2], "down") ? Resampler2::UP : Resampler2::DOWN,
+            atoi (argv[3]),
+            Resampler2::find_precision_for_bits (atoi (argv[4])),
+            strcmp (argv[5], "iir") ? Resampler2::FILTER_FIR : Resampler2::FILTER_IIR);
+      return 0;
+    }
+
+  bool ok = true;
+
+  for (auto filter : { Resampler2::FILTER_FIR, Resampler2::FILTER_IIR })
+    for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+      for (uint ratio : { 1, 2, 4, 8 })
+        for (auto prec : { Resampler2::PREC_LINEAR, Resampler2::PREC_48DB, Resampler2::PREC_96DB, Resampler2::PREC_144DB })
+          {
+            if (prec == Resampler2::PREC_LINEAR && filter != Resampler2::FILTER_FIR)
+              continue; // linear interpolation is only available as FIR filter
+
+            Errors errors = test_double (mode, ratio, prec, filter);
+            printf ("%s %s ratio=%d bits=%d float_error=%g fpu_error=%g\n",
+                    filter == Resampler2::FILTER_FIR ? "fir" : "iir",
+                    mode == Resampler2::UP ? "up" : "down",
+                    ratio, prec, errors.float_error, errors.fpu_error);
+
+            /* the float resampler has float rounding errors, the vectorized and FPU
+             * double precision resamplers only differ by double rounding errors
+             */
+            if (errors.float_error > 1e-5)
+              {
+                printf ("  ERROR: double precision output doesn't match float output\n");
+                ok = false;
+              }
+            if (errors.fpu_error > 1e-12)
+              {
+                printf ("  ERROR: vectorized double precision output doesn't match FPU output\n");
+                ok = false;
+              }
+          }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <sys/time.h>
+
+using PandaResampler::Resampler2;
+
+using std::vector;
+using std::max;
+using std::min;
+
+static double
+gettime()
+{
+  timeval tv;
+  gettimeofday (&tv, 0);
+
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* returns the maximum difference between processing small blocks and processing the whole signal at once */
+static double
+test_small_blocks (Resampler2::Mode mode, uint ratio, Resampler2::Precision precision, bool use_sse, uint channels, uint max_block_size)
+{
+  const uint n_frames = 5000;
+  const uint n_out_frames = mode == Resampler2::UP ? n_frames * ratio : n_frames / ratio;
+
+  Resampler2 res (mode, ratio, precision, use_sse, Resampler2::FILTER_FIR, channels);
+  Resampler2 res_small (mode, ratio, precision, use_sse, Resampler2::FILTER_FIR, channels);
+
+  vector<float> in (n_frames * channels);
+  for (auto& v : in)
+    v = rand() / double (RAND_MAX) - 0.5;
+
+  vector<float> out (n_out_frames * channels);
+  res.process_block_interleaved (in.data(), n_frames, out.data());
+
+  /* block sizes between 1 and max_block_size frames (multiplied by ratio) */
+  vector<float> out_small (n_out_frames * channels);
+  uint pos = 0;
+  uint block_size = 1;
+  while (pos < n_frames)
+    {
+      const uint n = min (block_size * ratio, n_frames - pos);
+      const uint out_pos = mode == Resampler2::UP ? pos * ratio : pos / ratio;
+
+      res_small.process_block_interleaved (&in[pos * channels], n, &out_small[out_pos * channels]);
+      pos += n;
+      block_size = block_size * 7 % max_block_size + 1;
+    }
+
+  double error = 0;
+  for (uint i = 0; i < n_out_frames * channels; i++)
+    error = max (error, fabs (double (out_small[i]) - out[i]));
+  return error;
+}
+
+static void
+perf (Resampler2::Mode mode, uint block_size)
+{
+  const uint n_input = mode == Resampler2::UP ? block_size : block_size * 2;
+  const uint n_output = mode == Resampler2::UP ? block_size * 2 : block_size;
+  const uint n_blocks = 20000000 / n_input;
+
+  vector<float> in (n_input), out (n_output);
+
+  for (auto precision : { Resampler2::PREC_48DB, Resampler2::PREC_72DB, Resampler2::PREC_96DB, Resampler2::PREC_120DB, Resampler2::PREC_144DB })
+    {
+      Resampler2 res (mode, 2, precision, true, Resampler2::FILTER_FIR);
+
+      /* use the best of several runs */
+      double t_best = 1e30;
+      for (uint run = 0; run < 5; run++)
+        {
+          double t = gettime();
+          for (uint b = 0; b < n_blocks; b++)
+            res.process_block (in.data(), n_input, out.data());
+          t_best = min (t_best, gettime() - t);
+        }
+      printf ("order %3d: %f ns / sample\n", res.order(), t_best / (double (n_blocks) * n_input) * 1e9);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc == 4 && !strcmp (argv[1], "perf"))
+    {
+      perf (strcmp (argv[2], "down") ? Resampler2::UP : Resampler2::DOWN, atoi (argv[3]));
+      return 0;
+    }
+
+  bool ok = true;
+
+  for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+    for (uint ratio : { 2, 4 })
+      for (auto precision : { Resampler2::PREC_48DB, Resampler2::PREC_96DB, Resampler2::PREC_144DB })
+        for (bool use_sse : { true, false })
+          for (uint channels : { 1, 2 })
+            for (uint max_block_size : { 1, 3, 17, 200 })
+              {
+                double error = test_small_blocks (mode, ratio, precision, use_sse, channels, max_block_size);
+                printf ("%s ratio=%d precision=%d%s channels=%d max_block_size=%d error=%g\n",
+                        mode == Resampler2::UP ? "up" : "down",
+                        ratio, precision, use_sse ? "" : " (fpu)", channels, max_block_size, error);
+
+                /* block sizes differ, so rounding errors may differ, too */
+                if (error > 1e-6)
+                  {
+                    printf ("  ERROR: output for small blocks doesn't match output for the whole signal\n");
+                    ok = false;
+                  }
+              }
+
+  return ok ? 0 : 1;
+}
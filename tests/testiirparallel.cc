@@ -0,0 +1,82 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+using PandaResampler::Resampler2;
+
+using std::vector;
+using std::max;
+
+/* compares time-parallel IIR evaluation with sequential IIR evaluation */
+static double
+test_iir_parallel (Resampler2::Mode mode, uint ratio, Resampler2::Precision prec)
+{
+  const uint n_input = 2000;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+
+  Resampler2 parallel (mode, ratio, prec, true, Resampler2::FILTER_IIR_PARALLEL);
+  Resampler2 sequential (mode, ratio, prec, true, Resampler2::FILTER_IIR);
+
+  vector<float> in (n_input);
+  vector<float> out_parallel (n_output);
+  vector<float> out_sequential (n_output);
+
+  for (uint i = 0; i < n_input; i++)
+    in[i] = sin (i * 0.031) * 0.9 + (rand() / double (RAND_MAX) - 0.5) * 0.1;
+
+  sequential.process_block (in.data(), n_input, out_sequential.data());
+
+  /* process time-parallel resampler with odd block sizes */
+  uint pos = 0;
+  uint block_size = 1;
+  while (pos < n_input)
+    {
+      uint n = std::min (block_size * ratio, n_input - pos);
+      n -= n % ratio; // downsampler needs a multiple of ratio
+      if (n == 0)
+        n = n_input - pos;
+
+      const uint out_pos = mode == Resampler2::UP ? pos * ratio : pos / ratio;
+      parallel.process_block (&in[pos], n, &out_parallel[out_pos]);
+
+      pos += n;
+      block_size = block_size * 5 % 71 + 1;
+    }
+
+  double error = 0;
+  for (uint i = 0; i < n_output; i++)
+    error = max (error, fabs (double (out_parallel[i]) - out_sequential[i]));
+
+  if (parallel.delay() != sequential.delay())
+    error = 1;
+
+  return error;
+}
+
+int
+main()
+{
+  bool ok = true;
+
+  for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+    for (uint ratio : { 2, 4, 8 })
+      for (auto prec : { Resampler2::PREC_48DB, Resampler2::PREC_72DB, Resampler2::PREC_96DB,
+                         Resampler2::PREC_120DB, Resampler2::PREC_144DB })
+        {
+          double error = test_iir_parallel (mode, ratio, prec);
+          /* only rounding errors are expected */
+          const double bound = 1e-5;
+          printf ("%s ratio=%d bits=%d error=%g\n", mode == Resampler2::UP ? "up" : "down", ratio, prec, error);
+          if (error > bound)
+            {
+              printf ("  ERROR: time-parallel IIR output mismatch (bound %g)\n", bound);
+              ok = false;
+            }
+        }
+
+  return ok ? 0 : 1;
+}
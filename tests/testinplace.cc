@@ -0,0 +1,149 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+using PandaResampler::Resampler2;
+
+using std::vector;
+using std::max;
+using std::min;
+
+enum Layout { MONO, INTERLEAVED, PLANAR, DOUBLE };
+
+static const char *
+layout_name (Layout layout)
+{
+  switch (layout)
+    {
+      case MONO:        return "mono";
+      case INTERLEAVED: return "interleaved";
+      case PLANAR:      return "planar";
+      case DOUBLE:      return "double";
+    }
+  return "";
+}
+
+/* process one block with separate buffers (out) and in-place (in the buffer buf) */
+template<class T> static void
+process (Resampler2& res, Resampler2& res_in_place, Resampler2::Mode mode, uint ratio, Layout layout, uint channels,
+         const T *in, uint n_frames, T *out, T *buf)
+{
+  const uint n_out_frames = mode == Resampler2::UP ? n_frames * ratio : n_frames / ratio;
+  const uint n_buf_frames = max (n_frames, n_out_frames);
+
+  /* input: at the start of the buffer for downsampling, at the end for upsampling */
+  const uint in_pos = n_buf_frames - n_frames;
+
+  if (layout == PLANAR)
+    {
+      const float *in_p[Resampler2::MAX_CHANNELS];
+      float *out_p[Resampler2::MAX_CHANNELS], *buf_in_p[Resampler2::MAX_CHANNELS], *buf_out_p[Resampler2::MAX_CHANNELS];
+      for (uint c = 0; c < channels; c++)
+        {
+          in_p[c]      = reinterpret_cast<const float *> (in) + c * n_frames;
+          out_p[c]     = reinterpret_cast<float *> (out) + c * n_out_frames;
+          buf_out_p[c] = reinterpret_cast<float *> (buf) + c * n_buf_frames;
+          buf_in_p[c]  = buf_out_p[c] + in_pos;
+          std::copy (in_p[c], in_p[c] + n_frames, buf_in_p[c]);
+        }
+      res.process_block (in_p, n_frames, out_p);
+      res_in_place.process_block (buf_in_p, n_frames, buf_out_p);
+    }
+  else
+    {
+      std::copy (in, in + n_frames * channels, buf + in_pos * channels);
+      if (layout == INTERLEAVED)
+        {
+          res.process_block_interleaved (reinterpret_cast<const float *> (in), n_frames, reinterpret_cast<float *> (out));
+          res_in_place.process_block_interleaved (reinterpret_cast<float *> (buf) + in_pos * channels, n_frames, reinterpret_cast<float *> (buf));
+        }
+      else
+        {
+          res.process_block (in, n_frames, out);
+          res_in_place.process_block (buf + in_pos, n_frames, buf);
+        }
+    }
+}
+
+/* returns the maximum difference between in-place processing and processing with separate buffers */
+template<class T> static double
+test_in_place (Resampler2::Mode mode, uint ratio, Resampler2::Filter filter, Layout layout, uint channels)
+{
+  Resampler2 res (mode, ratio, Resampler2::PREC_96DB, true, filter, channels);
+  Resampler2 res_in_place (mode, ratio, Resampler2::PREC_96DB, true, filter, channels);
+
+  double error = 0;
+  uint block_size = 1;
+  for (uint b = 0; b < 20; b++)
+    {
+      const uint n_frames = block_size * ratio;
+      const uint n_out_frames = mode == Resampler2::UP ? n_frames * ratio : n_frames / ratio;
+
+      vector<T> in (n_frames * channels);
+      for (auto& v : in)
+        v = rand() / double (RAND_MAX) - 0.5;
+
+      vector<T> out (n_out_frames * channels);
+      vector<T> buf (max (n_frames, n_out_frames) * channels);
+      process (res, res_in_place, mode, ratio, layout, channels, in.data(), n_frames, out.data(), buf.data());
+
+      const uint n_buf_frames = max (n_frames, n_out_frames);
+      for (uint c = 0; c < channels; c++)
+        for (uint i = 0; i < n_out_frames; i++)
+          {
+            T value, expected;
+            if (layout == PLANAR)
+              {
+                value    = buf[c * n_buf_frames + i];
+                expected = out[c * n_out_frames + i];
+              }
+            else
+              {
+                value    = buf[i * channels + c];
+                expected = out[i * channels + c];
+              }
+            error = max (error, fabs (double (value) - expected));
+          }
+      block_size = block_size * 7 % 1201 + 1;
+    }
+  return error;
+}
+
+int
+main()
+{
+  bool ok = true;
+
+  for (auto filter : { Resampler2::FILTER_FIR, Resampler2::FILTER_IIR })
+    for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+      for (uint ratio : { 1, 2, 4, 8 })
+        for (auto layout : { MONO, INTERLEAVED, PLANAR, DOUBLE })
+          for (uint channels : { 1, 2, 3, 8 })
+            {
+              if ((layout == MONO || layout == DOUBLE) && channels != 1)
+                continue;
+
+              double error;
+              if (layout == DOUBLE)
+                error = test_in_place<double> (mode, ratio, filter, layout, channels);
+              else
+                error = test_in_place<float> (mode, ratio, filter, layout, channels);
+              printf ("%s %s ratio=%d %s channels=%d error=%g\n",
+                      filter == Resampler2::FILTER_FIR ? "fir" : "iir",
+                      mode == Resampler2::UP ? "up" : "down",
+                      ratio, layout_name (layout), channels, error);
+
+              /* block sizes differ for in-place processing, so rounding errors may differ, too */
+              if (error > 1e-6)
+                {
+                  printf ("  ERROR: in-place output doesn't match output with separate buffers\n");
+                  ok = false;
+                }
+            }
+
+  return ok ? 0 : 1;
+}
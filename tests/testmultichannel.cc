@@ -0,0 +1,216 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <sys/time.h>
+
+using PandaResampler::Resampler2;
+
+using std::vector;
+using std::max;
+
+static double
+gettime()
+{
+  timeval tv;
+  gettimeofday (&tv, 0);
+
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* compares planar (or interleaved) multi-channel processing with one mono resampler per channel */
+static double
+test_multi_channel (Resampler2::Mode mode, uint ratio, uint channels, Resampler2::Filter filter, bool sse, bool interleaved)
+{
+  const Resampler2::Precision prec = Resampler2::PREC_96DB;
+  const uint n_input = 1000;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+
+  Resampler2 multi (mode, ratio, prec, sse, filter, channels);
+  vector<Resampler2> mono;
+  for (uint c = 0; c < channels; c++)
+    mono.emplace_back (mode, ratio, prec, sse, filter);
+
+  vector<vector<float>> in (channels, vector<float> (n_input));
+  vector<vector<float>> out_multi (channels, vector<float> (n_output));
+  vector<vector<float>> out_mono (channels, vector<float> (n_output));
+
+  for (uint c = 0; c < channels; c++)
+    for (uint i = 0; i < n_input; i++)
+      in[c][i] = sin (i * (c + 1) * 0.013) * 0.9 + (rand() / double (RAND_MAX) - 0.5) * 0.1;
+
+  for (uint c = 0; c < channels; c++)
+    mono[c].process_block (in[c].data(), n_input, out_mono[c].data());
+
+  vector<float> in_interleaved (n_input * channels);
+  vector<float> out_interleaved (n_output * channels);
+  for (uint i = 0; i < n_input; i++)
+    for (uint c = 0; c < channels; c++)
+      in_interleaved[i * channels + c] = in[c][i];
+
+  /* process multi channel resampler with odd block sizes */
+  uint pos = 0;
+  uint block_size = 1;
+  while (pos < n_input)
+    {
+      uint n = std::min (block_size * ratio, n_input - pos);
+      n -= n % ratio; // downsampler needs a multiple of ratio
+      if (n == 0)
+        n = n_input - pos;
+
+      const float *in_p[Resampler2::MAX_CHANNELS];
+      float *out_p[Resampler2::MAX_CHANNELS];
+      const uint out_pos = mode == Resampler2::UP ? pos * ratio : pos / ratio;
+      for (uint c = 0; c < channels; c++)
+        {
+          in_p[c] = in[c].data() + pos;
+          out_p[c] = out_multi[c].data() + out_pos;
+        }
+      if (interleaved)
+        multi.process_block_interleaved (&in_interleaved[pos * channels], n, &out_interleaved[out_pos * channels]);
+      else
+        multi.process_block (in_p, n, out_p);
+
+      pos += n;
+      block_size = block_size * 3 % 37 + 1;
+    }
+
+  if (interleaved)
+    for (uint i = 0; i < n_output; i++)
+      for (uint c = 0; c < channels; c++)
+        out_multi[c][i] = out_interleaved[i * channels + c];
+
+  double error = 0;
+  for (uint c = 0; c < channels; c++)
+    for (uint i = 0; i < n_output; i++)
+      error = max (error, fabs (double (out_multi[c][i]) - out_mono[c][i]));
+
+  if (multi.delay() != mono[0].delay())
+    error = 1;
+
+  return error;
+}
+
+/* compares complex (I/Q) processing with one mono resampler for the real and one for the imaginary part */
+static double
+test_complex (Resampler2::Mode mode, uint ratio, Resampler2::Filter filter)
+{
+  const Resampler2::Precision prec = Resampler2::PREC_96DB;
+  const uint n_input = 1000;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+
+  Resampler2 iq (mode, ratio, prec, true, filter, 2);
+  Resampler2 mono_re (mode, ratio, prec, true, filter);
+  Resampler2 mono_im (mode, ratio, prec, true, filter);
+
+  vector<std::complex<float>> in (n_input), out (n_output);
+  vector<float> in_re (n_input), in_im (n_input), out_re (n_output), out_im (n_output);
+  for (uint i = 0; i < n_input; i++)
+    {
+      in[i] = std::polar (0.9f, float (i * 0.021));
+      in_re[i] = in[i].real();
+      in_im[i] = in[i].imag();
+    }
+  iq.process_block_complex (in.data(), n_input, out.data());
+  mono_re.process_block (in_re.data(), n_input, out_re.data());
+  mono_im.process_block (in_im.data(), n_input, out_im.data());
+
+  double error = 0;
+  for (uint i = 0; i < n_output; i++)
+    {
+      error = max (error, fabs (double (out[i].real()) - out_re[i]));
+      error = max (error, fabs (double (out[i].imag()) - out_im[i]));
+    }
+  return error;
+}
+
+static void
+perf (Resampler2::Mode mode, uint ratio, Resampler2::Precision prec, uint channels, Resampler2::Filter filter)
+{
+  const uint n_input = 128;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+  const uint n_blocks = 2000000 / channels;
+
+  vector<vector<float>> in (channels, vector<float> (n_input));
+  vector<vector<float>> out (channels, vector<float> (n_output));
+  const float *in_p[Resampler2::MAX_CHANNELS];
+  float *out_p[Resampler2::MAX_CHANNELS];
+  for (uint c = 0; c < channels; c++)
+    {
+      in_p[c] = in[c].data();
+      out_p[c] = out[c].data();
+    }
+
+  Resampler2 multi (mode, ratio, prec, true, filter, channels);
+
+  /* use the best of several runs */
+  double t_best = 1e30;
+  for (uint run = 0; run < 5; run++)
+    {
+      const double t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        multi.process_block (in_p, n_input, out_p);
+      t_best = std::min (t_best, gettime() - t);
+    }
+  printf ("%f ns / sample\n", t_best / (double (n_blocks) * n_input * channels) * 1e9);
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc == 7 && !strcmp (argv[1], "perf"))
+    {
+      perf (strcmp (argv[2], "down") ? Resampler2::UP : Resampler2::DOWN,
+            atoi (argv[3]),
+            Resampler2::find_precision_for_bits (atoi (argv[4])),
+            atoi (argv[5]),
+            strcmp (argv[6], "iir") ? Resampler2::FILTER_FIR : Resampler2::FILTER_IIR);
+      return 0;
+    }
+
+  bool ok = true;
+
+  for (auto filter : { Resampler2::FILTER_FIR, Resampler2::FILTER_IIR })
+    for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+      for (uint ratio : { 1, 2, 4, 8 })
+        for (uint channels : { 1, 2, 3, 8 })
+          for (bool sse : { false, true })
+            for (bool interleaved : { false, true })
+              {
+                double error = test_multi_channel (mode, ratio, channels, filter, sse, interleaved);
+                /* vectorized IIR uses different rounding than mono IIR, allow small differences */
+                const double bound = 1e-5;
+                printf ("%s %s ratio=%d channels=%d sse=%d interleaved=%d error=%g\n",
+                        filter == Resampler2::FILTER_FIR ? "fir" : "iir",
+                        mode == Resampler2::UP ? "up" : "down",
+                        ratio, channels, sse, interleaved, error);
+                if (error > bound)
+                  {
+                    printf ("  ERROR: multi channel output mismatch (bound %g)\n", bound);
+                    ok = false;
+                  }
+              }
+
+  for (auto filter : { Resampler2::FILTER_FIR, Resampler2::FILTER_IIR })
+    for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+      for (uint ratio : { 2, 8 })
+        {
+          double error = test_complex (mode, ratio, filter);
+          printf ("%s %s ratio=%d complex error=%g\n",
+                  filter == Resampler2::FILTER_FIR ? "fir" : "iir",
+                  mode == Resampler2::UP ? "up" : "down",
+                  ratio, error);
+          if (error > 1e-5)
+            {
+              printf ("  ERROR: complex output mismatch\n");
+              ok = false;
+            }
+        }
+
+  return ok ? 0 : 1;
+}
@@ -22,7 +22,7 @@ main (int argc, char **argv)
 {
   if (argc != 5)
     {
-      fprintf (stderr, "testmultiperf up|down|over <ratio> <bits> fir|iir|iir-sse\n");
+      fprintf (stderr, "testmultiperf up|down|over <ratio> <bits> fir|iir|iir-sse|iir-parallel\n");
       return 1;
     }
   bool up = strcmp (argv[1], "up") == 0;
@@ -43,12 +43,19 @@ main (int argc, char **argv)
   bool fir = strcmp (argv[4], "fir") == 0;
   bool iir = strcmp (argv[4], "iir") == 0;
   bool iir_sse = strcmp (argv[4], "iir-sse") == 0;
-  bool sse = fir || iir_sse;
+  bool iir_parallel = strcmp (argv[4], "iir-parallel") == 0;
+  bool sse = fir || iir_sse || iir_parallel;
 
-  assert (fir || iir || iir_sse);
+  assert (fir || iir || iir_sse || iir_parallel);
 
-  Resampler2 ups (Resampler2::UP, ratio, prec, sse, fir ? Resampler2::FILTER_FIR : Resampler2::FILTER_IIR);
-  Resampler2 downs (Resampler2::DOWN, ratio, prec, sse, fir ? Resampler2::FILTER_FIR : Resampler2::FILTER_IIR);
+  Resampler2::Filter filter = Resampler2::FILTER_IIR;
+  if (fir)
+    filter = Resampler2::FILTER_FIR;
+  if (iir_parallel)
+    filter = Resampler2::FILTER_IIR_PARALLEL;
+
+  Resampler2 ups (Resampler2::UP, ratio, prec, sse, filter);
+  Resampler2 downs (Resampler2::DOWN, ratio, prec, sse, filter);
 
   constexpr int SAMPLES = 128;
   constexpr int MAX_RATIO = 8;
@@ -0,0 +1,194 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <sys/time.h>
+
+using PandaResampler::Resampler2;
+using PandaResampler::Oversampler;
+
+using std::vector;
+using std::max;
+using std::min;
+
+static double
+gettime()
+{
+  timeval tv;
+  gettimeofday (&tv, 0);
+
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+struct Identity
+{
+  float
+  operator() (float x) const
+  {
+    return x;
+  }
+};
+
+/* per sample function */
+struct Saturate
+{
+  float
+  operator() (float x) const
+  {
+    return std::tanh (x * 3);
+  }
+};
+
+/* same function, but called for a block of samples */
+struct SaturateBlock
+{
+  void
+  operator() (float *samples, uint n_samples) const
+  {
+    for (uint i = 0; i < n_samples; i++)
+      samples[i] = std::tanh (samples[i] * 3);
+  }
+};
+
+/* returns the maximum difference between Oversampler and upsampling / saturation / downsampling the whole block */
+template<class Func> static double
+test_saturate (uint ratio, Resampler2::Filter filter)
+{
+  const uint n_samples = 5000;
+
+  Resampler2 ups (Resampler2::UP, ratio, Resampler2::PREC_72DB, true, filter);
+  Resampler2 downs (Resampler2::DOWN, ratio, Resampler2::PREC_72DB, true, filter);
+  Oversampler<Func> oversampler (ratio, Resampler2::PREC_72DB, Func(), filter);
+
+  vector<float> in (n_samples);
+  for (uint i = 0; i < n_samples; i++)
+    in[i] = sin (i * 0.013) * 0.9 + (rand() / double (RAND_MAX) - 0.5) * 0.1;
+
+  vector<float> tmp (n_samples * ratio), out (n_samples);
+  ups.process_block (in.data(), n_samples, tmp.data());
+  for (auto& t : tmp)
+    t = std::tanh (t * 3);
+  downs.process_block (tmp.data(), n_samples * ratio, out.data());
+
+  /* process with odd block sizes, in-place */
+  vector<float> out_os = in;
+  uint pos = 0;
+  uint block_size = 1;
+  while (pos < n_samples)
+    {
+      const uint n = min (block_size, n_samples - pos);
+
+      oversampler.process_block (&out_os[pos], n, &out_os[pos]);
+      pos += n;
+      block_size = block_size * 7 % 1201 + 1;
+    }
+
+  double error = 0;
+  for (uint i = 0; i < n_samples; i++)
+    error = max (error, fabs (double (out_os[i]) - out[i]));
+  return error;
+}
+
+/* returns the maximum difference between the output of the round trip and the input delayed by delay() */
+static double
+test_delay (uint ratio, Resampler2::Filter filter)
+{
+  const uint n_samples = 5000;
+  const double freq = 0.01;
+
+  Oversampler<Identity> oversampler (ratio, Resampler2::PREC_96DB, Identity(), filter);
+
+  vector<float> in (n_samples), out (n_samples);
+  for (uint i = 0; i < n_samples; i++)
+    in[i] = sin (i * freq);
+
+  oversampler.process_block (in.data(), n_samples, out.data());
+
+  double error = 0;
+  for (uint i = 1000; i < n_samples; i++)
+    error = max (error, fabs (out[i] - sin ((i - oversampler.delay()) * freq)));
+  return error;
+}
+
+static void
+perf (uint ratio)
+{
+  const uint n_samples = 1024;
+  const uint n_blocks = 20000 / ratio;
+
+  Resampler2 ups (Resampler2::UP, ratio, Resampler2::PREC_72DB);
+  Resampler2 downs (Resampler2::DOWN, ratio, Resampler2::PREC_72DB);
+  Oversampler<Saturate> oversampler (ratio, Resampler2::PREC_72DB);
+
+  vector<float> in (n_samples), tmp (n_samples * ratio), out (n_samples);
+  for (uint i = 0; i < n_samples; i++)
+    in[i] = sin (i * 0.013) * 0.9;
+
+  /* whole block vs. tiles, use the best of several runs */
+  double t_block = 1e30, t_tiles = 1e30;
+  for (uint run = 0; run < 5; run++)
+    {
+      double t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        {
+          ups.process_block (in.data(), n_samples, tmp.data());
+          for (auto& v : tmp)
+            v = std::tanh (v * 3);
+          downs.process_block (tmp.data(), n_samples * ratio, out.data());
+        }
+      t_block = min (t_block, gettime() - t);
+
+      t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        oversampler.process_block (in.data(), n_samples, out.data());
+      t_tiles = min (t_tiles, gettime() - t);
+    }
+
+  const double samples = double (n_blocks) * n_samples;
+  printf ("whole block: %f ns / sample, oversampler (tile size %d): %f ns / sample\n",
+          t_block / samples * 1e9, oversampler.tile_size(), t_tiles / samples * 1e9);
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc == 3 && !strcmp (argv[1], "perf"))
+    {
+      perf (atoi (argv[2]));
+      return 0;
+    }
+
+  bool ok = true;
+
+  for (auto filter : { Resampler2::FILTER_FIR, Resampler2::FILTER_IIR })
+    for (uint ratio : { 2, 4, 8 })
+      {
+        const char *filter_name = filter == Resampler2::FILTER_FIR ? "fir" : "iir";
+
+        double error = test_saturate<Saturate> (ratio, filter);
+        double error_block = test_saturate<SaturateBlock> (ratio, filter);
+        printf ("%s ratio=%d saturate error=%g block error=%g\n", filter_name, ratio, error, error_block);
+
+        /* tile sizes differ, so rounding errors may differ, too */
+        if (error > 1e-5 || error_block > 1e-5)
+          {
+            printf ("  ERROR: oversampler output doesn't match output of whole block processing\n");
+            ok = false;
+          }
+
+        /* the IIR filters are not linear phase, so the delay is only correct for low frequencies */
+        double delay_error = test_delay (ratio, filter);
+        printf ("%s ratio=%d delay error=%g\n", filter_name, ratio, delay_error);
+        if (delay_error > 1e-3)
+          {
+            printf ("  ERROR: oversampler output doesn't match delayed input\n");
+            ok = false;
+          }
+      }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <sys/time.h>
+
+using PandaResampler::Resampler2;
+
+using std::vector;
+using std::max;
+using std::min;
+
+static double
+gettime()
+{
+  timeval tv;
+  gettimeofday (&tv, 0);
+
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static uint
+sample_size (Resampler2::SampleFormat format)
+{
+  return format == Resampler2::FORMAT_S16 ? 2 : (format == Resampler2::FORMAT_S24 ? 3 : 4);
+}
+
+static double
+scale (Resampler2::SampleFormat format)
+{
+  return format == Resampler2::FORMAT_S16 ? 32768 : (format == Resampler2::FORMAT_S24 ? 8388608 : 2147483648.0);
+}
+
+static const char *
+format_name (Resampler2::SampleFormat format)
+{
+  return format == Resampler2::FORMAT_S16 ? "s16" : (format == Resampler2::FORMAT_S24 ? "s24" : "s32");
+}
+
+static int32_t
+read_sample (const vector<uint8_t>& data, Resampler2::SampleFormat format, uint i)
+{
+  const uint8_t *p = &data[i * sample_size (format)];
+  int16_t s16;
+  int32_t s32;
+  switch (format)
+    {
+      case Resampler2::FORMAT_S16:
+        memcpy (&s16, p, 2);
+        return s16;
+      case Resampler2::FORMAT_S24:
+        return int32_t (uint32_t (p[0]) << 8 | uint32_t (p[1]) << 16 | uint32_t (p[2]) << 24) >> 8;
+      case Resampler2::FORMAT_S32:
+        memcpy (&s32, p, 4);
+        return s32;
+    }
+  return 0;
+}
+
+static void
+write_sample (vector<uint8_t>& data, Resampler2::SampleFormat format, uint i, int32_t value)
+{
+  uint8_t *p = &data[i * sample_size (format)];
+  int16_t s16 = value;
+  switch (format)
+    {
+      case Resampler2::FORMAT_S16:
+        memcpy (p, &s16, 2);
+        break;
+      case Resampler2::FORMAT_S24:
+        p[0] = value;
+        p[1] = value >> 8;
+        p[2] = value >> 16;
+        break;
+      case Resampler2::FORMAT_S32:
+        memcpy (p, &value, 4);
+        break;
+    }
+}
+
+/* returns the maximum difference between integer and float (+ reference conversion) resampling */
+static double
+test_pcm (Resampler2::Mode mode, uint ratio, Resampler2::Filter filter, uint channels, Resampler2::SampleFormat format)
+{
+  const uint n_frames = 1200;
+  const uint n_out_frames = mode == Resampler2::UP ? n_frames * ratio : n_frames / ratio;
+  const double fscale = scale (format);
+  const double fmax = format == Resampler2::FORMAT_S32 ? 2147483520.0 : fscale - 1;
+
+  Resampler2 res_float (mode, ratio, Resampler2::PREC_96DB, true, filter, channels);
+  Resampler2 res_pcm (mode, ratio, Resampler2::PREC_96DB, true, filter, channels);
+
+  /* the signal is louder than full scale to test saturation */
+  vector<uint8_t> in (n_frames * channels * sample_size (format));
+  vector<float> in_float (n_frames * channels);
+  for (uint i = 0; i < n_frames * channels; i++)
+    {
+      double value = sin (i * 0.013) * 1.2 + (rand() / double (RAND_MAX) - 0.5) * 0.1;
+      int32_t ivalue = lrint (min (max (value * fscale, -fscale), fmax));
+      write_sample (in, format, i, ivalue);
+      in_float[i] = ivalue / fscale;
+    }
+
+  vector<float> out_float (n_out_frames * channels);
+  res_float.process_block_interleaved (in_float.data(), n_frames, out_float.data());
+
+  /* process with odd block sizes */
+  vector<uint8_t> out (n_out_frames * channels * sample_size (format));
+  uint pos = 0;
+  uint block_size = 1;
+  while (pos < n_frames)
+    {
+      uint n = min<uint> (block_size * ratio, n_frames - pos);
+      n -= n % ratio; // downsampler needs a multiple of ratio
+      if (n == 0)
+        n = n_frames - pos;
+
+      const uint out_pos = mode == Resampler2::UP ? pos * ratio : pos / ratio;
+      res_pcm.process_block_pcm (&in[pos * channels * sample_size (format)], format, n,
+                                 &out[out_pos * channels * sample_size (format)], format);
+      pos += n;
+      block_size = block_size * 7 % 601 + 1;
+    }
+
+  double error = 0;
+  for (uint i = 0; i < n_out_frames * channels; i++)
+    {
+      double expected = min (max (double (out_float[i]) * fscale, -fscale), fmax);
+      error = max (error, fabs (read_sample (out, format, i) - expected) / fscale);
+    }
+  return error;
+}
+
+static void
+perf (Resampler2::Mode mode, uint ratio, Resampler2::Filter filter)
+{
+  const uint n_input = 1024;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+  const uint n_blocks = 10000;
+
+  vector<int16_t> in (n_input), out (n_output);
+  vector<float> in_float (n_input), out_float (n_output);
+
+  Resampler2 res (mode, ratio, Resampler2::PREC_96DB, true, filter);
+
+  /* separate conversion passes vs. process_block (int16_t), use the best of several runs */
+  double t_passes = 1e30, t_pcm = 1e30;
+  for (uint run = 0; run < 5; run++)
+    {
+      double t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        {
+          for (uint i = 0; i < n_input; i++)
+            in_float[i] = in[i] * (1 / 32768.f);
+          res.process_block (in_float.data(), n_input, out_float.data());
+          for (uint i = 0; i < n_output; i++)
+            out[i] = lrintf (min (max (out_float[i] * 32768.f, -32768.f), 32767.f));
+        }
+      t_passes = min (t_passes, gettime() - t);
+
+      t = gettime();
+      for (uint b = 0; b < n_blocks; b++)
+        res.process_block (in.data(), n_input, out.data());
+      t_pcm = min (t_pcm, gettime() - t);
+    }
+
+  const double samples = double (n_blocks) * n_input;
+  printf ("conversion passes: %f ns / sample, pcm: %f ns / sample\n", t_passes / samples * 1e9, t_pcm / samples * 1e9);
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc == 5 && !strcmp (argv[1], "perf"))
+    {
+      perf (strcmp (argv[2], "down") ? Resampler2::UP : Resampler2::DOWN,
+            atoi (argv[3]),
+            strcmp (argv[4], "iir") ? Resampler2::FILTER_FIR : Resampler2::FILTER_IIR);
+      return 0;
+    }
+
+  bool ok = true;
+
+  for (auto format : { Resampler2::FORMAT_S16, Resampler2::FORMAT_S24, Resampler2::FORMAT_S32 })
+    for (auto filter : { Resampler2::FILTER_FIR, Resampler2::FILTER_IIR })
+      for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+        for (uint ratio : { 1, 2, 4, 8 })
+          for (uint channels : { 1, 2, 3 })
+            {
+              double error = test_pcm (mode, ratio, filter, channels, format);
+              printf ("%s %s %s ratio=%d channels=%d error=%g\n",
+                      format_name (format),
+                      filter == Resampler2::FILTER_FIR ? "fir" : "iir",
+                      mode == Resampler2::UP ? "up" : "down",
+                      ratio, channels, error);
+
+              /* the output may differ by rounding (one least significant bit) and
+               * by float rounding errors (for different block sizes)
+               */
+              if (error > 1 / scale (format) + 1e-6)
+                {
+                  printf ("  ERROR: integer output doesn't match float output\n");
+                  ok = false;
+                }
+            }
+
+  return ok ? 0 : 1;
+}
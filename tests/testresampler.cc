@@ -84,6 +84,7 @@ enum TestType
 {
   TEST_NONE,
   TEST_PERFORMANCE,
+  TEST_BLOCK_PERFORMANCE,
   TEST_ACCURACY,
   TEST_ERROR_TABLE,
   TEST_ERROR_SPECTRUM,
@@ -116,6 +117,7 @@ struct Options {
   bool                    filter_impl_verbose = false;
   bool                    verbose             = false;
   bool                    use_sse             = false;
+  Resampler2::Filter      filter              = Resampler2::FILTER_FIR;
   bool                    standalone          = false;
   string                  program_name        = "testresampler";
 
@@ -132,6 +134,8 @@ usage ()
   printf ("\n");
   printf ("Commands:\n");
   printf ("  perf                  report sine resampling performance\n");
+  printf ("  perf-blocks           report performance for block sizes 1..256\n");
+  printf ("                        (block-size, ns-per-sample)\n");
   printf ("  accuracy              compare resampled sine signal against\n");
   printf ("                        ideal output, report time-domain errors\n");
   printf ("  error-table           print sine signals (index, resampled-value, ideal-value,\n");
@@ -139,7 +143,7 @@ usage ()
   printf ("  error-spectrum        compare resampled sine signal against ideal output,\n");
   printf ("                        print error spectrum (frequency, error-db)\n");
   printf ("  dirac                 print impulse response (response-value)\n");
-  printf ("  filter-impl           tests SSE filter implementation for correctness\n");
+  printf ("  filter-impl           tests SSE/AVX2 filter implementation for correctness\n");
   printf ("                        doesn't test anything when running without SSE support\n");
   printf ("  check                 run accuracy/filter-impl unit tests (for make check)\n");
   printf ("\n");
@@ -152,6 +156,7 @@ usage ()
   printf ("                        supported precisions: 8, 12, 16, 20, 24 [%d]\n", static_cast<int> (options.precision));
   printf ("  --precision-linear    use linear interpolation (very bad quality)\n");
   printf ("  --fpu                 disables loading of SSE or similarly optimized code\n");
+  printf ("  --fixed-point         use 16 bit fixed-point FIR filters (precision 8 and 12 only)\n");
   printf ("\n");
   printf ("Options:\n");
   printf (" --frequency=<freq>     use <freq> as sine test frequency [%f]\n", options.frequency);
@@ -170,6 +175,8 @@ usage ()
   printf ("Examples:\n");
   printf ("  # check performance of upsampling with 256 value blocks:\n");
   printf ("  testresampler perf --block-size=256\n");
+  printf ("  # check performance of downsampling for small block sizes:\n");
+  printf ("  testresampler perf-blocks --down\n");
   printf ("  # check accuracy of upsampling a 440 Hz sine signal:\n");
   printf ("  testresampler accuracy\n");
   printf ("  # check accuracy of downsampling using a 500 Hz frequency:\n");
@@ -293,6 +300,10 @@ Options::parse (int   *argc_p,
 	{
 	  use_sse = false;
 	}
+      else if (check_arg (argc, argv, &i, "--fixed-point"))
+	{
+	  filter = Resampler2::FILTER_FIR_FIXED;
+	}
       else if (check_arg (argc, argv, &i, "--freq-scan", &opt_arg))
 	{
 	  char *oa = strdup (opt_arg);
@@ -388,11 +399,12 @@ perform_test()
    *  - we can not provide optimal compiler flags (-funroll-loops -O3 is good for the resampler)
    *    which makes things even more slow
    */
-  Resampler2 ups (Resampler2::UP, 2, options.precision, options.use_sse);
-  Resampler2 downs (Resampler2::DOWN, 2, options.precision, options.use_sse);
+  Resampler2 ups (Resampler2::UP, 2, options.precision, options.use_sse, options.filter);
+  Resampler2 downs (Resampler2::DOWN, 2, options.precision, options.use_sse, options.filter);
 
   assert (options.use_sse == ups.sse_enabled());
   assert (options.use_sse == downs.sse_enabled());
+  assert (ups.instruction_set() == (options.use_sse ? Resampler2::instruction_set_available() : Resampler2::ISET_FPU));
 
   AlignedArray<float> in_a (block_size * 2), out_a (block_size * 2), out2_a (block_size * 2);
   float *input = &in_a[0], *output = &out_a[0], *output2 = &out2_a[0]; /* ensure aligned data */
@@ -441,6 +453,43 @@ perform_test()
       verbose_output += string_format ("  or one 44100 Hz stream takes %f %% CPU usage\n",
 	                               100.0 / (k / (end_time - start_time) / 44100.0));
     }
+  else if (TEST == TEST_BLOCK_PERFORMANCE)
+    {
+      /* the block size is the number of downsampler output samples or upsampler input samples */
+      const uint max_block_size = 256;
+      const double test_frequency = options.frequency;
+
+      AlignedArray<float> bin_a (max_block_size * 2), bout_a (max_block_size * 2), bout2_a (max_block_size * 2);
+      float *binput = &bin_a[0], *boutput = &bout_a[0], *boutput2 = &bout2_a[0];
+
+      for (unsigned int i = 0; i < max_block_size * 2; i++)
+	binput[i] = sin (i * test_frequency / 44100.0 * 2 * M_PI);
+
+      verbose_output += "\n# block-size ns-per-sample\n";
+      for (uint bs = 1; bs <= max_block_size; bs++)
+	{
+	  const int REPETITIONS = (options.standalone ? 4000000 : 40000) / bs + 1;
+
+	  double start_time = gettime();
+	  for (int i = 0; i < REPETITIONS; i++)
+	    {
+	      if (RESAMPLE == RES_DOWNSAMPLE || RESAMPLE == RES_SUBSAMPLE)
+		{
+		  downs.process_block (binput, bs * 2, boutput);
+		  if (RESAMPLE == RES_SUBSAMPLE)
+		    ups.process_block (boutput, bs, boutput2);
+		}
+	      if (RESAMPLE == RES_UPSAMPLE || RESAMPLE == RES_OVERSAMPLE)
+		{
+		  ups.process_block (binput, bs, boutput);
+		  if (RESAMPLE == RES_OVERSAMPLE)
+		    downs.process_block (boutput, bs * 2, boutput2);
+		}
+	    }
+	  double end_time = gettime();
+	  verbose_output += string_format ("%3d %f\n", bs, (end_time - start_time) * 1e9 / (double (REPETITIONS) * bs));
+	}
+    }
   else if (TEST == TEST_ACCURACY || TEST == TEST_ERROR_TABLE || TEST == TEST_ERROR_SPECTRUM)
     {
       const bool freq_scanning = (options.freq_inc > 1);
@@ -671,7 +720,7 @@ perform_test()
 template <int TEST> int
 perform_test()
 {
-  const char *instruction_set = options.use_sse ? "SSE" : "FPU";
+  const char *instruction_set = Resampler2::instruction_set_name (options.use_sse ? Resampler2::instruction_set_available() : Resampler2::ISET_FPU);
 
   switch (resample_type)
     {
@@ -695,6 +744,7 @@ perform_test()
   switch (test_type)
     {
     case TEST_PERFORMANCE:    verbose_output += "performance test "; return perform_test<TEST_PERFORMANCE> ();
+    case TEST_BLOCK_PERFORMANCE: verbose_output += "# block size performance test "; return perform_test<TEST_BLOCK_PERFORMANCE> ();
     case TEST_ACCURACY:	      verbose_output += "# accuracy test "; return perform_test<TEST_ACCURACY> ();
     case TEST_ERROR_TABLE:    verbose_output += "# error table test "; return perform_test<TEST_ERROR_TABLE> ();
     case TEST_ERROR_SPECTRUM: verbose_output += "# error spectrum test "; return perform_test<TEST_ERROR_SPECTRUM> ();
@@ -715,7 +765,7 @@ test_title()
     {
       assert (test_type == TEST_ACCURACY);
 
-      const char *instruction_set = options.use_sse ? "SSE" : "FPU";
+      const char *instruction_set = Resampler2::instruction_set_name (options.use_sse ? Resampler2::instruction_set_available() : Resampler2::ISET_FPU);
       const char *rname = "*bad resample name*";
       switch (resample_type)
         {
@@ -724,7 +774,8 @@ test_title()
           case RES_SUBSAMPLE:   rname = "sub "; break;
           case RES_OVERSAMPLE:  rname = "over"; break;
         }
-      return string_format ("testresampler accuracy/%s/%s %2d bit", instruction_set, rname, options.precision);
+      return string_format ("testresampler accuracy/%s/%s %2d bit%s", instruction_set, rname, options.precision,
+                            options.filter == Resampler2::FILTER_FIR_FIXED ? " fixed-point" : "");
     }
 }
 
@@ -741,6 +792,8 @@ standalone (int argc, char **argv)
       string command = argv[1];
       if (command == "perf" || command == "performance")
 	test_type = TEST_PERFORMANCE;
+      else if (command == "perf-blocks")
+	test_type = TEST_BLOCK_PERFORMANCE;
       else if (command == "accuracy")
 	test_type = TEST_ACCURACY;
       else if (command == "error-table")
@@ -807,10 +860,12 @@ run_testresampler (TestType tt)
 }
 
 static bool
-run_accuracy (ResampleType rtype, bool use_sse_if_available, int bits, double fmin, double fmax, double finc, double threshold)
+run_accuracy (ResampleType rtype, bool use_sse_if_available, int bits, double fmin, double fmax, double finc, double threshold,
+              Resampler2::Filter filter = Resampler2::FILTER_FIR)
 {
   test_type = TEST_ACCURACY;
   resample_type = rtype;
+  options.filter = filter;
   options.precision = Resampler2::find_precision_for_bits (bits);
   options.freq_min = fmin;
   options.freq_max = fmax;
@@ -859,6 +914,12 @@ check_accuracy_full()
       TASSERT (run_accuracy (RES_DOWNSAMPLE, true, 16, 25, 9000, 25, 95));    // ideally: 96dB
       TASSERT (run_accuracy (RES_DOWNSAMPLE, true, 20, 25, 9000, 25, 119.5)); // ideally: 120dB
       TASSERT (run_accuracy (RES_DOWNSAMPLE, true, 24, 25, 9000, 25, 130));   // ideally: 144dB
+      // fixed-point tests (uses SSE2, falls back to float filters otherwise); the
+      // quantization of the samples (14 bit + sign) and taps costs about 0.5dB
+      TASSERT (run_accuracy (RES_UPSAMPLE,   true, 8,  50, 18000, 50, 44,   Resampler2::FILTER_FIR_FIXED)); // ideally: 48dB
+      TASSERT (run_accuracy (RES_UPSAMPLE,   true, 12, 50, 18000, 50, 65.5, Resampler2::FILTER_FIR_FIXED)); // ideally: 72dB
+      TASSERT (run_accuracy (RES_DOWNSAMPLE, true, 8,  25, 9000,  25, 50,   Resampler2::FILTER_FIR_FIXED)); // ideally: 48dB
+      TASSERT (run_accuracy (RES_DOWNSAMPLE, true, 12, 25, 9000,  25, 71.5, Resampler2::FILTER_FIR_FIXED)); // ideally: 72dB
     }
   // FPU upsampler tests
   TASSERT (run_accuracy (RES_UPSAMPLE, false, 8,  50, 18000, 50, 44));     // ideally: 48dB
@@ -0,0 +1,231 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "pandaresampler.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <sys/time.h>
+
+using PandaResampler::Resampler2;
+using PandaResampler::AlignedArray;
+
+using std::vector;
+using std::max;
+using std::min;
+
+static double
+gettime()
+{
+  timeval tv;
+  gettimeofday (&tv, 0);
+
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* processing functions that use the scratch memory once a tile size is set */
+enum Path { INTERLEAVED, PLANAR, ADD, DOUBLE, PCM, IN_PLACE };
+
+static const char *
+path_name (Path path)
+{
+  switch (path)
+    {
+      case INTERLEAVED: return "interleaved";
+      case PLANAR:      return "planar";
+      case ADD:         return "add";
+      case DOUBLE:      return "double";
+      case PCM:         return "pcm";
+      case IN_PLACE:    return "in-place";
+    }
+  return "";
+}
+
+/* resamples interleaved input using one of the processing functions, optionally with odd block sizes */
+static vector<double>
+process (Resampler2& res, Path path, Resampler2::Mode mode, uint ratio, const vector<float>& in, bool odd_blocks)
+{
+  const uint channels = res.channels();
+  const bool up = mode == Resampler2::UP;
+  const uint n_frames = in.size() / channels;
+  const uint n_out_frames = up ? n_frames * ratio : n_frames / ratio;
+
+  vector<double> out (n_out_frames * channels);
+  if (path == IN_PLACE)
+    {
+      /* the input is at the end of the buffer for upsampling, and at the start for downsampling */
+      vector<float> buffer (max (n_frames, n_out_frames) * channels);
+      const uint in_pos = up ? (n_out_frames - n_frames) * channels : 0;
+      std::copy (in.begin(), in.end(), buffer.begin() + in_pos);
+      res.process_block_interleaved (&buffer[in_pos], n_frames, &buffer[0]);
+      std::copy (buffer.begin(), buffer.begin() + out.size(), out.begin());
+      return out;
+    }
+
+  vector<vector<float>> in_planar (channels, vector<float> (n_frames)), out_planar (channels, vector<float> (n_out_frames));
+  vector<float> out_float (n_out_frames * channels);
+  vector<double> in_double (in.begin(), in.end());
+  vector<int32_t> in_pcm (in.size()), out_pcm (out.size());
+  for (uint i = 0; i < in.size(); i++)
+    {
+      in_planar[i % channels][i / channels] = in[i];
+      in_pcm[i] = lrint (in[i] * 2147483647.0);
+    }
+  for (uint i = 0; i < out_float.size(); i++)
+    out_float[i] = sin (i * 0.01) * 0.5; /* output for process_block_add() */
+
+  uint pos = 0;
+  uint block_size = 1;
+  while (pos < n_frames)
+    {
+      uint n = n_frames - pos;
+      if (odd_blocks)
+        {
+          n = min<uint> (block_size * ratio, n_frames - pos);
+          n -= n % ratio; // downsampler needs a multiple of ratio
+          if (n == 0)
+            n = n_frames - pos;
+          block_size = block_size * 7 % 2401 + 1;
+        }
+      const uint out_pos = up ? pos * ratio : pos / ratio;
+
+      const float *in_p[Resampler2::MAX_CHANNELS];
+      float *out_p[Resampler2::MAX_CHANNELS];
+      for (uint c = 0; c < channels; c++)
+        {
+          in_p[c] = &in_planar[c][pos];
+          out_p[c] = &out_planar[c][out_pos];
+        }
+      switch (path)
+        {
+          case INTERLEAVED: res.process_block_interleaved (&in[pos * channels], n, &out_float[out_pos * channels]);
+                            break;
+          case PLANAR:      res.process_block (in_p, n, out_p);
+                            break;
+          case ADD:         res.process_block_add (&in[pos], n, &out_float[out_pos], 0.7f);
+                            break;
+          case DOUBLE:      res.process_block (&in_double[pos], n, &out[out_pos]);
+                            break;
+          case PCM:         res.process_block (&in_pcm[pos * channels], n, &out_pcm[out_pos * channels]);
+                            break;
+          case IN_PLACE:    break;
+        }
+      pos += n;
+    }
+  for (uint i = 0; i < out.size(); i++)
+    {
+      if (path == PLANAR)
+        out[i] = out_planar[i % channels][i / channels];
+      else if (path == PCM)
+        out[i] = out_pcm[i] / 2147483648.0;
+      else if (path != DOUBLE)
+        out[i] = out_float[i];
+    }
+  return out;
+}
+
+/* returns the maximum difference between tiled processing and processing with the default (stack) buffers */
+static double
+test_tile (Path path, Resampler2::Mode mode, uint ratio, Resampler2::Filter filter, uint channels, uint tile_size, bool caller_scratch)
+{
+  const uint n_frames = 5000;
+
+  Resampler2 res (mode, ratio, Resampler2::PREC_96DB, true, filter, channels);
+  Resampler2 res_tiled (mode, ratio, Resampler2::PREC_96DB, true, filter, channels);
+
+  AlignedArray<float> scratch (res_tiled.scratch_size (tile_size));
+  res_tiled.set_tile_size (tile_size, caller_scratch ? scratch.begin() : nullptr);
+
+  vector<float> in (n_frames * channels);
+  for (auto& v : in)
+    v = rand() / double (RAND_MAX) - 0.5;
+
+  vector<double> out = process (res, path, mode, ratio, in, false);
+  vector<double> out_tiled = process (res_tiled, path, mode, ratio, in, true);
+
+  double error = 0;
+  for (size_t i = 0; i < out.size(); i++)
+    error = max (error, fabs (out_tiled[i] - out[i]));
+  return error;
+}
+
+static void
+perf (Resampler2::Mode mode, uint ratio, Resampler2::Filter filter, uint channels)
+{
+  const uint n_input = 8192;
+  const uint n_output = mode == Resampler2::UP ? n_input * ratio : n_input / ratio;
+  const uint n_blocks = mode == Resampler2::UP ? 2000 / ratio : 2000;
+
+  vector<float> in (n_input * channels), out (n_output * channels);
+
+  Resampler2 res (mode, ratio, Resampler2::PREC_96DB, true, filter, channels);
+
+  const uint default_tile_size = res.default_tile_size();
+  for (uint tile_size : { 0u, 32u, 64u, 128u, 256u, 512u, 1024u, 2048u, 4096u, default_tile_size })
+    {
+      res.set_tile_size (tile_size);
+
+      /* use the best of several runs */
+      double t_best = 1e30;
+      for (uint run = 0; run < 5; run++)
+        {
+          double t = gettime();
+          for (uint b = 0; b < n_blocks; b++)
+            res.process_block_interleaved (in.data(), n_input, out.data());
+          t_best = min (t_best, gettime() - t);
+        }
+      const double samples = double (n_blocks) * n_input * channels;
+      if (tile_size == 0)
+        printf ("tile size    stack: %f ns / sample\n", t_best / samples * 1e9);
+      else
+        printf ("tile size %s%5d: %f ns / sample (scratch: %zd bytes)\n",
+                tile_size == default_tile_size ? "*" : " ", tile_size, t_best / samples * 1e9,
+                res.scratch_size (tile_size) * sizeof (float));
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc >= 5 && !strcmp (argv[1], "perf"))
+    {
+      perf (strcmp (argv[2], "down") ? Resampler2::UP : Resampler2::DOWN,
+            atoi (argv[3]),
+            strcmp (argv[4], "iir") ? Resampler2::FILTER_FIR : Resampler2::FILTER_IIR,
+            argc == 6 ? atoi (argv[5]) : 1);
+      return 0;
+    }
+
+  bool ok = true;
+
+  for (auto path : { INTERLEAVED, PLANAR, ADD, DOUBLE, PCM, IN_PLACE })
+    for (auto filter : { Resampler2::FILTER_FIR, Resampler2::FILTER_IIR })
+      for (auto mode : { Resampler2::UP, Resampler2::DOWN })
+        for (uint ratio : { 2, 4, 8 })
+          for (uint channels : { 1, 2, 3 })
+            {
+              if ((path == ADD || path == DOUBLE) && channels > 1) // mono only
+                continue;
+
+              Resampler2 res (mode, ratio, Resampler2::PREC_96DB, true, filter, channels);
+              for (uint tile_size : { 16u, 64u, 1024u, res.default_tile_size() })
+                for (bool caller_scratch : { false, true })
+                  {
+                    double error = test_tile (path, mode, ratio, filter, channels, tile_size, caller_scratch);
+                    printf ("%s %s %s ratio=%d channels=%d tile_size=%d%s error=%g\n", path_name (path),
+                            filter == Resampler2::FILTER_FIR ? "fir" : "iir",
+                            mode == Resampler2::UP ? "up" : "down",
+                            ratio, channels, tile_size, caller_scratch ? " (caller scratch)" : "", error);
+
+                    /* block sizes differ for tiled processing, so rounding errors may differ, too */
+                    if (error > 1e-6)
+                      {
+                        printf ("  ERROR: tiled output doesn't match output with stack buffers\n");
+                        ok = false;
+                      }
+                  }
+            }
+
+  return ok ? 0 : 1;
+}